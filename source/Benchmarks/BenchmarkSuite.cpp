@@ -0,0 +1,327 @@
+#include "BenchmarkSuite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <locale>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
+
+#include "../Tree/Tree.hpp"
+#include "../Tree/TreeSerialization.hpp"
+#include "../Tree/TreeUtilities.hpp"
+
+#include "FileInfo.hpp"
+#include "TrialStatistics.hpp"
+
+namespace
+{
+   using ChronoType = std::chrono::microseconds;
+   using NodeType = Tree<FileInfo>::Node;
+
+#if _DEBUG
+   constexpr std::size_t TRIAL_COUNT{ 1 };
+   constexpr std::size_t WARM_UP_COUNT{ 0 };
+#else
+   constexpr std::size_t TRIAL_COUNT{ 30 };
+   constexpr std::size_t WARM_UP_COUNT{ 2 };
+#endif
+
+   constexpr std::size_t NODE_COUNT{ 250'000 };
+
+   constexpr std::uint32_t RANDOM_SEED{ 0x5EED };
+
+   /**
+   * @brief A stream buffer that discards everything written to it, so that exporting to it
+   * measures the formatting alone, without any I/O.
+   */
+   class DiscardingBuffer final : public std::streambuf
+   {
+   protected:
+
+      int_type overflow(int_type character) override
+      {
+         return traits_type::not_eof(character);
+      }
+
+      std::streamsize xsputn(const char_type* /*characters*/, std::streamsize count) override
+      {
+         return count;
+      }
+   };
+
+   /**
+   * @brief Results of whatever is being measured get written here, so that the compiler can't
+   * optimize the measured code away.
+   */
+   volatile std::uintmax_t sink{ 0 };
+
+   FileInfo MakeFile(std::uintmax_t size, FileType type) noexcept
+   {
+      return FileInfo{ size, StringPool::Reference{ 0, 0 }, 0, type, 0 };
+   }
+
+   /**
+   * @returns A tree in which every node but the last has a single child.
+   */
+   std::unique_ptr<Tree<FileInfo>> MakeChain(std::size_t nodeCount)
+   {
+      auto tree = std::make_unique<Tree<FileInfo>>(MakeFile(nodeCount, FileType::DIRECTORY));
+
+      NodeType* node = tree->GetRoot();
+      for (std::size_t index = 1; index < nodeCount; ++index)
+      {
+         node = node->AppendChild(MakeFile(nodeCount - index, FileType::DIRECTORY));
+      }
+
+      return tree;
+   }
+
+   /**
+   * @returns A tree in which every node but the root is a leaf child of the root, with sizes
+   * shuffled so that there is something to sort.
+   */
+   std::unique_ptr<Tree<FileInfo>> MakeFan(std::size_t nodeCount)
+   {
+      auto tree = std::make_unique<Tree<FileInfo>>(MakeFile(0, FileType::DIRECTORY));
+
+      std::mt19937 generator{ RANDOM_SEED };
+      std::uniform_int_distribution<std::uintmax_t> sizeDistribution{ 0, 1 << 20 };
+
+      for (std::size_t index = 1; index < nodeCount; ++index)
+      {
+         tree->GetRoot()->AppendChild(MakeFile(sizeDistribution(generator), FileType::REGULAR));
+      }
+
+      return tree;
+   }
+
+   /**
+   * @returns A tree in which every node is attached to a node picked at random from among those
+   * created before it, which makes for a tree that is only logarithmically deep, but with a wide
+   * spread of child counts, much like a typical directory tree.
+   */
+   std::unique_ptr<Tree<FileInfo>> MakeRandomTree(std::size_t nodeCount)
+   {
+      auto tree = std::make_unique<Tree<FileInfo>>(MakeFile(0, FileType::DIRECTORY));
+
+      std::mt19937 generator{ RANDOM_SEED };
+      std::uniform_int_distribution<std::uintmax_t> sizeDistribution{ 0, 1 << 20 };
+
+      std::vector<NodeType*> nodes;
+      nodes.reserve(nodeCount);
+      nodes.emplace_back(tree->GetRoot());
+
+      for (std::size_t index = 1; index < nodeCount; ++index)
+      {
+         std::uniform_int_distribution<std::size_t> parentDistribution{ 0, nodes.size() - 1 };
+         auto* const parent = nodes[parentDistribution(generator)];
+
+         nodes.emplace_back(
+            parent->AppendChild(MakeFile(sizeDistribution(generator), FileType::REGULAR)));
+      }
+
+      return tree;
+   }
+
+   /**
+   * @returns The scanned tree recorded in the specified file. Only the sizes and types of the
+   * files matter to the benchmarks, so the names saved alongside the tree are left unread.
+   */
+   std::unique_ptr<Tree<FileInfo>> LoadSnapshot(const std::string& fileName)
+   {
+      const auto snapshot = TreeSerialization::MapFromFile<FileInfo>(fileName);
+
+      const auto* const parents = snapshot.GetParentIndices();
+      const auto* const data = snapshot.GetDataArray();
+
+      auto tree = std::make_unique<Tree<FileInfo>>(data[0]);
+
+      // Since the snapshot is stored in pre-order, every parent precedes its children, and the
+      // children of each node appear in order:
+      std::vector<NodeType*> nodes;
+      nodes.reserve(snapshot.Size());
+      nodes.emplace_back(tree->GetRoot());
+
+      for (std::size_t index = 1; index < snapshot.Size(); ++index)
+      {
+         nodes.emplace_back(nodes[parents[index]]->AppendChild(data[index]));
+      }
+
+      return tree;
+   }
+
+   /**
+   * @brief Writes the results of the benchmarks out as a JSON array, one object per line.
+   */
+   class ResultWriter
+   {
+   public:
+
+      explicit ResultWriter(const std::string& fileName)
+         : m_stream{ fileName, std::ios::trunc }
+      {
+         if (!m_stream)
+         {
+            throw std::runtime_error{ "Could not write: " + fileName };
+         }
+
+         // Keep the numbers free of any locale-specific separators:
+         m_stream.imbue(std::locale::classic());
+         m_stream << std::setprecision(6) << "[\n";
+      }
+
+      ~ResultWriter()
+      {
+         m_stream << "\n]\n";
+      }
+
+      void Write(
+         const char* const treeName,
+         std::size_t nodeCount,
+         const char* const benchmarkName,
+         const TrialStatistics& statistics)
+      {
+         m_stream
+            << (m_isFirst ? "" : ",\n")
+            << "{\"tree\":\"" << treeName << "\""
+            << ",\"nodeCount\":" << nodeCount
+            << ",\"benchmark\":\"" << benchmarkName << "\""
+            << ",\"units\":\"" << StopwatchInternals::TypeName<ChronoType>::value << "\""
+            << ",\"trials\":" << statistics.trialCount
+            << ",\"outliers\":" << statistics.outlierCount
+            << ",\"min\":" << statistics.minimum
+            << ",\"median\":" << statistics.median
+            << ",\"p99\":" << statistics.percentile99
+            << ",\"mean\":" << statistics.mean
+            << ",\"stdDev\":" << statistics.standardDeviation
+            << "}";
+
+         m_isFirst = false;
+      }
+
+   private:
+
+      std::ofstream m_stream;
+
+      bool m_isFirst{ true };
+   };
+
+   /**
+   * @brief Runs every benchmark against the specified tree.
+   */
+   void RunBenchmarks(const char* const treeName, const Tree<FileInfo>& tree, ResultWriter& writer)
+   {
+      const auto nodeCount = static_cast<std::size_t>(tree.Size());
+
+      std::cout << treeName << " (" << nodeCount << " Nodes):\n";
+
+      const auto report = [&] (const char* const benchmarkName, const TrialStatistics& statistics)
+      {
+         std::cout
+            << "   " << benchmarkName
+            << " (" << StopwatchInternals::TypeName<ChronoType>::value << "): "
+            << statistics << "\n";
+
+         writer.Write(treeName, nodeCount, benchmarkName, statistics);
+      };
+
+      const auto traverse = [&] (const char* const benchmarkName, auto begin, auto end)
+      {
+         report(benchmarkName, RunTrials<ChronoType>(TRIAL_COUNT, WARM_UP_COUNT, [&]
+         {
+            std::uintmax_t totalBytes{ 0 };
+            std::for_each(begin, end, [&] (const NodeType& node) noexcept
+            {
+               totalBytes += node->size;
+            });
+
+            sink = totalBytes;
+         }));
+      };
+
+      traverse("Pre-Order Traversal", tree.beginPreOrder(), tree.endPreOrder());
+      traverse("Post-Order Traversal", tree.begin(), tree.end());
+      traverse("Leaf Traversal", tree.beginLeaf(), tree.endLeaf());
+      traverse("Level-Order Traversal", tree.beginLevelOrder(), tree.endLevelOrder());
+      traverse(
+         "Sibling Traversal",
+         Tree<FileInfo>::SiblingIterator{ tree.GetRoot()->GetFirstChild() },
+         Tree<FileInfo>::SiblingIterator{});
+
+      const auto visit = [&] (const char* const benchmarkName, auto traversal)
+      {
+         using TraversalType = decltype(traversal);
+
+         report(benchmarkName, RunTrials<ChronoType>(TRIAL_COUNT, WARM_UP_COUNT, [&]
+         {
+            std::uintmax_t totalBytes{ 0 };
+            tree.ForEach<TraversalType>([&] (const NodeType& node) noexcept
+            {
+               totalBytes += node->size;
+            });
+
+            sink = totalBytes;
+         }));
+      };
+
+      visit("Pre-Order ForEach", PreOrderTraversal{});
+      visit("Post-Order ForEach", PostOrderTraversal{});
+      visit("Leaf ForEach", LeafTraversal{});
+      visit("Level-Order ForEach", LevelOrderTraversal{});
+
+      std::unique_ptr<Tree<FileInfo>> copy;
+
+      report("Copy", RunTrials<ChronoType>(TRIAL_COUNT, WARM_UP_COUNT,
+         [&] { copy = std::make_unique<Tree<FileInfo>>(tree); },
+         [&] { copy.reset(); }));
+
+      report("Destruction", RunTrials<ChronoType>(TRIAL_COUNT, WARM_UP_COUNT,
+         [&] { copy.reset(); },
+         [&] { copy = std::make_unique<Tree<FileInfo>>(tree); }));
+
+      report("Sort Children", RunTrials<ChronoType>(TRIAL_COUNT, WARM_UP_COUNT,
+         [&]
+         {
+            std::for_each(std::begin(*copy), std::end(*copy), [] (NodeType& node)
+            {
+               node.SortChildren([] (const NodeType& lhs, const NodeType& rhs) noexcept
+                  { return lhs->size > rhs->size; });
+            });
+         },
+         [&] { copy = std::make_unique<Tree<FileInfo>>(tree); }));
+
+      copy.reset();
+
+      DiscardingBuffer buffer;
+      std::ostream stream{ &buffer };
+
+      report("DOT Export", RunTrials<ChronoType>(TRIAL_COUNT, WARM_UP_COUNT, [&]
+      {
+         sink = TreeUtilities::ExportToStream(tree, stream, {},
+            [] (const NodeType& node) noexcept { return node->size; });
+      }));
+
+      std::cout << std::endl;
+   }
+}
+
+void RunBenchmarkSuite(const std::string& outputFileName, const std::string& snapshotFileName)
+{
+   ResultWriter writer{ outputFileName };
+
+   RunBenchmarks("Deep Chain", *MakeChain(NODE_COUNT), writer);
+   RunBenchmarks("Wide Fan", *MakeFan(NODE_COUNT), writer);
+   RunBenchmarks("Random Tree", *MakeRandomTree(NODE_COUNT), writer);
+
+   if (!snapshotFileName.empty())
+   {
+      RunBenchmarks("Drive Scan Snapshot", *LoadSnapshot(snapshotFileName), writer);
+   }
+}
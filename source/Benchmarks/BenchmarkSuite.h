@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+/**
+* @brief Runs every benchmark in the suite against a fixed set of synthetic trees, and, if a
+* snapshot is provided, against a recorded drive scan, and then writes the results out as JSON.
+*
+* Unlike a live scan, every tree in the suite is built from a fixed seed, so that the results of
+* one run can be compared against those of another, such as between releases. The synthetic trees
+* each stress a different shape: a single deep chain, a single wide fan, and a random tree with
+* both depth and breadth.
+*
+* The output holds one object per combination of tree and benchmark, of the form:
+*
+*    {"tree":"Wide Fan","nodeCount":250001,"benchmark":"Pre-Order Traversal","units":"microseconds",
+*     "trials":30,"outliers":1,"min":1.0,"median":1.1,"p99":1.9,"mean":1.1,"stdDev":0.1}
+*
+* @param[in] outputFileName        The file to write the JSON results to.
+* @param[in] snapshotFileName      A tree file written by SaveScan(...), or an empty string to
+*                                  skip it.
+*
+* @throws std::runtime_error if the snapshot can't be read, or the results can't be written.
+*/
+void RunBenchmarkSuite(const std::string& outputFileName, const std::string& snapshotFileName);
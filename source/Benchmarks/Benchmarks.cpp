@@ -1,40 +1,50 @@
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <execution>
 #include <iostream>
+#include <mutex>
 #include <numeric>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "../Tree/Tree.hpp"
+#include "../Tree/TreeAlgorithms.hpp"
 
+#include "BenchmarkSuite.h"
 #include "DriveScanner.h"
+#include "FileColumns.h"
+#include "ScanFile.h"
 #include "Stopwatch.hpp"
+#include "ThreadSafeQueue.hpp"
+#include "TrialStatistics.hpp"
 
 namespace
 {
 #if _DEBUG
    constexpr auto TRIAL_COUNT{ 1 };
+   constexpr auto WARM_UP_COUNT{ 0 };
 #else
    constexpr auto TRIAL_COUNT{ 100 };
+   constexpr auto WARM_UP_COUNT{ 3 };
 #endif
 
+   /**
+   * @brief Runs the trials of a benchmark, and writes their statistics out to the console.
+   */
    template<
       typename ChronoType,
       typename LambdaType
    >
-   auto RunTrials(LambdaType&& lambda)
+   void ReportTrials(const std::string& description, LambdaType&& lambda)
    {
-      std::vector<ChronoType> elapsedTimes;
-      elapsedTimes.reserve(TRIAL_COUNT);
+      const auto statistics =
+         RunTrials<ChronoType>(TRIAL_COUNT, WARM_UP_COUNT, std::forward<LambdaType>(lambda));
 
-      for (auto index{ 0u }; index < elapsedTimes.capacity(); ++index)
-      {
-         const auto clock = Stopwatch<ChronoType>([&] () noexcept { lambda(); });
-         elapsedTimes.emplace_back(clock.GetElapsedTime());
-      }
-
-      const auto sum = std::accumulate(std::begin(elapsedTimes), std::end(elapsedTimes), 0ull,
-         [] (auto total, auto current) noexcept { return total + current.count(); });
-
-      return sum / elapsedTimes.size();
+      std::cout
+         << description << " (" << StopwatchInternals::TypeName<ChronoType>::value << "): "
+         << statistics << "\n";
    }
 
    template<
@@ -46,7 +56,7 @@ namespace
       std::vector<std::size_t> visitedIndices;
       visitedIndices.reserve(tree.Size());
 
-      using IteratorType = TraversalType::Iterator<DataType>;
+      using IteratorType = typename TraversalType::template Iterator<DataType>;
 
       std::transform(IteratorType{ tree.GetRoot() }, IteratorType{ },
          std::back_inserter(visitedIndices), [] (const auto& node) noexcept { return node.GetIndex(); });
@@ -75,32 +85,540 @@ namespace
 
       Stopwatch<ChronoType>([&] () noexcept
       {
-         tree.OptimizeMemoryLayoutFor<TraversalType>();
+         tree.template OptimizeMemoryLayoutFor<TraversalType>();
       }, "Optimized Layout in ");
 
       IsMemoryLayoutSequential<TraversalType>(tree);
    }
+
+   /**
+   * @brief Compares looking up nodes by path through the index with searching every directory
+   * along the way.
+   */
+   void LookUpPaths(
+      const DriveScanner& scanner,
+      const Tree<FileInfo>& tree,
+      const FileNames& fileNames,
+      const std::experimental::filesystem::path& rootPath)
+   {
+      using NodeType = Tree<FileInfo>::Node;
+
+      // Sample every directory, since those are what the "size of this folder" queries are after:
+      std::vector<std::experimental::filesystem::path> paths;
+      std::vector<std::vector<std::basic_string<NativeChar>>> components;
+
+      std::for_each(tree.beginPreOrder(), tree.endPreOrder(), [&] (const NodeType& node)
+      {
+         if (node->type != FileType::DIRECTORY || !node.GetParent())
+         {
+            return;
+         }
+
+         std::vector<std::basic_string<NativeChar>> names;
+         for (const auto* ancestor = &node; ancestor->GetParent(); ancestor = ancestor->GetParent())
+         {
+            names.emplace_back(fileNames.GetFullName(ancestor->GetData()));
+         }
+
+         std::reverse(std::begin(names), std::end(names));
+
+         auto path = rootPath;
+         for (const auto& name : names)
+         {
+            path /= name;
+         }
+
+         paths.emplace_back(std::move(path));
+         components.emplace_back(std::move(names));
+      });
+
+      std::size_t found{ 0 };
+
+      const auto indexedLookups = [&] () noexcept
+      {
+         found = std::count_if(std::begin(paths), std::end(paths),
+            [&] (const auto& path) { return scanner.FindNode(path) != nullptr; });
+      };
+
+      const auto searchedLookups = [&] () noexcept
+      {
+         found = std::count_if(std::begin(components), std::end(components),
+            [&] (const auto& names)
+         {
+            const NodeType* node = tree.GetRoot();
+            for (const auto& name : names)
+            {
+               auto* child = node->GetFirstChild();
+               while (child && fileNames.GetFullName(child->GetData()) != name)
+               {
+                  child = child->GetNextSibling();
+               }
+
+               if (!child)
+               {
+                  return false;
+               }
+
+               node = child;
+            }
+
+            return true;
+         });
+      };
+
+      using LookupChronoType = std::chrono::microseconds;
+
+      const auto directoryCount = std::to_string(paths.size());
+
+      ReportTrials<LookupChronoType>(
+         "Looking Up " + directoryCount + " Directories by Path", indexedLookups);
+
+      ReportTrials<LookupChronoType>(
+         "Searching for " + directoryCount + " Directories", searchedLookups);
+
+      std::cout << "Directories Found: " << found << "\n";
+   }
+
+   /**
+   * @brief Compares finding every directory that takes up at least a hundredth of the scanned
+   * bytes by filtering a full traversal with finding them by skipping the subtrees of small
+   * directories, none of which can contain a directory larger than themselves.
+   */
+   void FindLargeDirectories(const Tree<FileInfo>& tree)
+   {
+      using ChronoType = std::chrono::microseconds;
+      using NodeType = Tree<FileInfo>::Node;
+
+      const auto threshold = tree.GetRoot()->GetData().size / 100;
+
+      const auto isLarge = [threshold] (const NodeType& node) noexcept
+      {
+         return node->type == FileType::DIRECTORY && node->size >= threshold;
+      };
+
+      std::size_t largeDirectoryCount{ 0 };
+      std::size_t visitedCount{ 0 };
+
+      const auto filteredTraversal = [&] () noexcept
+      {
+         largeDirectoryCount = std::count_if(tree.beginPreOrder(), tree.endPreOrder(), isLarge);
+      };
+
+      const auto prunedTraversal = [&] () noexcept
+      {
+         largeDirectoryCount = 0;
+
+         for (auto itr = tree.beginPreOrder(); itr != tree.endPreOrder(); ++itr)
+         {
+            if (isLarge(*itr))
+            {
+               ++largeDirectoryCount;
+            }
+            else
+            {
+               itr.SkipChildren();
+            }
+         }
+      };
+
+      const auto visitorTraversal = [&] () noexcept
+      {
+         largeDirectoryCount = 0;
+
+         visitedCount = TreeAlgorithms::Traverse(*tree.GetRoot(),
+            [&] (const NodeType& node) noexcept
+         {
+            const auto isLargeDirectory = isLarge(node);
+            largeDirectoryCount += isLargeDirectory;
+
+            return isLargeDirectory;
+         });
+      };
+
+      ReportTrials<ChronoType>("Filtering a Full Traversal for Large Directories", filteredTraversal);
+
+      ReportTrials<ChronoType>("Finding Large Directories by Skipping Subtrees", prunedTraversal);
+
+      ReportTrials<ChronoType>("Finding Large Directories with a Visitor", visitorTraversal);
+
+      std::cout
+         << "Large Directories Found: " << largeDirectoryCount
+         << " (Visiting " << visitedCount << " of " << tree.Size() << " Nodes)\n";
+   }
+
+   /**
+   * @brief Compares finding the largest files by sorting every file with finding them through a
+   * bounded heap, which can skip any directory that's smaller than the smallest file found so far.
+   */
+   void FindLargestFiles(const Tree<FileInfo>& tree)
+   {
+      using ChronoType = std::chrono::microseconds;
+      using NodeType = Tree<FileInfo>::Node;
+
+      constexpr std::size_t FILE_COUNT{ 100 };
+
+      const auto fileSize = [] (const NodeType& node) noexcept
+      {
+         return node->type == FileType::REGULAR ? node->size : 0;
+      };
+
+      // Since directory sizes include everything below them, they bound the sizes of those files:
+      const auto directorySize = [] (const NodeType& node) noexcept { return node->size; };
+
+      const NodeType& root = *tree.GetRoot();
+      std::vector<const NodeType*> largestFiles;
+
+      const auto sortedFiles = [&] ()
+      {
+         std::vector<const NodeType*> files;
+         std::for_each(tree.beginPreOrder(), tree.endPreOrder(), [&] (const NodeType& node)
+         {
+            if (node->type == FileType::REGULAR)
+            {
+               files.emplace_back(&node);
+            }
+         });
+
+         std::stable_sort(std::begin(files), std::end(files),
+            [] (const auto* lhs, const auto* rhs) noexcept { return (*lhs)->size > (*rhs)->size; });
+
+         files.resize(std::min(files.size(), FILE_COUNT));
+         largestFiles = std::move(files);
+      };
+
+      const auto serialTopK = [&] ()
+      {
+         largestFiles = TreeAlgorithms::TopK(root, FILE_COUNT, fileSize, directorySize);
+      };
+
+      const auto parallelTopK = [&] ()
+      {
+         largestFiles = TreeAlgorithms::ParallelTopK(root, FILE_COUNT, fileSize, directorySize);
+      };
+
+      const auto description = "the " + std::to_string(FILE_COUNT) + " Largest Files";
+
+      ReportTrials<ChronoType>("Finding " + description + " by Sorting", sortedFiles);
+
+      ReportTrials<ChronoType>("Finding " + description + " with a Bounded Heap", serialTopK);
+
+      ReportTrials<ChronoType>("Finding " + description + " in Parallel", parallelTopK);
+
+      if (!largestFiles.empty())
+      {
+         std::cout << "Largest File: " << largestFiles.front()->GetData().size << " bytes\n";
+      }
+   }
+
+   /**
+   * @brief Compares aggregating file attributes by traversing the tree with aggregating them over
+   * the columns of a frozen copy, both over the whole tree and over its largest top-level subtree.
+   */
+   void AggregateColumns(const Tree<FileInfo>& tree, const FileNames& fileNames)
+   {
+      using ChronoType = std::chrono::microseconds;
+      using NodeType = Tree<FileInfo>::Node;
+
+      std::unique_ptr<FileColumns> columns;
+
+      Stopwatch<ChronoType>([&]
+      {
+         columns = std::make_unique<FileColumns>(tree.Freeze());
+      }, "Built File Columns in ");
+
+      std::uintmax_t totalBytes{ 0 };
+      std::size_t directoryCount{ 0 };
+
+      const auto traversal = [&] () noexcept
+      {
+         totalBytes = 0;
+         directoryCount = 0;
+
+         tree.ForEach<PreOrderTraversal>([&] (const NodeType& node) noexcept
+         {
+            totalBytes += node->type == FileType::REGULAR ? node->size : 0;
+            directoryCount += node->type == FileType::DIRECTORY;
+         });
+      };
+
+      const auto all = columns->GetAll();
+
+      std::uintmax_t columnarBytes{ 0 };
+      std::size_t columnarDirectoryCount{ 0 };
+
+      const auto columnarScan = [&] () noexcept
+      {
+         columnarBytes = columns->SumSizes(FileType::REGULAR, all);
+         columnarDirectoryCount = columns->Count(FileType::DIRECTORY, all);
+      };
+
+      std::vector<FileColumns::ExtensionTotals> extensionTotals;
+
+      const auto extensionHistogram = [&]
+      {
+         extensionTotals = columns->TotalByExtension(fileNames.extensions.GetSize(), all);
+      };
+
+      const auto instructionSet = std::string{ " (" } + FileColumns::GetInstructionSet() + ")";
+
+      ReportTrials<ChronoType>("Aggregating File Sizes by Traversal", traversal);
+
+      ReportTrials<ChronoType>("Aggregating File Sizes over Columns" + instructionSet, columnarScan);
+
+      ReportTrials<ChronoType>("Totaling File Sizes by Extension over Columns", extensionHistogram);
+
+      std::cout
+         << "Total File Size: " << totalBytes << " bytes in " << directoryCount << " directories"
+         << " (Columns: " << columnarBytes << " bytes in " << columnarDirectoryCount
+         << " directories)\n";
+
+      const auto largestExtension = std::max_element(
+         std::begin(extensionTotals),
+         std::end(extensionTotals),
+         [] (const auto& lhs, const auto& rhs) noexcept { return lhs.byteCount < rhs.byteCount; });
+
+      if (largestExtension != std::end(extensionTotals))
+      {
+         const auto id = static_cast<InternTable::Id>(largestExtension - std::begin(extensionTotals));
+         const std::experimental::filesystem::path extension{
+            std::basic_string<NativeChar>{ fileNames.extensions.Get(id) } };
+
+         std::cout
+            << "Largest Extension: \"" << extension.string() << "\" ("
+            << largestExtension->fileCount << " files, " << largestExtension->byteCount
+            << " bytes)\n";
+      }
+
+      // The children of the root follow one another in pre-order, each right after the subtree of
+      // the one before it:
+      std::size_t largestSubtreeIndex{ 0 };
+      std::uintmax_t largestSubtreeSize{ 0 };
+
+      for (auto index = std::size_t{ 1 }; index < all.last; index = columns->GetSubtree(index).last)
+      {
+         const auto size = columns->SumSizes(FileType::REGULAR, columns->GetSubtree(index));
+         if (size > largestSubtreeSize)
+         {
+            largestSubtreeIndex = index;
+            largestSubtreeSize = size;
+         }
+      }
+
+      if (largestSubtreeIndex != 0)
+      {
+         const auto subtree = columns->GetSubtree(largestSubtreeIndex);
+
+         ReportTrials<ChronoType>("Aggregating the Largest Subtree over Columns", [&] () noexcept
+         {
+            columnarBytes = columns->SumSizes(FileType::REGULAR, subtree);
+         });
+
+         std::cout
+            << "Largest Subtree: " << columnarBytes << " bytes in "
+            << subtree.last - subtree.first << " nodes\n";
+      }
+   }
+
+   /**
+   * @brief Measures how soon an asynchronous scan streams out its first finished subtree, and
+   * how quickly it winds down once it's cancelled right after.
+   */
+   void MeasureAsyncScan(const std::experimental::filesystem::path& rootPath)
+   {
+      using ClockType = std::chrono::steady_clock;
+      using ChronoType = std::chrono::microseconds;
+
+      DriveScanner scanner{ rootPath };
+
+      std::mutex mutex;
+      std::condition_variable subtreeScanned;
+      ClockType::time_point firstSubtreeTime;
+      std::size_t subtreeCount{ 0 };
+
+      DriveScanner::ScanOptions options;
+      options.onSubtreeScanned = [&] (const Tree<FileInfo>::Node& /*node*/)
+      {
+         const std::lock_guard<std::mutex> lock{ mutex };
+         if (subtreeCount++ == 0)
+         {
+            firstSubtreeTime = ClockType::now();
+            subtreeScanned.notify_one();
+         }
+      };
+
+      const auto startTime = ClockType::now();
+      const auto scan = scanner.StartAsync(std::move(options));
+
+      {
+         std::unique_lock<std::mutex> lock{ mutex };
+         subtreeScanned.wait(lock, [&] { return subtreeCount > 0; });
+      }
+
+      const auto cancellationTime = ClockType::now();
+      scanner.Cancel();
+      scan.wait();
+
+      const auto endTime = ClockType::now();
+
+      std::cout
+         << "Streamed First Subtree in "
+         << std::chrono::duration_cast<ChronoType>(firstSubtreeTime - startTime).count()
+         << " " << StopwatchInternals::TypeName<ChronoType>::value << ".\n"
+         << "Wound Down Cancelled Scan in "
+         << std::chrono::duration_cast<ChronoType>(endTime - cancellationTime).count()
+         << " " << StopwatchInternals::TypeName<ChronoType>::value << ", after "
+         << scanner.GetProgress().directoryCount << " Directories.\n";
+   }
+
+   /**
+   * @brief Compares handing elements from a number of producer threads to as many consumer threads
+   * one at a time with handing them over in batches, since the latter needs only one claim on the
+   * queue per batch, rather than one per element.
+   */
+   void MeasureQueueContention()
+   {
+      using ChronoType = std::chrono::milliseconds;
+
+      constexpr std::size_t ELEMENTS_PER_PRODUCER{ 1'000'000 };
+      constexpr std::size_t BATCH_SIZE{ 64 };
+
+      const auto threadCount = std::max(std::thread::hardware_concurrency() / 2, 1u);
+
+      const auto handOff = [&] (bool isBatched)
+      {
+         ThreadSafeQueue<std::size_t> queue;
+
+         const auto totalCount = threadCount * ELEMENTS_PER_PRODUCER;
+         std::atomic<std::size_t> consumedCount{ 0 };
+
+         std::vector<std::thread> threads;
+         threads.reserve(2 * threadCount);
+
+         for (auto index{ 0u }; index < threadCount; ++index)
+         {
+            threads.emplace_back([&]
+            {
+               std::vector<std::size_t> batch(BATCH_SIZE);
+
+               for (std::size_t element = 0; element < ELEMENTS_PER_PRODUCER; element += BATCH_SIZE)
+               {
+                  if (isBatched)
+                  {
+                     std::iota(std::begin(batch), std::end(batch), element);
+                     queue.PushBatch(std::begin(batch), std::end(batch));
+                     continue;
+                  }
+
+                  for (std::size_t offset = 0; offset < BATCH_SIZE; ++offset)
+                  {
+                     queue.Push(element + offset);
+                  }
+               }
+            });
+
+            threads.emplace_back([&]
+            {
+               std::vector<std::size_t> batch(BATCH_SIZE);
+
+               while (consumedCount.load(std::memory_order_relaxed) < totalCount)
+               {
+                  const auto count = isBatched
+                     ? queue.TryPopBatch(std::begin(batch), batch.size())
+                     : static_cast<std::size_t>(queue.TryPop(batch.front()));
+
+                  if (count == 0)
+                  {
+                     std::this_thread::yield();
+                     continue;
+                  }
+
+                  consumedCount.fetch_add(count, std::memory_order_relaxed);
+               }
+            });
+         }
+
+         for (auto& thread : threads)
+         {
+            thread.join();
+         }
+      };
+
+      std::cout
+         << "Queue Hand-Off Between " << threadCount << " Producers and "
+         << threadCount << " Consumers:\n";
+
+      Stopwatch<ChronoType>([&] { handOff(false); }, "Handed Off Elements One at a Time in ");
+      Stopwatch<ChronoType>([&] { handOff(true); }, "Handed Off Elements in Batches in ");
+   }
 }
 
-int main()
+int main(int argc, char* argv[])
 {
    using ChronoType = std::chrono::milliseconds;
 
+#ifdef _WIN32
+   const auto* const defaultRootPath = "C:\\";
+#else
+   const auto* const defaultRootPath = "/";
+#endif
+
    std::cout.imbue(std::locale{ "" });
-   std::cout << "Scanning Drive to Create a Large Tree...\n" << std::endl;
 
-   DriveScanner scanner{ std::experimental::filesystem::path{ "C:\\" } };
+   // Rather than scanning a drive, the reproducible suite can be run instead, writing its results
+   // to the specified JSON file, and including a recorded scan if one is passed in:
+   if (argc > 1 && std::string{ argv[1] } == "--suite")
+   {
+      RunBenchmarkSuite(argc > 2 ? argv[2] : "BenchmarkResults.json", argc > 3 ? argv[3] : "");
+      return 0;
+   }
+
+   // The directory to scan can optionally be passed in as the first argument, and a file to record
+   // the scanned tree to, for later use by the suite, as the second:
+   const std::experimental::filesystem::path rootPath{ argc > 1 ? argv[1] : defaultRootPath };
+   MeasureAsyncScan(rootPath);
+
+   std::cout << "\nScanning Drive to Create a Large Tree...\n" << std::endl;
+
+   DriveScanner scanner{
+      rootPath, std::thread::hardware_concurrency(), DriveScanner::PathIndexing::ENABLED };
+
+   // Progress is reported from this thread, while it waits, so that the scanning threads are never
+   // held up by the console:
+   scanner.SetProgressCallback([] (const ScanProgress& progress)
+   {
+      std::cout << (progress.isComplete ? "Done: " : "Scanning: ") << progress << std::endl;
+   });
+
    scanner.Start();
 
    std::cout << "\n";
 
    const auto tree = scanner.GetTree();
 
+   if (argc > 2)
+   {
+      SaveScan(*tree, *scanner.GetFileNames(), argv[2]);
+
+      // Reading the root's name back from the saved copy checks that the names made the trip:
+      const auto savedScan = LoadScan(argv[2]);
+      const std::experimental::filesystem::path savedRootPath{
+         savedScan.fileNames->GetFullName(savedScan.tree.GetDataArray()[0]) };
+
+      std::cout
+         << "Saved " << savedScan.tree.Size() << " Nodes under " << savedRootPath.string()
+         << " to " << argv[2] << "\n";
+   }
+
    const auto leafCount = std::count_if(tree->beginLeaf(), tree->endLeaf(),
       [] (const auto&) noexcept { return true; });
 
    std::cout << "Tree Leaf Count: " << leafCount << "\n";
 
+   const auto fileNames = scanner.GetFileNames();
+
+   std::cout << "Characters in Name Pool: " << fileNames->names.GetSize() << "\n";
+   std::cout << "Distinct Extensions: " << fileNames->extensions.GetSize() << "\n";
+
    const auto preOrderTraversal = [&] () noexcept
    {
       std::uintmax_t treeSize{ 0 };
@@ -139,13 +657,109 @@ int main()
       });
    };
 
-   std::cout
-      << "Average Pre-Order Traversal Time: " << RunTrials<ChronoType>(preOrderTraversal)
-      << " " << StopwatchInternals::TypeName<ChronoType>::value << ".\n";
+   // The partitions remain valid for as long as the tree isn't modified, so they only need to be
+   // computed once:
+   std::vector<TreeAlgorithms::TreePartition<const Tree<FileInfo>>> partitions;
+
+   Stopwatch<ChronoType>([&] () noexcept
+   {
+      partitions = TreeAlgorithms::PartitionTree(
+         static_cast<const Tree<FileInfo>&>(*tree), std::thread::hardware_concurrency());
+   }, "Partitioned Tree in ");
+
+   const auto parallelTraversal = [&] () noexcept
+   {
+      std::vector<std::uintmax_t> treeSizes(partitions.size());
+      std::vector<std::uintmax_t> totalBytes(partitions.size());
+
+      std::for_each(
+         std::execution::par,
+         std::begin(partitions),
+         std::end(partitions),
+         [&] (const auto& partition) noexcept
+      {
+         const auto index = static_cast<std::size_t>(&partition - partitions.data());
+
+         std::uintmax_t treeSize{ 0 };
+         std::uintmax_t bytes{ 0 };
+
+         partition.ForEach([&] (const auto& node) noexcept
+         {
+            treeSize += 1;
+
+            if (node.GetData().type == FileType::REGULAR)
+            {
+               bytes += node.GetData().size;
+            }
+         });
+
+         treeSizes[index] = treeSize;
+         totalBytes[index] = bytes;
+      });
+   };
+
+   ReportTrials<ChronoType>("Pre-Order Traversal", preOrderTraversal);
+
+   ReportTrials<ChronoType>("Post-Order Traversal", postOrderTraversal);
+
+   ReportTrials<ChronoType>("Partitioned Parallel Traversal", parallelTraversal);
+
+   std::cout << std::endl;
+
+   OptimizeMemoryLayout<ChronoType>(*tree);
+
+   // Relocating the nodes invalidates the addresses that the index refers to:
+   Stopwatch<ChronoType>([&] () noexcept { scanner.RebuildPathIndex(); }, "Rebuilt Path Index in ");
 
+   ReportTrials<ChronoType>("Post-Order Traversal After Optimization", postOrderTraversal);
+
+   std::cout << std::endl;
+
+   LookUpPaths(scanner, *tree, *fileNames, rootPath);
+
+   std::cout << std::endl;
+
+   FindLargeDirectories(*tree);
+
+   std::cout << std::endl;
+
+   FindLargestFiles(*tree);
+
+   std::cout << std::endl;
+
+   AggregateColumns(*tree, *fileNames);
+
+   std::cout << std::endl;
+
+   // Each sort reverses the order established by the one before, so neither gets presorted input:
+   Stopwatch<ChronoType>([&] () noexcept
+   {
+      std::for_each(std::begin(*tree), std::end(*tree), [] (auto& node) noexcept
+      {
+         node.SortChildren([] (const auto& lhs, const auto& rhs) noexcept
+            { return lhs.GetData().size > rhs.GetData().size; });
+      });
+   }, "Sorted Tree Serially in ");
+
+   Stopwatch<ChronoType>([&] () noexcept
+   {
+      TreeAlgorithms::SortTree(*tree, [] (const auto& lhs, const auto& rhs) noexcept
+         { return lhs.GetData().size < rhs.GetData().size; });
+   }, "Sorted Tree in Parallel in ");
+
+   std::cout << std::endl;
+
+   // Nothing much will have changed since the initial scan, which is the common case for rescans:
+   scanner.Rescan();
+
+   const auto rescan = scanner.GetProgress();
    std::cout
-      << "Average Post-Order Traversal Time: " << RunTrials<ChronoType>(postOrderTraversal)
-      << " " << StopwatchInternals::TypeName<ChronoType>::value << ".\n";
+      << "Number of Changed Directories: " << rescan.changedDirectoryCount << "\n"
+      << "Number of Nodes Removed: " << rescan.removedNodeCount << std::endl;
+
+   std::cout << std::endl;
+
+   MeasureQueueContention();
 
    std::cout << std::endl;
 
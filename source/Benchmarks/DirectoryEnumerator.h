@@ -0,0 +1,78 @@
+#pragma once
+
+#include <experimental/filesystem>
+
+#include <cstdint>
+#include <functional>
+
+#include "FileInfo.hpp"
+
+/**
+* @brief Everything the scanner needs to know about a single directory entry, as reported by the
+* directory enumeration itself.
+*/
+struct DirectoryEntry
+{
+   /**
+   * The name of the entry, in the native encoding of the platform.
+   */
+   std::experimental::filesystem::path::string_type name;
+
+   std::uintmax_t size;
+
+   /**
+   * Symbolic links, junctions, and mount points are all reported as FileType::SYMLINK, since
+   * following them could lead to the same files being counted more than once.
+   */
+   FileType type;
+};
+
+/**
+* @brief What it took to enumerate a directory.
+*/
+struct EnumerationStatistics
+{
+   /**
+   * The number of calls made into the operating system, including those to open and close the
+   * directory.
+   */
+   std::uint32_t systemCalls{ 0 };
+
+   /**
+   * The number of entries that had to be looked up individually, because the listing itself
+   * didn't say enough about them. Each of these lookups is also counted as a system call.
+   */
+   std::uint32_t individualLookups{ 0 };
+};
+
+/**
+* @brief Lists the contents of a directory using batched queries, and only looks up entries
+* individually where the listing itself doesn't say enough about them.
+*
+* On Windows, the listing reports the size and type of every entry, so no entry ever has to be
+* queried individually. POSIX listings report types at best, and never sizes, so every regular
+* file, as well as every entry of unknown type, takes a lookup of its own. These lookups are
+* counted in EnumerationStatistics::individualLookups.
+*
+* @note The "." and ".." entries are skipped.
+*
+* @param[in] directory           The directory to enumerate.
+* @param[in] visitor             Invoked once for every entry in the directory.
+* @param[out] statistics         If provided, receives what it took to enumerate the directory.
+*
+* @returns True if the directory could be enumerated, and false otherwise.
+*/
+bool EnumerateDirectory(
+   const std::experimental::filesystem::path& directory,
+   const std::function<void(const DirectoryEntry&)>& visitor,
+   EnumerationStatistics* statistics = nullptr);
+
+/**
+* @brief Looks up when the contents of a directory last changed. Only adding, removing, or renaming
+* an entry of the directory itself counts; none of this applies to changes made within the entries.
+*
+* @param[in] directory           The directory to look up.
+*
+* @returns The time, in platform-specific ticks, or zero if it couldn't be determined.
+*/
+std::int64_t GetLastWriteTime(const std::experimental::filesystem::path& directory);
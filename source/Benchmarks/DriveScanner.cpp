@@ -1,407 +1,679 @@
 #include "DriveScanner.h"
 
-#include "IgnoreUnused.hpp"
-#include "ScopedHandle.h"
-#include "Stopwatch.hpp"
+#include "DirectoryEnumerator.h"
 
 #include <algorithm>
-#include <iostream>
+#include <cassert>
 #include <memory>
-#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
-#pragma warning(push)
-#pragma warning(disable : 4996)
-#include <boost/asio/post.hpp>
-#pragma warning(pop)
-
-#include <FileApi.h>
-#include <WinIoCtl.h>
-
 namespace
 {
-   std::mutex streamMutex;
-
    /**
-    * @brief Use the `FindFirstFileW(...)` function to retrieve the file size.
-    *
-    * The `std::experimental::filesystem::file_size(...)` function uses a different native function
-    * to get at the file size for a given file, and this function (while probably faster than
-    * `FindFirstFileW(...)`) has a tendency to throw. If such exceptional behaviour were to occur,
-    * then this function can be used to hopefully still get at the file size.
-    *
-    * @param path[in]               The path to the troublesome file.
-    *
-    * @returns The size of the file if it's accessible, and zero otherwise.
+    * @brief Splits a file name into its stem and its extension, following the same rules as
+    * `path::stem()` and `path::extension()`, but without allocating any memory.
     */
-   std::uintmax_t GetFileSizeUsingWinAPI(const std::experimental::filesystem::path& path)
+   std::pair<NativeStringView, NativeStringView> SplitExtension(NativeStringView name) noexcept
    {
-      std::uintmax_t fileSize{ 0 };
-
-      WIN32_FIND_DATA fileData;
-      const HANDLE fileHandle = FindFirstFileW(path.wstring().data(), &fileData);
-      if (fileHandle == INVALID_HANDLE_VALUE)
+      const auto dot = name.rfind(NativeChar{ '.' });
+      if (dot == NativeStringView::npos || dot == 0)
       {
-         return 0;
+         return { name, {} };
       }
 
-      const auto highWord = static_cast<std::uintmax_t>(fileData.nFileSizeHigh);
-      fileSize = (highWord << sizeof(fileData.nFileSizeLow) * 8) | fileData.nFileSizeLow;
-
-      return fileSize;
+      return { name.substr(0, dot), name.substr(dot) };
    }
 
    /**
-    * @brief Helper function to safely wrap the retrieval of a file's size.
-    *
-    * @param path[in]               The path to the file.
-    *
-    * @return The size of the file if it's accessible, and zero otherwise.
+    * @returns The highest ancestor of the specified directory, itself included, whose size is
+    * zero, short of the root of the tree; or nullptr, if the directory itself isn't empty.
     */
-   std::uintmax_t ComputeFileSize(const std::experimental::filesystem::path& path) noexcept
+   Tree<FileInfo>::Node* FindHighestEmptyAncestor(Tree<FileInfo>::Node& directory) noexcept
    {
-      assert(!std::experimental::filesystem::is_directory(path));
+      Tree<FileInfo>::Node* highest = nullptr;
 
-      try
+      for (auto* node = &directory; node->GetParent() && (*node)->size == 0;
+           node = node->GetParent())
       {
-         return std::experimental::filesystem::file_size(path);
+         highest = node;
       }
-      catch (...)
-      {
-         const std::lock_guard<std::mutex> lock{ streamMutex };
-         IgnoreUnused(lock);
 
-         std::wcout << "Falling back on the Win API for: \"" << path.wstring() << "\"" << std::endl;
-         return GetFileSizeUsingWinAPI(path);
-      }
+      return highest;
    }
 
    /**
-    * @brief Removes nodes whose corresponding file or directory size is zero. This is often
-    * necessary because a directory may contain only a single other directory within it that is
-    * empty. In such a case, the outer directory has a size of zero, but
-    * std::experimental::filesystem::is_empty will still have reported this directory as being
-    * non-empty.
+    * @brief Contructs the root node for the file tree.
     *
-    * @param[in, out] tree           The tree to be pruned.
+    * @param[in] path                The path to the directory that should constitute the root node.
+    * @param[in] fileNames           The string storage that the nodes of the tree will refer to.
     */
-   void PruneEmptyFilesAndDirectories(Tree<FileInfo>& tree)
+   std::shared_ptr<Tree<FileInfo>> CreateTreeAndRootNode(
+       const std::experimental::filesystem::path& path, FileNames& fileNames)
+   {
+      if (!std::experimental::filesystem::is_directory(path))
+      {
+         return nullptr;
+      }
+
+      FileInfo fileInfo{ DriveScanner::SIZE_UNDEFINED,
+                         fileNames.names.Append(path.native()),
+                         InternTable::EMPTY_STRING_ID,
+                         FileType::DIRECTORY,
+                         0 };
+
+      // Since a full drive scan can easily yield millions of nodes, carve them out of an arena
+      // instead of allocating each node individually:
+      return std::make_shared<Tree<FileInfo>>(
+          std::move(fileInfo), std::make_unique<Tree<FileInfo>::NodeArena>());
+   }
+}
+
+DriveScanner::DriveScanner(
+    const std::experimental::filesystem::path& path,
+    unsigned int threadCount,
+    PathIndexing pathIndexing)
+    : m_fileNames{ std::make_shared<FileNames>() },
+      m_fileTree{ CreateTreeAndRootNode(path, *m_fileNames) },
+      m_pathIndex{ pathIndexing == PathIndexing::ENABLED ? std::make_unique<PathIndex>(*m_fileNames)
+                                                          : nullptr },
+      m_rootPath{ path },
+      m_telemetry{ std::max(threadCount, 1u) + std::size_t{ 1 } },
+      m_scheduler{ threadCount }
+{
+}
+
+DriveScanner::~DriveScanner()
+{
+   if (m_asyncScan.valid())
+   {
+      Cancel();
+      m_asyncScan.wait();
+   }
+}
+
+ScanTelemetry::Counters& DriveScanner::GetLocalCounters() noexcept
+{
+   return m_telemetry.GetCounters(m_scheduler.GetCurrentWorkerIndex());
+}
+
+void DriveScanner::EnumerateAndCount(
+    const std::experimental::filesystem::path& path,
+    const std::function<void(const DirectoryEntry&)>& visitor) noexcept
+{
+   auto& counters = GetLocalCounters();
+
+   std::uint64_t fileCount{ 0 };
+   std::uint64_t byteCount{ 0 };
+   std::uint64_t skippedLinkCount{ 0 };
+
+   EnumerationStatistics statistics;
+
+   const auto succeeded = EnumerateDirectory(
+       path,
+       [&](const DirectoryEntry& entry) {
+          if (entry.type == FileType::REGULAR)
+          {
+             ++fileCount;
+             byteCount += entry.size;
+          }
+          else if (entry.type == FileType::SYMLINK)
+          {
+             ++skippedLinkCount;
+          }
+
+          visitor(entry);
+       },
+       &statistics);
+
+   // Counting the totals once per directory, rather than once per entry, keeps the counters out
+   // of the inner loop:
+   ScanTelemetry::Add(counters.directories, 1);
+   ScanTelemetry::Add(counters.files, fileCount);
+   ScanTelemetry::Add(counters.bytes, byteCount);
+   ScanTelemetry::Add(counters.skippedLinks, skippedLinkCount);
+   ScanTelemetry::Add(counters.failedDirectories, succeeded ? 0 : 1);
+   ScanTelemetry::Add(counters.systemCalls, statistics.systemCalls);
+   ScanTelemetry::Add(counters.individualLookups, statistics.individualLookups);
+}
+
+Tree<FileInfo>::Node* DriveScanner::ProcessFile(
+    const DirectoryEntry& entry, Tree<FileInfo>::Node& node) noexcept
+{
+   if (entry.size == 0u)
+   {
+      return nullptr;
+   }
+
+   // Neither the name nor the extension is copied into a string of its own; the name is appended
+   // to the pool, and the extension, which is almost certainly one we've seen before, is looked
+   // up in the intern table:
+   const auto[stem, extension] = SplitExtension(entry.name);
+
+   FileInfo fileInfo{ entry.size,
+                      m_fileNames->names.Append(stem),
+                      m_fileNames->extensions.Intern(extension),
+                      FileType::REGULAR,
+                      0 };
+
+   auto* const fileNode = node.AppendChildConcurrently(std::move(fileInfo));
+
+   if (m_pathIndex)
+   {
+      m_pathIndex->Insert(*fileNode);
+   }
+
+   return fileNode;
+}
+
+void DriveScanner::ProcessDirectory(
+    const std::experimental::filesystem::path& path,
+    const DirectoryEntry& entry,
+    Tree<FileInfo>::Node& node,
+    PendingDirectory* parent,
+    unsigned int depth) noexcept
+{
+   // Whether the directory is empty won't be known until it has been scanned, so its Node is
+   // created on the side, and is only attached once it's known to have a size:
+   FileInfo directoryInfo{ DriveScanner::SIZE_UNDEFINED,
+                           m_fileNames->names.Append(entry.name),
+                           InternTable::EMPTY_STRING_ID,
+                           FileType::DIRECTORY,
+                           0 };
+
+   auto* const directoryNode = m_fileTree->GetArena()->CreateConcurrently(std::move(directoryInfo));
+
+   if (parent)
+   {
+      parent->unfinishedTasks.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   auto* const directory = new PendingDirectory{ *directoryNode, &node, parent, depth };
+
+   m_scheduler.Spawn([ this, path = path / entry.name, directory ]() noexcept {
+      ScanDirectory(path, *directory);
+   });
+}
+
+void DriveScanner::ScanDirectory(
+    const std::experimental::filesystem::path& path, PendingDirectory& directory) noexcept
+{
+   // In some edge-cases, the operating system doesn't allow anyone to access certain directories.
+   // One example of a problematic directory in Windows 7 is: "C:\System Volume Information".
+   // Such directories simply fail to enumerate.
+   //
+   // The time at which the directory last changed is recorded, so that a later rescan can tell
+   // whether its entries have to be enumerated again.
+   //
+   // Regular files are processed right here, as part of this task, so that only subdirectories
+   // have to make a trip through the scheduler. Symbolic links and other reparse points that lead
+   // elsewhere are not followed.
+   //
+   // Once the scan has been cancelled, the directories that are still waiting to be scanned are
+   // merely finished off, so that their pending ancestors get completed as usual.
+   if (IsCancelled())
    {
-      std::vector<Tree<FileInfo>::Node*> toBeDeleted;
+      FinishTask(&directory);
+      return;
+   }
 
-      for (auto&& node : tree)
+   auto& node = directory.node;
+   node->lastWriteTime = GetLastWriteTime(path);
+   ScanTelemetry::Add(GetLocalCounters().systemCalls, 1);
+
+   std::uintmax_t fileSizes{ 0 };
+
+   EnumerateAndCount(path, [&](const DirectoryEntry& entry) noexcept {
+      if (entry.type == FileType::REGULAR)
       {
-         if (node->size == 0)
+         if (ProcessFile(entry, node))
          {
-            toBeDeleted.emplace_back(&node);
+            fileSizes += entry.size;
          }
       }
-
-      const auto nodesRemoved = toBeDeleted.size();
-
-      for (auto* node : toBeDeleted)
+      else if (entry.type == FileType::DIRECTORY && directory.depth < m_options.maximumDepth)
       {
-         node->DeleteFromTree();
+         ProcessDirectory(path, entry, node, &directory, directory.depth + 1);
       }
+   });
 
-      std::cout << "Number of Sizeless Files Removed: " << nodesRemoved << std::endl;
-   }
+   directory.size.fetch_add(fileSizes, std::memory_order_relaxed);
+   FinishTask(&directory);
+}
 
-   /**
-    * @brief Performs a post-processing step that iterates through the tree and computes the size
-    * of all directories.
-    *
-    * @param[in, out] tree          The tree whose nodes need their directory sizes computed.
-    */
-   void ComputeDirectorySizes(Tree<FileInfo>& tree)
+void DriveScanner::FinishTask(PendingDirectory* directory) noexcept
+{
+   // The last task to finish sees the sizes added by all the others, thanks to the acquire-release
+   // ordering of the countdown:
+   while (directory && directory->unfinishedTasks.fetch_sub(1, std::memory_order_acq_rel) == 1)
    {
-      for (auto&& node : tree)
+      auto& node = directory->node;
+      auto* const parentNode = directory->parentNode;
+      auto* const parent = directory->parent;
+
+      const auto size = directory->size.load(std::memory_order_relaxed);
+      node->size = size;
+
+      delete directory;
+
+      if (!parentNode)
+      {
+         if (m_options.onSubtreeScanned)
+         {
+            m_options.onSubtreeScanned(node);
+         }
+
+         return;
+      }
+
+      // Empty directories are never attached, and their subdirectories, being empty as well,
+      // were never attached to them either:
+      if (size == 0)
       {
-         Tree<FileInfo>::Node* parent = node.GetParent();
-         if (!parent)
+         m_fileTree->GetArena()->DestroyConcurrently(&node);
+      }
+      else
+      {
+         parentNode->AppendChildConcurrently(node);
+
+         if (m_pathIndex)
+         {
+            m_pathIndex->Insert(node);
+         }
+
+         if (m_options.onSubtreeScanned)
          {
-            return;
+            m_options.onSubtreeScanned(node);
          }
 
-         FileInfo& parentInfo = parent->GetData();
-         if (parentInfo.type == FileType::DIRECTORY)
+         if (parent)
+         {
+            parent->size.fetch_add(size, std::memory_order_relaxed);
+         }
+         else
          {
-            parentInfo.size += node->size;
+            const std::lock_guard<decltype(m_changes.mutex)> lock{ m_changes.mutex };
+            m_changes.sizeDeltas.emplace_back(parentNode, static_cast<std::intmax_t>(size));
          }
       }
+
+      directory = parent;
    }
+}
 
-   /**
-    * @brief Contructs the root node for the file tree.
-    *
-    * @param[in] path                The path to the directory that should constitute the root node.
-    */
-   std::shared_ptr<Tree<FileInfo>>
-   CreateTreeAndRootNode(const std::experimental::filesystem::path& path)
+void DriveScanner::RescanDirectory(
+    const std::experimental::filesystem::path& path, Tree<FileInfo>::Node& node) noexcept
+{
+   if (IsCancelled())
    {
-      if (!std::experimental::filesystem::is_directory(path))
+      return;
+   }
+
+   const auto lastWriteTime = GetLastWriteTime(path);
+   ScanTelemetry::Add(GetLocalCounters().systemCalls, 1);
+
+   // No entry can have come or gone if the time is still the same, so only the subdirectories
+   // need looking into:
+   if (m_changeDetection == ChangeDetection::DIRECTORY_TIMESTAMPS && lastWriteTime != 0 &&
+       lastWriteTime == node->lastWriteTime)
+   {
+      for (auto* child = node.GetFirstChild(); child; child = child->GetNextSibling())
       {
-         return nullptr;
+         if ((*child)->type == FileType::DIRECTORY)
+         {
+            SpawnRescan(path / m_fileNames->GetFullName(child->GetData()), *child);
+         }
       }
 
-      FileInfo fileInfo{ path.wstring(),
-                         /* extension = */ L"",
-                         DriveScanner::SIZE_UNDEFINED,
-                         FileType::DIRECTORY };
-
-      return std::make_shared<Tree<FileInfo>>(Tree<FileInfo>(std::move(fileInfo)));
+      return;
    }
 
-   /**
-    * @returns A handle representing the repartse point found at the given path. If
-    * the path is not a reparse point, then an invalid handle will be returned instead.
-    */
-   ScopedHandle OpenReparsePoint(const std::experimental::filesystem::path& path)
+   node->lastWriteTime = lastWriteTime;
+
+   // Whatever is left in here once the directory has been enumerated no longer exists:
+   std::unordered_map<std::basic_string<NativeChar>, Tree<FileInfo>::Node*> existingChildren;
+   existingChildren.reserve(node.GetChildCount());
+
+   for (auto* child = node.GetFirstChild(); child; child = child->GetNextSibling())
    {
-      const auto handle = CreateFile(
-          /* fileName = */ path.wstring().c_str(),
-          /* desiredAccess = */ GENERIC_READ,
-          /* shareMode = */ 0,
-          /* securityAttributes = */ 0,
-          /* creationDisposition = */ OPEN_EXISTING,
-          /* flagsAndAttributes = */ FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OPEN_REPARSE_POINT,
-          /* templateFile = */ nullptr);
-
-      return ScopedHandle{ handle };
+      existingChildren.emplace(m_fileNames->GetFullName(child->GetData()), child);
    }
 
-   /**
-    * @brief Reads the reparse point found at the given path into the output buffer.
-    *
-    * @returns True if the path could be read as a reparse point, and false otherwise.
-    */
-   bool ReadReparsePoint(const std::wstring& path, std::vector<std::byte>& reparseBuffer)
-   {
-      const auto handle = OpenReparsePoint(path);
-      if (!handle.IsValid())
+   std::intmax_t sizeDelta{ 0 };
+
+   std::vector<Tree<FileInfo>::Node*> removedNodes;
+
+   const auto removeNode = [&](Tree<FileInfo>::Node& child) {
+      sizeDelta -= static_cast<std::intmax_t>(child->size);
+      removedNodes.emplace_back(&child);
+   };
+
+   // Should the directory fail to enumerate, then all of its children will be removed, which is
+   // what a full scan would have ended up with as well:
+   EnumerateAndCount(path, [&](const DirectoryEntry& entry) noexcept {
+      if (entry.type != FileType::REGULAR && entry.type != FileType::DIRECTORY)
       {
-         return false;
+         return;
       }
 
-      DWORD bytesReturned{ 0 };
+      Tree<FileInfo>::Node* existingChild = nullptr;
 
-      const auto successfullyRetrieved =
-          DeviceIoControl(
-              /* device = */ handle,
-              /* controlCode = */ FSCTL_GET_REPARSE_POINT,
-              /* inBuffer = */ NULL,
-              /* inBufferSize = */ 0,
-              /* outBuffer = */ reinterpret_cast<LPVOID>(reparseBuffer.data()),
-              /* outBufferSize = */ static_cast<DWORD>(reparseBuffer.size()),
-              /* bytesReturned = */ &bytesReturned,
-              /* overlapped = */ 0) == TRUE;
+      const auto match = existingChildren.find(entry.name);
+      if (match != std::end(existingChildren))
+      {
+         existingChild = match->second;
+         existingChildren.erase(match);
 
-      return successfullyRetrieved && bytesReturned;
+         // An entry that was replaced by one of another type is treated as an entirely new one:
+         if ((*existingChild)->type != entry.type)
+         {
+            removeNode(*existingChild);
+            existingChild = nullptr;
+         }
+      }
+
+      if (entry.type == FileType::REGULAR)
+      {
+         if (!existingChild)
+         {
+            if (ProcessFile(entry, node))
+            {
+               sizeDelta += static_cast<std::intmax_t>(entry.size);
+            }
+         }
+         else if (entry.size == 0u)
+         {
+            removeNode(*existingChild);
+         }
+         else if (entry.size != (*existingChild)->size)
+         {
+            sizeDelta += static_cast<std::intmax_t>(entry.size) -
+                         static_cast<std::intmax_t>((*existingChild)->size);
+
+            (*existingChild)->size = entry.size;
+         }
+
+         return;
+      }
+
+      // New subdirectories are scanned from scratch, and report their size once they're done:
+      if (!existingChild)
+      {
+         const auto depth = Tree<FileInfo>::Depth(node) + 1;
+         if (depth <= m_options.maximumDepth)
+         {
+            ProcessDirectory(path, entry, node, nullptr, depth);
+         }
+
+         return;
+      }
+
+      SpawnRescan(path / entry.name, *existingChild);
+   });
+
+   for (auto& nameAndNode : existingChildren)
+   {
+      removeNode(*nameAndNode.second);
    }
 
-   /**
-    * @returns True if the given file path matches the given reparse tag, and false otherwise.
-    */
-   bool IsReparseTag(const std::experimental::filesystem::path& path, DWORD targetTag)
+   if (sizeDelta == 0 && removedNodes.empty())
    {
-      static std::vector<std::byte> buffer{ MAXIMUM_REPARSE_DATA_BUFFER_SIZE };
+      return;
+   }
 
-      const auto successfullyRead = ReadReparsePoint(path, buffer);
+   const std::lock_guard<decltype(m_changes.mutex)> lock{ m_changes.mutex };
 
-      return successfullyRead
-                 ? reinterpret_cast<REPARSE_DATA_BUFFER*>(buffer.data())->ReparseTag == targetTag
-                 : false;
+   if (sizeDelta != 0)
+   {
+      m_changes.sizeDeltas.emplace_back(&node, sizeDelta);
    }
 
-   /**
-    * @returns True if the given file path represents a mount point, and false otherwise.
-    *
-    * @note Junctions in Windows are considered mount points.
-    */
-   bool IsMountPoint(const std::experimental::filesystem::path& path)
+   m_changes.removedNodes.insert(
+       std::end(m_changes.removedNodes), std::begin(removedNodes), std::end(removedNodes));
+}
+
+void DriveScanner::SpawnRescan(
+    std::experimental::filesystem::path path, Tree<FileInfo>::Node& node) noexcept
+{
+   m_scheduler.Spawn([ this, path = std::move(path), &directory = node ]() noexcept {
+      RescanDirectory(path, directory);
+   });
+}
+
+void DriveScanner::ApplyRescannedChanges()
+{
+   // Each change only affects the sizes along the path from its directory up to the root:
+   for (const auto& directoryAndDelta : m_changes.sizeDeltas)
    {
-      const auto isMountPoint = IsReparseTag(path, IO_REPARSE_TAG_MOUNT_POINT);
+      const auto delta = static_cast<std::uintmax_t>(directoryAndDelta.second);
 
-      if (isMountPoint)
+      for (auto* node = directoryAndDelta.first; node; node = node->GetParent())
       {
-         const std::lock_guard<decltype(streamMutex)> lock{ streamMutex };
-         std::wcout << L"Found Mount Point: " << path.wstring() << L'\n';
+         // Unsigned arithmetic wraps around, so adding the two's complement subtracts:
+         (*node)->size += delta;
       }
-
-      return isMountPoint;
    }
 
-   /**
-    * @returns True if the given file path represents a symlink, and false otherwise.
-    */
-   bool IsSymlink(const std::experimental::filesystem::path& path)
+   for (auto* node : m_changes.removedNodes)
    {
-      const auto isSymlink = IsReparseTag(path, IO_REPARSE_TAG_SYMLINK);
-
-      if (isSymlink)
+      if (m_pathIndex)
       {
-         const std::lock_guard<decltype(streamMutex)> lock{ streamMutex };
-         std::wcout << L"Found Symlink: " << path.wstring() << L'\n';
+         m_pathIndex->EraseSubtree(*node);
       }
 
-      return isSymlink;
+      node->DeleteFromTree();
    }
 
-   /**
-    * @returns True is the given file path matches any of the listed reparse tag, and false
-    * otherwise.
-    */
-   bool IsUnknownReparsePoint(const std::experimental::filesystem::path& path)
+   // Directories that shrank may now be empty, possibly along with some of their ancestors. Only
+   // the highest such ancestor needs removing, and it's the same for every directory below it:
+   std::unordered_set<Tree<FileInfo>::Node*> emptyDirectories;
+
+   for (const auto& directoryAndDelta : m_changes.sizeDeltas)
    {
-      constexpr auto reparseTag =
-          IO_REPARSE_TAG_MOUNT_POINT | IO_REPARSE_TAG_HSM | IO_REPARSE_TAG_DRIVE_EXTENDER |
-          IO_REPARSE_TAG_HSM2 | IO_REPARSE_TAG_SIS | IO_REPARSE_TAG_WIM | IO_REPARSE_TAG_CSV |
-          IO_REPARSE_TAG_DFS | IO_REPARSE_TAG_FILTER_MANAGER | IO_REPARSE_TAG_IIS_CACHE |
-          IO_REPARSE_TAG_DFSR | IO_REPARSE_TAG_DEDUP | IO_REPARSE_TAG_APPXSTRM |
-          IO_REPARSE_TAG_NFS | IO_REPARSE_TAG_FILE_PLACEHOLDER | IO_REPARSE_TAG_DFM |
-          IO_REPARSE_TAG_WOF;
+      if (directoryAndDelta.second >= 0)
+      {
+         continue;
+      }
 
-      const auto isRandomReparse = IsReparseTag(path, reparseTag);
+      if (auto* const highest = FindHighestEmptyAncestor(*directoryAndDelta.first))
+      {
+         emptyDirectories.emplace(highest);
+      }
+   }
 
-      if (isRandomReparse)
+   for (auto* directory : emptyDirectories)
+   {
+      if (m_pathIndex)
       {
-         const std::lock_guard<decltype(streamMutex)> lock{ streamMutex };
-         std::wcout << L"Found unkown: " << path.wstring() << L'\n';
+         m_pathIndex->EraseSubtree(*directory);
       }
 
-      return isRandomReparse;
+      directory->DeleteFromTree();
    }
 
-   /**
-    * @returns True if the given path represents a reparse point, and false otherwise.
-    */
-   bool IsReparsePoint(const std::experimental::filesystem::path& path)
+   m_changedDirectoryCount = m_changes.sizeDeltas.size();
+   m_removedNodeCount = m_changes.removedNodes.size() + emptyDirectories.size();
+
+   m_changes.sizeDeltas.clear();
+   m_changes.removedNodes.clear();
+}
+
+std::shared_ptr<Tree<FileInfo>> DriveScanner::GetTree()
+{
+   return m_fileTree;
+}
+
+std::shared_ptr<FileNames> DriveScanner::GetFileNames()
+{
+   return m_fileNames;
+}
+
+const Tree<FileInfo>::Node* DriveScanner::FindNode(
+    const std::experimental::filesystem::path& path) const
+{
+   assert(m_pathIndex);
+
+   // A trailing separator shows up as an empty component, or as a dot, depending on the library:
+   const auto isSignificant = [](const std::experimental::filesystem::path& component) {
+      const auto& name = component.native();
+      return !name.empty() && !(name.size() == 1 && name.front() == NativeChar{ '.' });
+   };
+
+   auto pathItr = std::begin(path);
+   const auto pathEnd = std::end(path);
+
+   for (const auto& rootComponent : m_rootPath)
    {
-      const ScopedHandle handle = OpenReparsePoint(path);
-      if (!handle.IsValid())
+      if (!isSignificant(rootComponent))
       {
-         return false;
+         continue;
+      }
+
+      if (pathItr == pathEnd || *pathItr != rootComponent)
+      {
+         return nullptr;
       }
 
-      BY_HANDLE_FILE_INFORMATION fileInfo = { 0 };
+      ++pathItr;
+   }
+
+   const Tree<FileInfo>::Node* node = m_fileTree->GetRoot();
 
-      const auto successfullyRetrieved = GetFileInformationByHandle(handle, &fileInfo);
-      if (!successfullyRetrieved)
+   for (; node && pathItr != pathEnd; ++pathItr)
+   {
+      if (isSignificant(*pathItr))
       {
-         return false;
+         node = m_pathIndex->Find(*node, pathItr->native());
       }
+   }
 
-      return fileInfo.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT;
+   return node;
+}
+
+void DriveScanner::RebuildPathIndex()
+{
+   if (m_pathIndex)
+   {
+      m_pathIndex->Rebuild(*m_fileTree);
    }
 }
 
-DriveScanner::DriveScanner(const std::experimental::filesystem::path& path)
-    : m_fileTree{ CreateTreeAndRootNode(path) }, m_rootPath{ path }
+void DriveScanner::SetProgressCallback(
+    ProgressCallback callback, std::chrono::milliseconds interval)
 {
+   m_progressCallback = std::move(callback);
+   m_progressInterval = interval;
 }
 
-void DriveScanner::ProcessFile(
-    const std::experimental::filesystem::path& path, Tree<FileInfo>::Node& node) noexcept
+ScanProgress DriveScanner::GetProgress() const
 {
-   const auto fileSize = ComputeFileSize(path);
-   if (fileSize == 0u)
-   {
-      return;
-   }
+   auto progress = m_telemetry.TakeSnapshot();
 
-   FileInfo fileInfo{ path.filename().stem().wstring(),
-                      path.filename().extension().wstring(),
-                      fileSize,
-                      FileType::REGULAR };
+   progress.queuedTaskCount = m_scheduler.GetQueuedTaskCount();
+   progress.lockWaitTime = m_scheduler.GetLockWaitTime() - m_lockWaitTimeAtStart;
+   progress.changedDirectoryCount = m_changedDirectoryCount;
+   progress.removedNodeCount = m_removedNodeCount;
+   progress.isComplete = !m_isScanning.load();
 
-   const std::lock_guard<decltype(m_mutex)> lock{ m_mutex };
-   node.AppendChild(std::move(fileInfo));
+   return progress;
 }
 
-void DriveScanner::ProcessDirectory(
-    const std::experimental::filesystem::path& path, Tree<FileInfo>::Node& node) noexcept
+void DriveScanner::WaitForScan()
 {
-   bool isRegularFile = false;
-   try
-   {
-      // In certain cases, this function can, apparently, raise exceptions, although it
-      // isn't entirely clear to me what circumstances need to exist for this to occur:
-      isRegularFile = std::experimental::filesystem::is_regular_file(path);
-   }
-   catch (...)
+   if (!m_progressCallback)
    {
+      m_scheduler.Wait();
       return;
    }
 
-   if (isRegularFile)
+   while (!m_scheduler.WaitFor(m_progressInterval))
    {
-      ProcessFile(path, node);
+      m_progressCallback(GetProgress());
    }
-   else if (
-       std::experimental::filesystem::is_directory(path) &&
-       !IsReparsePoint(path))
-   {
-      try
-      {
-         // In some edge-cases, the Windows operating system doesn't allow anyone to access certain
-         // directories, and attempts to do so will result in exceptional behaviour---pun intended.
-         // In order to deal with these rare cases, we'll need to rely on a try-catch to keep going.
-         // One example of a problematic directory in Windows 7 is: "C:\System Volume Information".
-         if (std::experimental::filesystem::is_empty(path))
-         {
-            return;
-         }
-      }
-      catch (...)
-      {
-         return;
-      }
+}
 
-      FileInfo directoryInfo{ path.filename().wstring(),
-                              /* extension = */ L"",
-                              DriveScanner::SIZE_UNDEFINED,
-                              FileType::DIRECTORY };
+void DriveScanner::PrepareForScan()
+{
+   m_telemetry.Reset();
+   m_lockWaitTimeAtStart = m_scheduler.GetLockWaitTime();
+   m_changedDirectoryCount = 0;
+   m_removedNodeCount = 0;
+   m_isCancellationRequested = false;
+   m_isScanning = true;
+}
 
-      std::unique_lock<decltype(m_mutex)> lock{ m_mutex };
-      auto* const lastChild = node.AppendChild(std::move(directoryInfo));
-      lock.unlock();
+void DriveScanner::FinishScan()
+{
+   m_isScanning = false;
 
-      auto itr = std::experimental::filesystem::directory_iterator{ path };
-      AddDirectoriesToQueue(itr, *lastChild);
+   if (m_progressCallback)
+   {
+      m_progressCallback(GetProgress());
    }
 }
 
-void DriveScanner::AddDirectoriesToQueue(
-    std::experimental::filesystem::directory_iterator& itr, Tree<FileInfo>::Node& node) noexcept
+void DriveScanner::Start()
 {
-   const auto end = std::experimental::filesystem::directory_iterator{};
-   while (itr != end)
-   {
-      boost::asio::post(
-          m_threadPool, [&, path = itr->path() ]() noexcept { ProcessDirectory(path, node); });
+   m_options = ScanOptions{};
+   PrepareForScan();
 
-      ++itr;
-   }
+   // Directory sizes are rolled up as the scan goes, so there's nothing left to do once the last
+   // task has finished:
+   auto* const root = new PendingDirectory{ *m_fileTree->GetRoot(), nullptr, nullptr, 0 };
+
+   m_scheduler.Spawn([&, root]() noexcept { ScanDirectory(m_rootPath, *root); });
+   WaitForScan();
+
+   FinishScan();
 }
 
-std::shared_ptr<Tree<FileInfo>> DriveScanner::GetTree()
+std::shared_future<void> DriveScanner::StartAsync(ScanOptions options)
 {
-   return m_fileTree;
+   assert(!m_isScanning);
+
+   m_options = std::move(options);
+   PrepareForScan();
+
+   auto* const root = new PendingDirectory{ *m_fileTree->GetRoot(), nullptr, nullptr, 0 };
+
+   m_scheduler.Spawn([&, root]() noexcept { ScanDirectory(m_rootPath, *root); });
+
+   m_asyncScan = std::async(std::launch::async, [this] {
+                    WaitForScan();
+                    FinishScan();
+                 }).share();
+
+   return m_asyncScan;
 }
 
-void DriveScanner::Start()
+std::shared_future<void> DriveScanner::StartAsync()
 {
-   Stopwatch<std::chrono::seconds>(
-       [&]() noexcept {
-          boost::asio::post(m_threadPool, [&]() noexcept {
-             auto itr = std::experimental::filesystem::directory_iterator{ m_rootPath };
-             AddDirectoriesToQueue(itr, *m_fileTree->GetRoot());
-          });
-
-          m_threadPool.join();
-       },
-       "\nScanned Drive in ");
+   return StartAsync(ScanOptions{});
+}
+
+void DriveScanner::Cancel() noexcept
+{
+   m_isCancellationRequested.store(true, std::memory_order_relaxed);
+}
+
+bool DriveScanner::IsCancelled() const noexcept
+{
+   return m_isCancellationRequested.load(std::memory_order_relaxed);
+}
+
+void DriveScanner::Rescan(ChangeDetection changeDetection)
+{
+   m_changeDetection = changeDetection;
+
+   PrepareForScan();
+
+   m_scheduler.Spawn([&]() noexcept { RescanDirectory(m_rootPath, *m_fileTree->GetRoot()); });
+   WaitForScan();
+
+   ApplyRescannedChanges();
 
-   ComputeDirectorySizes(*m_fileTree);
-   PruneEmptyFilesAndDirectories(*m_fileTree);
+   FinishScan();
 }
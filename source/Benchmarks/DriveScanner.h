@@ -5,18 +5,22 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
-
-#pragma warning(push )
-#pragma warning(disable: 4996)
-#include <boost/asio/thread_pool.hpp>
-#pragma warning(pop)
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "../Tree/Tree.hpp"
+#include "DirectoryEnumerator.h"
 #include "FileInfo.hpp"
-#include "WinHack.hpp"
+#include "PathIndex.h"
+#include "ScanTelemetry.h"
+#include "WorkStealingScheduler.h"
 
 /**
 * @brief Wrapper around node and path.
@@ -36,57 +40,388 @@ public:
 
    static constexpr std::uintmax_t SIZE_UNDEFINED{ 0 };
 
-   explicit DriveScanner(const std::experimental::filesystem::path& path);
+   /**
+   * @brief How a rescan decides which directories have to be enumerated again.
+   */
+   enum class ChangeDetection
+   {
+      /**
+      * Directories whose last write time hasn't changed since the previous scan are not
+      * enumerated again; only their subdirectories are revisited. This misses files that were
+      * modified in place, as well as entries that were too empty to be kept the last time round,
+      * such as empty directories that have since been filled, until their parent changes.
+      */
+      DIRECTORY_TIMESTAMPS,
+
+      /**
+      * Every directory is enumerated again, which picks up every change.
+      */
+      FULL_ENUMERATION
+   };
 
    /**
-   * @brief Kicks off the drive scanning process.
+   * @brief Whether the scanner maintains a PathIndex alongside the tree.
+   */
+   enum class PathIndexing
+   {
+      DISABLED,
+      ENABLED
+   };
+
+   /**
+   * @brief Receives progress reports while a scan or rescan is underway.
+   */
+   using ProgressCallback = std::function<void(const ScanProgress&)>;
+
+   /**
+   * @brief Receives the Node of every directory whose subtree has been scanned in full.
+   */
+   using SubtreeCallback = std::function<void(const Tree<FileInfo>::Node&)>;
+
+   static constexpr unsigned int UNLIMITED_DEPTH{ std::numeric_limits<unsigned int>::max() };
+
+   /**
+   * @brief Options that shape a scan started by StartAsync(...).
+   */
+   struct ScanOptions
+   {
+      /**
+      * The depth, relative to the directory being scanned, beyond which subdirectories aren't
+      * scanned. A depth of zero only scans the entries of the directory itself, a depth of one
+      * the entries of its subdirectories as well, and so on. Subdirectories that aren't scanned
+      * are left out of the tree altogether, and don't count towards the sizes of their ancestors.
+      */
+      unsigned int maximumDepth{ UNLIMITED_DEPTH };
+
+      /**
+      * Invoked, from whichever scanning thread finished it, as soon as a directory and all of its
+      * subdirectories have been scanned and attached to the tree, which happens bottom-up.
+      *
+      * From then on, nothing under that directory will change until the next rescan, so the
+      * subtree may be read from any thread while the rest of the scan carries on, provided that
+      * the thread reading it synchronizes with the callback. Since the directory's siblings, and
+      * so its own links to them, may still change, the subtree should be walked through
+      * Tree::ForEach(...), which never looks beyond the Node it starts from, rather than through
+      * the iterators.
+      *
+      * The callback must be thread-safe, and should return quickly, as it holds up the thread
+      * that invokes it.
+      */
+      SubtreeCallback onSubtreeScanned{ nullptr };
+   };
+
+   /**
+   * @param[in] path                The directory to scan.
+   * @param[in] threadCount         The number of threads to scan with.
+   * @param[in] pathIndexing        Whether to index the nodes by path, as they're added.
+   */
+   explicit DriveScanner(
+      const std::experimental::filesystem::path& path,
+      unsigned int threadCount = std::thread::hardware_concurrency(),
+      PathIndexing pathIndexing = PathIndexing::DISABLED);
+
+   /**
+   * @brief Cancels any scan that is still underway, and waits for it to wind down.
+   */
+   ~DriveScanner();
+
+   DriveScanner(const DriveScanner&) = delete;
+   DriveScanner& operator=(const DriveScanner&) = delete;
+
+   /**
+   * @brief Kicks off the drive scanning process, and blocks until it's done.
    */
    void Start();
 
+   /**
+   * @brief Kicks off the drive scanning process, and returns right away.
+   *
+   * Progress is reported, if a callback was set, from a thread of its own, which waits for the
+   * scan on behalf of the caller. Every directory can be picked up as soon as its subtree has
+   * been scanned, through ScanOptions::onSubtreeScanned, and the scan can be cut short through
+   * Cancel().
+   *
+   * @note No other member function but GetProgress(), Cancel(), and IsCancelled() may be called
+   * until the scan is done.
+   *
+   * @param[in] options             The options to scan with.
+   *
+   * @returns A future that becomes ready once the scan has finished, or has been cancelled.
+   */
+   std::shared_future<void> StartAsync(ScanOptions options);
+
+   /**
+   * @overload Scans with the default options.
+   */
+   std::shared_future<void> StartAsync();
+
+   /**
+   * @brief Asks the scan or rescan that is underway to stop, and returns right away.
+   *
+   * Cancellation is cooperative: directories that are already being enumerated are finished,
+   * while those that haven't been started yet are skipped. The tree is left in a consistent
+   * state, but the directories that were cut short only account for what had been found in them
+   * by then. A later call to Start(), StartAsync(...), or Rescan(...) starts afresh.
+   */
+   void Cancel() noexcept;
+
+   /**
+   * @returns True if the current, or the most recent, scan or rescan was cancelled.
+   */
+   bool IsCancelled() const noexcept;
+
+   /**
+   * @brief Brings the tree produced by a previous call to Start() up to date.
+   *
+   * The rescan honours the ScanOptions of the scan that produced the tree.
+   *
+   * Rather than rebuilding the tree, the entries of each directory are matched up against the
+   * existing nodes by name; only the nodes of entries that came or went are added or removed.
+   * Size changes are then propagated up the ancestors of the directories they occurred in, and
+   * only new subdirectories have their sizes computed from scratch.
+   *
+   * @param[in] changeDetection     How to decide which directories to enumerate again.
+   */
+   void Rescan(ChangeDetection changeDetection = ChangeDetection::DIRECTORY_TIMESTAMPS);
+
+   /**
+   * @brief Has the thread that waits for a scan or rescan to finish report on the progress of the
+   * scan at regular intervals while it waits, and then once more when the scan has finished.
+   *
+   * Since the reports are made by the waiting thread, rather than by the scanning threads, whatever
+   * the callback does, such as writing to the console, never holds up the scan itself.
+   *
+   * @param[in] callback            The callback to report to, or nullptr to stop reporting.
+   * @param[in] interval            The time between reports.
+   */
+   void SetProgressCallback(
+      ProgressCallback callback,
+      std::chrono::milliseconds interval = std::chrono::milliseconds{ 500 });
+
+   /**
+   * @returns A snapshot of the progress of the current, or the most recent, scan or rescan. This
+   * may be called from any thread, at any time.
+   */
+   ScanProgress GetProgress() const;
+
    /**
    * @returns The file tree.
    */
    std::shared_ptr<Tree<FileInfo>> GetTree();
 
+   /**
+   * @returns The strings that the nodes of the file tree refer to.
+   */
+   std::shared_ptr<FileNames> GetFileNames();
+
+   /**
+   * @brief Looks up the Node of a file or directory by its path, in a single hash lookup per
+   * component of the path, rather than by searching every directory along the way.
+   *
+   * @note Requires the scanner to have been constructed with PathIndexing::ENABLED.
+   *
+   * @param[in] path                The path to look up, which must lie within the scanned
+   *                                directory, and be spelled the same way.
+   *
+   * @returns The Node, or nullptr if the path isn't part of the tree.
+   */
+   const Tree<FileInfo>::Node* FindNode(const std::experimental::filesystem::path& path) const;
+
+   /**
+   * @brief Indexes the tree all over again. This is necessary whenever the nodes of the tree have
+   * been moved, as is the case after a call to Tree::OptimizeMemoryLayoutFor(...).
+   */
+   void RebuildPathIndex();
+
 private:
 
+   /**
+   * @brief Runs the scheduler until every task has finished, reporting on the progress along the
+   * way, if anyone is listening.
+   */
+   void WaitForScan();
+
+   /**
+   * @brief Resets the telemetry and the cancellation flag ahead of a scan or rescan.
+   */
+   void PrepareForScan();
+
+   /**
+   * @brief Reports on the progress one last time, now that the scan or rescan has finished.
+   */
+   void FinishScan();
+
+   /**
+   * @returns The telemetry counters of the calling thread.
+   */
+   ScanTelemetry::Counters& GetLocalCounters() noexcept;
+
+   /**
+   * @brief Enumerates a directory, counting the directory, its entries, and what it took to
+   * enumerate them.
+   */
+   void EnumerateAndCount(
+      const std::experimental::filesystem::path& path,
+      const std::function<void(const DirectoryEntry&)>& visitor) noexcept;
+
    /**
    * @brief Helper function to process a single file.
    *
-   * @note This function assumes the path is valid and accessible.
+   * @param[in] entry               The file, as reported by the directory enumeration.
+   * @param[in] node                The Node in Tree to append the file to.
    *
-   * @param[in] path                The location on disk to scan.
-   * @param[in] fileNode            The Node in Tree to append newly discoved files to.
+   * @returns The Node of the file, or nullptr if the file was too small to be added.
    */
-   void ProcessFile(
-      const std::experimental::filesystem::path& path,
+   Tree<FileInfo>::Node* ProcessFile(
+      const DirectoryEntry& entry,
       Tree<FileInfo>::Node& node) noexcept;
 
    /**
-   * @brief Performs a recursive depth-first exploration of the file system.
+   * @brief A directory that is still being scanned, along with the size of everything found in
+   * it so far.
+   *
+   * The directory is only complete once the task that enumerates it, and every task that scans
+   * one of its subdirectories, has finished. Whoever finishes last computes the final size, and
+   * attaches the Node to its parent, unless the directory turned out to be empty, in which case
+   * it never becomes part of the tree at all.
+   */
+   struct PendingDirectory
+   {
+      Tree<FileInfo>::Node& node;
+
+      /**
+      * The Node to attach the directory to once it's complete, or nullptr for the root.
+      */
+      Tree<FileInfo>::Node* parentNode;
+
+      /**
+      * The parent directory, if it's still being scanned as well. Otherwise, the directory was
+      * found by a rescan, which is told about its size instead.
+      */
+      PendingDirectory* parent;
+
+      /**
+      * The depth of the directory, relative to the directory being scanned.
+      */
+      unsigned int depth;
+
+      std::atomic<std::uint32_t> unfinishedTasks{ 1 };
+      std::atomic<std::uintmax_t> size{ 0 };
+   };
+
+   /**
+   * @brief Creates the Node of a directory, without attaching it to the tree just yet, and then
+   * hands it to the scheduler to be scanned in turn.
    *
-   * @param[in] path                The location on disk to scan.
-   * @param[in] fileNode            The Node in Tree to append newly discoved files to.
+   * @param[in] path                The path to the parent directory.
+   * @param[in] entry               The directory, as reported by the directory enumeration.
+   * @param[in] node                The Node in Tree that the directory belongs under.
+   * @param[in] parent              The pending parent directory, if the parent is being scanned
+   *                                from scratch.
+   * @param[in] depth               The depth of the directory itself.
    */
    void ProcessDirectory(
       const std::experimental::filesystem::path& path,
-      Tree<FileInfo>::Node& node) noexcept;
+      const DirectoryEntry& entry,
+      Tree<FileInfo>::Node& node,
+      PendingDirectory* parent,
+      unsigned int depth) noexcept;
 
    /**
-   * @brief Adds directories to thread-pool queue.
+   * @brief Processes all entries of a directory as part of a single task. Only subdirectories
+   * end up as separate, stealable tasks.
    *
-   * @param[in] itr                 Reference to the directory to iterate over.
-   * @param[in] Node                The Node to append the contents of the directory to.
+   * @param[in] path                The directory to iterate over.
+   * @param[in] directory           The directory to append the contents to.
    */
-   void AddDirectoriesToQueue(
-      std::experimental::filesystem::directory_iterator& itr,
+   void ScanDirectory(
+      const std::experimental::filesystem::path& path,
+      PendingDirectory& directory) noexcept;
+
+   /**
+   * @brief Marks one task of the directory as finished. Should that complete the directory, then
+   * its parent is told, which may in turn complete the parent, and so on.
+   */
+   void FinishTask(PendingDirectory* directory) noexcept;
+
+   /**
+   * @brief Matches the entries of a directory up against the existing children of its Node, and
+   * records whatever changed for ApplyRescannedChanges() to act on. Subdirectories that already
+   * existed are rescanned as separate tasks; new ones are scanned from scratch.
+   *
+   * @param[in] path                The directory to rescan.
+   * @param[in] node                The Node that represents the directory.
+   */
+   void RescanDirectory(
+      const std::experimental::filesystem::path& path,
+      Tree<FileInfo>::Node& node) noexcept;
+
+   /**
+   * @brief Hands a subdirectory to the scheduler to be rescanned.
+   */
+   void SpawnRescan(
+      std::experimental::filesystem::path path,
       Tree<FileInfo>::Node& node) noexcept;
 
+   /**
+   * @brief Once all rescanning tasks have finished, propagates all size changes up the tree, and
+   * removes the nodes of entries that have gone.
+   */
+   void ApplyRescannedChanges();
+
+   /**
+   * @brief Everything that the rescanning tasks found to have changed, which can only be applied
+   * to the tree once they've all finished.
+   */
+   struct RescannedChanges
+   {
+      /**
+      * The change in the combined size of the direct children of a directory.
+      */
+      std::vector<std::pair<Tree<FileInfo>::Node*, std::intmax_t>> sizeDeltas;
+
+      /**
+      * Nodes whose entries no longer exist, or have shrunk to nothing.
+      */
+      std::vector<Tree<FileInfo>::Node*> removedNodes;
+
+      std::mutex mutex;
+   };
+
+   RescannedChanges m_changes;
+
+   ChangeDetection m_changeDetection{ ChangeDetection::DIRECTORY_TIMESTAMPS };
+
+   std::shared_ptr<FileNames> m_fileNames{ nullptr };
+
    std::shared_ptr<Tree<FileInfo>> m_fileTree{ nullptr };
+
+   std::unique_ptr<PathIndex> m_pathIndex{ nullptr };
  
    const std::experimental::filesystem::path m_rootPath;
 
-   std::mutex m_mutex;
+   ProgressCallback m_progressCallback{ nullptr };
+   std::chrono::milliseconds m_progressInterval{ 500 };
+
+   std::atomic<bool> m_isScanning{ false };
+   std::atomic<bool> m_isCancellationRequested{ false };
+
+   ScanOptions m_options;
+
+   /**
+   * Becomes ready once the most recent asynchronous scan has finished.
+   */
+   std::shared_future<void> m_asyncScan;
+
+   std::chrono::nanoseconds m_lockWaitTimeAtStart{ 0 };
+
+   std::uint64_t m_changedDirectoryCount{ 0 };
+   std::uint64_t m_removedNodeCount{ 0 };
+
+   /**
+   * One set of counters per scanning thread, plus one for any other thread.
+   */
+   ScanTelemetry m_telemetry;
 
-   boost::asio::thread_pool m_threadPool{ 4 };
+   WorkStealingScheduler m_scheduler;
 };
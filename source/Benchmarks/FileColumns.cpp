@@ -0,0 +1,221 @@
+#include "FileColumns.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+   std::uint64_t SumSizesScalar(
+      const std::uint64_t* sizes,
+      const FileType* types,
+      std::size_t count,
+      FileType type) noexcept
+   {
+      std::uint64_t total{ 0 };
+      for (std::size_t index = 0; index < count; ++index)
+      {
+         total += types[index] == type ? sizes[index] : 0;
+      }
+
+      return total;
+   }
+
+   std::size_t CountScalar(const FileType* types, std::size_t count, FileType type) noexcept
+   {
+      std::size_t total{ 0 };
+      for (std::size_t index = 0; index < count; ++index)
+      {
+         total += types[index] == type ? 1 : 0;
+      }
+
+      return total;
+   }
+
+#if defined(__AVX2__)
+
+   constexpr const char* INSTRUCTION_SET{ "AVX2" };
+
+   /**
+   * The count kernel tallies matches in 8-bit lanes, by subtracting the all-ones masks produced by
+   * the comparisons, and so has to widen the tallies before any lane can overflow.
+   */
+   constexpr std::size_t MAXIMUM_BYTE_TALLY{ 255 };
+
+   std::uint64_t SumSizes(
+      const std::uint64_t* sizes,
+      const FileType* types,
+      std::size_t count,
+      FileType type) noexcept
+   {
+      const auto target = _mm256_set1_epi64x(static_cast<long long>(type));
+
+      // Each iteration widens four types to 64 bits, which turns them into a mask for the four
+      // sizes that line up with them:
+      const auto maskedSizes = [&] (std::size_t index) noexcept
+      {
+         std::int32_t packedTypes;
+         std::memcpy(&packedTypes, types + index, sizeof(packedTypes));
+
+         const auto wideTypes = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packedTypes));
+         const auto sizeLanes =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sizes + index));
+
+         return _mm256_and_si256(sizeLanes, _mm256_cmpeq_epi64(wideTypes, target));
+      };
+
+      // Two accumulators keep consecutive additions from waiting on one another:
+      auto evenTotal = _mm256_setzero_si256();
+      auto oddTotal = _mm256_setzero_si256();
+
+      std::size_t index = 0;
+      for (; index + 8 <= count; index += 8)
+      {
+         evenTotal = _mm256_add_epi64(evenTotal, maskedSizes(index));
+         oddTotal = _mm256_add_epi64(oddTotal, maskedSizes(index + 4));
+      }
+
+      alignas(32) std::uint64_t lanes[4];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(evenTotal, oddTotal));
+
+      return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+         SumSizesScalar(sizes + index, types + index, count - index, type);
+   }
+
+   std::size_t Count(const FileType* types, std::size_t count, FileType type) noexcept
+   {
+      const auto target = _mm256_set1_epi8(static_cast<char>(type));
+
+      std::size_t total{ 0 };
+      std::size_t index = 0;
+
+      while (index + 32 <= count)
+      {
+         const auto blockEnd = index + std::min(MAXIMUM_BYTE_TALLY, (count - index) / 32) * 32;
+
+         auto tallies = _mm256_setzero_si256();
+         for (; index < blockEnd; index += 32)
+         {
+            const auto typeLanes =
+               _mm256_loadu_si256(reinterpret_cast<const __m256i*>(types + index));
+
+            tallies = _mm256_sub_epi8(tallies, _mm256_cmpeq_epi8(typeLanes, target));
+         }
+
+         // Summing the absolute differences from zero adds up each group of eight tallies:
+         alignas(32) std::uint64_t lanes[4];
+         _mm256_store_si256(
+            reinterpret_cast<__m256i*>(lanes), _mm256_sad_epu8(tallies, _mm256_setzero_si256()));
+
+         total += static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+      }
+
+      return total + CountScalar(types + index, count - index, type);
+   }
+
+#else
+
+   constexpr const char* INSTRUCTION_SET{ "Scalar" };
+
+   std::uint64_t SumSizes(
+      const std::uint64_t* sizes,
+      const FileType* types,
+      std::size_t count,
+      FileType type) noexcept
+   {
+      return SumSizesScalar(sizes, types, count, type);
+   }
+
+   std::size_t Count(const FileType* types, std::size_t count, FileType type) noexcept
+   {
+      return CountScalar(types, count, type);
+   }
+
+#endif
+}
+
+FileColumns::FileColumns(const FrozenTree<FileInfo>& tree)
+{
+   const auto nodeCount = tree.Size();
+   const auto* const data = tree.GetDataArray();
+
+   m_sizes.reserve(nodeCount);
+   m_types.reserve(nodeCount);
+   m_extensions.reserve(nodeCount);
+
+   for (std::size_t index = 0; index < nodeCount; ++index)
+   {
+      m_sizes.emplace_back(data[index].size);
+      m_types.emplace_back(data[index].type);
+      m_extensions.emplace_back(data[index].extension);
+   }
+
+   m_subtreeSizes.assign(tree.GetSubtreeSizes(), tree.GetSubtreeSizes() + nodeCount);
+}
+
+std::size_t FileColumns::Size() const noexcept
+{
+   return m_sizes.size();
+}
+
+FileColumns::Range FileColumns::GetAll() const noexcept
+{
+   return { 0, Size() };
+}
+
+FileColumns::Range FileColumns::GetSubtree(std::size_t index) const noexcept
+{
+   assert(index < Size());
+   return { index, index + m_subtreeSizes[index] };
+}
+
+std::uint64_t FileColumns::SumSizes(FileType type, Range range) const noexcept
+{
+   assert(range.first <= range.last && range.last <= Size());
+
+   return ::SumSizes(
+      m_sizes.data() + range.first, m_types.data() + range.first, range.last - range.first, type);
+}
+
+std::size_t FileColumns::Count(FileType type, Range range) const noexcept
+{
+   assert(range.first <= range.last && range.last <= Size());
+
+   return ::Count(m_types.data() + range.first, range.last - range.first, type);
+}
+
+std::vector<FileColumns::ExtensionTotals> FileColumns::TotalByExtension(
+   std::size_t extensionCount,
+   Range range) const
+{
+   assert(range.first <= range.last && range.last <= Size());
+
+   // Scattering into the histogram doesn't vectorize, but it still only streams through the three
+   // columns it needs:
+   std::vector<ExtensionTotals> totals(extensionCount, ExtensionTotals{ 0, 0 });
+
+   for (auto index = range.first; index < range.last; ++index)
+   {
+      if (m_types[index] != FileType::REGULAR)
+      {
+         continue;
+      }
+
+      assert(m_extensions[index] < extensionCount);
+
+      auto& extensionTotals = totals[m_extensions[index]];
+      extensionTotals.fileCount += 1;
+      extensionTotals.byteCount += m_sizes[index];
+   }
+
+   return totals;
+}
+
+const char* FileColumns::GetInstructionSet() noexcept
+{
+   return INSTRUCTION_SET;
+}
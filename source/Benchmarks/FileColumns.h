@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../Tree/Tree.hpp"
+#include "FileInfo.hpp"
+#include "StringPool.h"
+
+/**
+* @brief The File Columns class lays the attributes of a frozen file tree out as columns: one
+* contiguous array per attribute, each in the pre-order of the FrozenTree it was built from.
+*
+* Summing up file sizes by walking the nodes of a tree means loading a whole FileInfo, and often a
+* whole cache line, per node, only to look at a byte or two of it. With the attributes stored as
+* columns, a query only streams through the columns it actually needs, and does so sequentially,
+* which lets the kernels below process several nodes per instruction, and keeps them bound by
+* memory bandwidth rather than by latency.
+*
+* Since the nodes are stored in pre-order, the subtree of any node occupies a contiguous range of
+* indices, which is how queries are restricted to a subtree. See GetSubtree(...).
+*
+* The kernels use AVX2 when the compiler targets it, and fall back on plain loops otherwise. AVX2
+* has to be enabled explicitly, such as through `/arch:AVX2` or `-mavx2`.
+*/
+class FileColumns
+{
+public:
+
+   /**
+   * @brief A half-open range of pre-order indices.
+   */
+   struct Range
+   {
+      std::size_t first;
+      std::size_t last;
+   };
+
+   /**
+   * @brief The number of regular files with a given extension, and their combined size.
+   */
+   struct ExtensionTotals
+   {
+      std::uint64_t fileCount;
+      std::uint64_t byteCount;
+   };
+
+   /**
+   * @param[in] tree                The tree to copy the attributes of.
+   */
+   explicit FileColumns(const FrozenTree<FileInfo>& tree);
+
+   /**
+   * @returns The number of nodes.
+   */
+   std::size_t Size() const noexcept;
+
+   /**
+   * @returns The range that spans every node.
+   */
+   Range GetAll() const noexcept;
+
+   /**
+   * @returns The range that spans the node at the specified pre-order index, and every node
+   * beneath it.
+   */
+   Range GetSubtree(std::size_t index) const noexcept;
+
+   /**
+   * @returns The combined size of every node of the specified type within the range.
+   */
+   std::uint64_t SumSizes(FileType type, Range range) const noexcept;
+
+   /**
+   * @returns The number of nodes of the specified type within the range.
+   */
+   std::size_t Count(FileType type, Range range) const noexcept;
+
+   /**
+   * @returns The number of regular files within the range, and their combined size, for each
+   * extension, indexed by InternTable::Id.
+   *
+   * @param[in] extensionCount      The number of distinct extensions, as reported by
+   *                                InternTable::GetSize().
+   * @param[in] range               The nodes to take into account.
+   */
+   std::vector<ExtensionTotals> TotalByExtension(std::size_t extensionCount, Range range) const;
+
+   /**
+   * @returns The name of the instruction set that the kernels were compiled for.
+   */
+   static const char* GetInstructionSet() noexcept;
+
+private:
+
+   std::vector<std::uint64_t> m_sizes;
+   std::vector<FileType> m_types;
+   std::vector<InternTable::Id> m_extensions;
+
+   std::vector<FrozenTree<FileInfo>::IndexType> m_subtreeSizes;
+};
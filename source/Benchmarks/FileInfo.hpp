@@ -3,11 +3,13 @@
 #include <cstdint>
 #include <string>
 
+#include "StringPool.h"
+
 /**
 * @brief The FILE_TYPE enum represents the three basic file types: non-directory files,
 * directories, and symbolic links (which includes junctions).
 */
-enum class FileType
+enum class FileType : std::uint8_t
 {
    REGULAR,
    DIRECTORY,
@@ -16,13 +18,60 @@ enum class FileType
 
 /**
 * @brief The FileInfo struct
+*
+* In order to keep the nodes of a tree with millions of files small, the FileInfo doesn't own any
+* strings. Instead, the name lives in a StringPool, and the extension is interned in an
+* InternTable, both of which are shared by all FileInfo records in the same tree. See FileNames.
 */
 struct FileInfo
 {
-   std::wstring name;
-   std::wstring extension;
-
    std::uintmax_t size;
 
+   StringPool::Reference name;
+   InternTable::Id extension;
+
    FileType type;
+
+   /**
+   * The last time that an entry was added to, removed from, or renamed within the directory, as
+   * reported by GetLastWriteTime(...). This is zero for regular files, and for directories whose
+   * time is unknown.
+   */
+   std::int64_t lastWriteTime;
+};
+
+/**
+* @brief The FileNames struct holds the strings that the FileInfo records of a tree refer to.
+*/
+struct FileNames
+{
+   /**
+   * @returns The name of the file, without its extension.
+   */
+   NativeStringView GetName(const FileInfo& file) const noexcept
+   {
+      return names.Get(file.name);
+   }
+
+   /**
+   * @returns The extension of the file, including the leading dot, if it has one.
+   */
+   NativeStringView GetExtension(const FileInfo& file) const
+   {
+      return extensions.Get(file.extension);
+   }
+
+   /**
+   * @returns The name of the file, including its extension.
+   */
+   std::basic_string<NativeChar> GetFullName(const FileInfo& file) const
+   {
+      std::basic_string<NativeChar> fullName{ GetName(file) };
+      fullName.append(GetExtension(file));
+
+      return fullName;
+   }
+
+   StringPool names;
+   InternTable extensions;
 };
@@ -0,0 +1,240 @@
+#include "PathIndex.h"
+
+#include <algorithm>
+#include <cassert>
+
+constexpr std::size_t PathIndex::SHARD_COUNT;
+constexpr std::size_t PathIndex::INITIAL_SHARD_CAPACITY;
+
+namespace
+{
+   constexpr std::uint64_t FNV_OFFSET_BASIS{ 14695981039346656037ull };
+   constexpr std::uint64_t FNV_PRIME{ 1099511628211ull };
+
+   /**
+   * @brief Continues a 64-bit FNV-1a hash over the specified characters, such that hashing the
+   * stem and then the extension gives the same result as hashing the full name in one go.
+   */
+   std::uint64_t HashCharacters(std::uint64_t hash, NativeStringView characters) noexcept
+   {
+      for (const auto character : characters)
+      {
+         hash ^= static_cast<std::uint64_t>(character);
+         hash *= FNV_PRIME;
+      }
+
+      return hash;
+   }
+
+   /**
+   * @brief Having to grow beyond this fraction of occupied slots keeps the probe sequences short.
+   */
+   bool IsTooFull(std::size_t size, std::size_t capacity) noexcept
+   {
+      return (size + 1) * 4 > capacity * 3;
+   }
+}
+
+PathIndex::PathIndex(const FileNames& fileNames) :
+   m_shards{ new Shard[SHARD_COUNT] },
+   m_fileNames{ fileNames }
+{
+}
+
+std::uint64_t PathIndex::Hash(
+   const Node* parent,
+   NativeStringView stem,
+   NativeStringView extension) noexcept
+{
+   auto hash = HashCharacters(HashCharacters(FNV_OFFSET_BASIS, stem), extension);
+
+   // Mixing in the parent separates equally named entries of different directories:
+   hash ^= reinterpret_cast<std::uintptr_t>(parent) * 0x9E3779B97F4A7C15ull;
+   hash ^= hash >> 29;
+
+   return hash;
+}
+
+bool PathIndex::HasName(const Node& node, NativeStringView name) const
+{
+   const auto stem = m_fileNames.GetName(node.GetData());
+   const auto extension = m_fileNames.GetExtension(node.GetData());
+
+   return name.size() == stem.size() + extension.size()
+      && name.compare(0, stem.size(), stem) == 0
+      && name.compare(stem.size(), extension.size(), extension) == 0;
+}
+
+PathIndex::Shard& PathIndex::GetShard(std::uint64_t hash) const noexcept
+{
+   // The low bits pick the slot within the shard, so the shard is picked by the high bits:
+   return m_shards[(hash >> 58) % SHARD_COUNT];
+}
+
+void PathIndex::InsertIntoShard(Shard& shard, const Entry& entry)
+{
+   if (IsTooFull(shard.size, shard.slots.size()))
+   {
+      std::vector<Entry> slots(std::max(shard.slots.size() * 2, INITIAL_SHARD_CAPACITY));
+      std::swap(slots, shard.slots);
+
+      shard.size = 0;
+
+      for (const auto& existing : slots)
+      {
+         if (existing.node)
+         {
+            InsertIntoShard(shard, existing);
+         }
+      }
+   }
+
+   const auto mask = shard.slots.size() - 1;
+
+   auto index = static_cast<std::size_t>(entry.hash) & mask;
+   while (shard.slots[index].node)
+   {
+      index = (index + 1) & mask;
+   }
+
+   shard.slots[index] = entry;
+   ++shard.size;
+}
+
+void PathIndex::Insert(const Node& node)
+{
+   assert(node.GetParent());
+
+   const auto stem = m_fileNames.GetName(node.GetData());
+   const auto extension = m_fileNames.GetExtension(node.GetData());
+
+   const Entry entry{ node.GetParent(), &node, Hash(node.GetParent(), stem, extension) };
+
+   auto& shard = GetShard(entry.hash);
+
+   const std::lock_guard<decltype(shard.mutex)> lock{ shard.mutex };
+   InsertIntoShard(shard, entry);
+}
+
+void PathIndex::Erase(const Node& node)
+{
+   const auto stem = m_fileNames.GetName(node.GetData());
+   const auto extension = m_fileNames.GetExtension(node.GetData());
+
+   const auto hash = Hash(node.GetParent(), stem, extension);
+   auto& shard = GetShard(hash);
+
+   const std::lock_guard<decltype(shard.mutex)> lock{ shard.mutex };
+
+   if (shard.slots.empty())
+   {
+      return;
+   }
+
+   const auto mask = shard.slots.size() - 1;
+
+   // Entries are matched by Node, rather than by name, since a rescan may briefly index a new
+   // entry under the same name as the one it replaces:
+   auto index = static_cast<std::size_t>(hash) & mask;
+   while (shard.slots[index].node != &node)
+   {
+      if (!shard.slots[index].node)
+      {
+         return;
+      }
+
+      index = (index + 1) & mask;
+   }
+
+   shard.slots[index] = Entry{};
+   --shard.size;
+
+   for (auto next = (index + 1) & mask; shard.slots[next].node; next = (next + 1) & mask)
+   {
+      const auto preferred = static_cast<std::size_t>(shard.slots[next].hash) & mask;
+
+      // An entry may only move back into the gap if that doesn't place it before its preferred
+      // slot, taking into account that the probe sequence may have wrapped around:
+      const auto distanceToGap = (index - preferred) & mask;
+      const auto distanceToEntry = (next - preferred) & mask;
+
+      if (distanceToGap < distanceToEntry)
+      {
+         shard.slots[index] = shard.slots[next];
+         shard.slots[next] = Entry{};
+         index = next;
+      }
+   }
+}
+
+void PathIndex::EraseSubtree(const Node& node)
+{
+   std::for_each(
+      Tree<FileInfo>::PreOrderIterator{ &node },
+      Tree<FileInfo>::PreOrderIterator{ },
+      [&] (const Node& descendant) { Erase(descendant); });
+}
+
+const PathIndex::Node* PathIndex::Find(const Node& parent, NativeStringView name) const
+{
+   // Hashing the whole name as the stem gives the same hash as hashing the stem and the extension
+   // separately:
+   const auto hash = Hash(&parent, name, {});
+   const auto& shard = GetShard(hash);
+
+   const std::lock_guard<decltype(shard.mutex)> lock{ shard.mutex };
+
+   if (shard.slots.empty())
+   {
+      return nullptr;
+   }
+
+   const auto mask = shard.slots.size() - 1;
+
+   for (auto index = static_cast<std::size_t>(hash) & mask; shard.slots[index].node;
+      index = (index + 1) & mask)
+   {
+      const auto& entry = shard.slots[index];
+      if (entry.hash == hash && entry.parent == &parent && HasName(*entry.node, name))
+      {
+         return entry.node;
+      }
+   }
+
+   return nullptr;
+}
+
+void PathIndex::Rebuild(const Tree<FileInfo>& tree)
+{
+   for (std::size_t index = 0; index < SHARD_COUNT; ++index)
+   {
+      auto& shard = m_shards[index];
+
+      const std::lock_guard<decltype(shard.mutex)> lock{ shard.mutex };
+      shard.slots.clear();
+      shard.size = 0;
+   }
+
+   std::for_each(tree.beginPreOrder(), tree.endPreOrder(), [&] (const Node& node)
+   {
+      if (node.GetParent())
+      {
+         Insert(node);
+      }
+   });
+}
+
+std::size_t PathIndex::GetSize() const
+{
+   std::size_t size{ 0 };
+
+   for (std::size_t index = 0; index < SHARD_COUNT; ++index)
+   {
+      const auto& shard = m_shards[index];
+
+      const std::lock_guard<decltype(shard.mutex)> lock{ shard.mutex };
+      size += shard.size;
+   }
+
+   return size;
+}
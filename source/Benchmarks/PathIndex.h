@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../Tree/Tree.hpp"
+#include "FileInfo.hpp"
+#include "StringPool.h"
+
+/**
+* @brief The Path Index class maps a directory and the name of one of its entries straight onto
+* the Node of that entry.
+*
+* Finding a Node by its path would otherwise mean searching through the children of every
+* directory along the way, one sibling at a time. With the index, each component of the path
+* takes a single hash lookup instead, regardless of how many entries the directory holds.
+*
+* The entries are kept in flat, open-addressing hash tables, split up into shards that each have a
+* lock of their own, so that the scanner's threads can insert entries concurrently. No strings are
+* stored: each entry only refers to the Node, whose name is compared against the one that's being
+* looked up.
+*
+* @note The index refers to nodes by their address, and so has to be rebuilt whenever the nodes of
+* the tree are moved, such as by Tree::OptimizeMemoryLayoutFor(...).
+*/
+class PathIndex
+{
+public:
+
+   using Node = Tree<FileInfo>::Node;
+
+   /**
+   * @param[in] fileNames           The strings that the nodes of the tree refer to.
+   */
+   explicit PathIndex(const FileNames& fileNames);
+
+   PathIndex(const PathIndex&) = delete;
+   PathIndex& operator=(const PathIndex&) = delete;
+
+   /**
+   * @brief Adds a Node that has just been attached to its parent. Safe to call from multiple
+   * threads at once.
+   */
+   void Insert(const Node& node);
+
+   /**
+   * @brief Removes a Node, along with all of its descendants, from the index. This should be
+   * called before the Node is removed from the tree.
+   */
+   void EraseSubtree(const Node& node);
+
+   /**
+   * @brief Looks up one of the direct children of a Node by its name, including the extension.
+   *
+   * @returns The child, or nullptr if there's no such child.
+   */
+   const Node* Find(const Node& parent, NativeStringView name) const;
+
+   /**
+   * @brief Removes all entries, and then adds every Node in the tree, save for the root.
+   */
+   void Rebuild(const Tree<FileInfo>& tree);
+
+   /**
+   * @returns The number of nodes in the index.
+   */
+   std::size_t GetSize() const;
+
+private:
+
+   struct Entry
+   {
+      const Node* parent;
+      const Node* node;
+      std::uint64_t hash;
+   };
+
+   /**
+   * @brief A hash table that uses linear probing, and whose capacity is always a power of two.
+   * Empty slots are those without a Node.
+   */
+   struct Shard
+   {
+      std::vector<Entry> slots;
+      std::size_t size{ 0 };
+
+      mutable std::mutex mutex;
+   };
+
+   static constexpr std::size_t SHARD_COUNT{ 64 };
+   static constexpr std::size_t INITIAL_SHARD_CAPACITY{ 1024 };
+
+   /**
+   * @returns The hash of the specified name within the specified directory.
+   */
+   static std::uint64_t Hash(const Node* parent, NativeStringView stem, NativeStringView extension)
+      noexcept;
+
+   /**
+   * @returns True if the name of the Node, including its extension, equals the specified name.
+   */
+   bool HasName(const Node& node, NativeStringView name) const;
+
+   Shard& GetShard(std::uint64_t hash) const noexcept;
+
+   /**
+   * @brief Adds the entry to the shard, whose lock must be held, growing the shard if necessary.
+   */
+   static void InsertIntoShard(Shard& shard, const Entry& entry);
+
+   /**
+   * @brief Removes the entry of the specified Node, if present. Any entries that were pushed past
+   * their preferred slot by the removed entry are shifted back, which keeps the probe sequences
+   * intact without the need for tombstones.
+   */
+   void Erase(const Node& node);
+
+   std::unique_ptr<Shard[]> m_shards;
+
+   const FileNames& m_fileNames;
+};
@@ -0,0 +1,289 @@
+#ifndef _WIN32
+
+#include "DirectoryEnumerator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+   /**
+   * @brief Closes a file descriptor when it goes out of scope.
+   */
+   class ScopedDescriptor
+   {
+   public:
+
+      explicit ScopedDescriptor(int descriptor) noexcept :
+         m_descriptor{ descriptor }
+      {
+      }
+
+      ~ScopedDescriptor()
+      {
+         if (m_descriptor >= 0)
+         {
+            close(m_descriptor);
+         }
+      }
+
+      ScopedDescriptor(const ScopedDescriptor&) = delete;
+      ScopedDescriptor& operator=(const ScopedDescriptor&) = delete;
+
+      int Release() noexcept
+      {
+         const auto descriptor = m_descriptor;
+         m_descriptor = -1;
+
+         return descriptor;
+      }
+
+      operator int() const noexcept
+      {
+         return m_descriptor;
+      }
+
+   private:
+
+      int m_descriptor;
+   };
+
+   /**
+   * @returns True if the given name refers to either the directory itself, or to its parent.
+   */
+   bool IsDotOrDotDot(const char* name) noexcept
+   {
+      return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+   }
+
+   /**
+   * @brief Maps the file type reported by the directory listing onto a FileType, and looks up
+   * the size of regular files.
+   *
+   * Most file systems report the type of each entry as part of the listing, in which case only
+   * regular files need to be looked at individually. The lookup is made relative to the already
+   * open directory, which spares the kernel from having to resolve the full path for every file,
+   * and never follows symbolic links.
+   *
+   * @returns True if the entry could be classified, and false otherwise.
+   */
+   bool ClassifyEntry(
+      int directoryDescriptor,
+      const char* name,
+      unsigned char listedType,
+      DirectoryEntry& entry) noexcept
+   {
+      entry.size = 0;
+
+      switch (listedType)
+      {
+         case DT_DIR:
+            entry.type = FileType::DIRECTORY;
+            return true;
+         case DT_LNK:
+            entry.type = FileType::SYMLINK;
+            return true;
+         case DT_REG:
+         case DT_UNKNOWN:
+            break;
+         default:
+            // Devices, pipes, and sockets don't take up any space worth reporting:
+            return false;
+      }
+
+      struct stat status;
+      if (fstatat(directoryDescriptor, name, &status, AT_SYMLINK_NOFOLLOW) != 0)
+      {
+         return false;
+      }
+
+      if (S_ISDIR(status.st_mode))
+      {
+         entry.type = FileType::DIRECTORY;
+      }
+      else if (S_ISLNK(status.st_mode))
+      {
+         entry.type = FileType::SYMLINK;
+      }
+      else if (S_ISREG(status.st_mode))
+      {
+         entry.type = FileType::REGULAR;
+         entry.size = static_cast<std::uintmax_t>(status.st_size);
+      }
+      else
+      {
+         return false;
+      }
+
+      return true;
+   }
+
+#ifdef __linux__
+   /**
+   * @brief The layout of the records returned by the `getdents64` system call.
+   */
+   struct LinuxDirectoryRecord
+   {
+      std::uint64_t inode;
+      std::int64_t offset;
+      unsigned short length;
+      unsigned char type;
+      char name[1];
+   };
+
+   /**
+   * @brief Reads the directory listing in large batches, straight from the kernel.
+   */
+   template<typename VisitorType>
+   bool ListEntries(
+      ScopedDescriptor& directory,
+      const VisitorType& visitor,
+      EnumerationStatistics& statistics)
+   {
+      constexpr std::size_t BUFFER_SIZE{ 64 * 1024 };
+      alignas(LinuxDirectoryRecord) char buffer[BUFFER_SIZE];
+
+      while (true)
+      {
+         ++statistics.systemCalls;
+
+         const auto bytesRead =
+            syscall(SYS_getdents64, static_cast<int>(directory), buffer, BUFFER_SIZE);
+         if (bytesRead < 0)
+         {
+            return false;
+         }
+
+         if (bytesRead == 0)
+         {
+            return true;
+         }
+
+         for (long offset = 0; offset < bytesRead;)
+         {
+            const auto* const record =
+               reinterpret_cast<const LinuxDirectoryRecord*>(buffer + offset);
+            offset += record->length;
+
+            visitor(record->name, record->type);
+         }
+      }
+   }
+#else
+   /**
+   * @brief Reads the directory listing through the portable `readdir(...)` interface.
+   */
+   template<typename VisitorType>
+   bool ListEntries(
+      ScopedDescriptor& directory,
+      const VisitorType& visitor,
+      EnumerationStatistics& statistics)
+   {
+      DIR* const stream = fdopendir(directory);
+      if (!stream)
+      {
+         return false;
+      }
+
+      // From here on out, the stream owns the descriptor:
+      directory.Release();
+
+      // Since readdir(...) reads ahead in batches, the number of calls it makes into the kernel
+      // isn't known; each call to it is counted instead, as an upper bound:
+      while (true)
+      {
+         ++statistics.systemCalls;
+
+         const dirent* const record = readdir(stream);
+         if (!record)
+         {
+            break;
+         }
+
+         visitor(record->d_name, record->d_type);
+      }
+
+      closedir(stream);
+      return true;
+   }
+#endif
+}
+
+bool EnumerateDirectory(
+   const std::experimental::filesystem::path& directory,
+   const std::function<void(const DirectoryEntry&)>& visitor,
+   EnumerationStatistics* statistics)
+{
+   EnumerationStatistics localStatistics;
+   auto& counts = statistics ? *statistics : localStatistics;
+
+   ScopedDescriptor descriptor{
+      open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC) };
+
+   ++counts.systemCalls;
+
+   if (descriptor < 0)
+   {
+      return false;
+   }
+
+   // One more call to close the directory once it has been listed:
+   ++counts.systemCalls;
+
+   const int directoryDescriptor = descriptor;
+
+   DirectoryEntry entry;
+
+   return ListEntries(descriptor, [&] (const char* name, unsigned char type)
+   {
+      if (IsDotOrDotDot(name))
+      {
+         return;
+      }
+
+      if (type == DT_REG || type == DT_UNKNOWN)
+      {
+         ++counts.systemCalls;
+         ++counts.individualLookups;
+      }
+
+      if (!ClassifyEntry(directoryDescriptor, name, type, entry))
+      {
+         return;
+      }
+
+      entry.name.assign(name, std::strlen(name));
+      visitor(entry);
+   }, counts);
+}
+
+std::int64_t GetLastWriteTime(const std::experimental::filesystem::path& directory)
+{
+   struct stat status;
+   if (stat(directory.c_str(), &status) != 0)
+   {
+      return 0;
+   }
+
+   constexpr std::int64_t NANOSECONDS_PER_SECOND{ 1'000'000'000 };
+
+#ifdef __APPLE__
+   const auto& time = status.st_mtimespec;
+#else
+   const auto& time = status.st_mtim;
+#endif
+
+   return static_cast<std::int64_t>(time.tv_sec) * NANOSECONDS_PER_SECOND + time.tv_nsec;
+}
+
+#endif
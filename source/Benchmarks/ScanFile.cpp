@@ -0,0 +1,140 @@
+#include "ScanFile.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "../Tree/TreeSerialization.hpp"
+
+namespace
+{
+   constexpr char MAGIC[8] = { 'N', 'A', 'R', 'Y', 'N', 'A', 'M', 'E' };
+
+   constexpr std::uint32_t FORMAT_VERSION{ 1 };
+   constexpr std::uint32_t BYTE_ORDER_MARK{ 0x01020304 };
+
+   /**
+   * @brief The header at the start of every names file, followed by the name pool and then the
+   * extension table, as written by their respective WriteTo(...) functions.
+   */
+   struct NamesHeader
+   {
+      char magic[8];
+
+      std::uint32_t version;
+      std::uint32_t byteOrderMark;
+
+      std::uint32_t characterSize;
+      std::uint32_t reserved;
+   };
+
+   /**
+   * @returns Whether every name and extension that the tree refers to is present, and every name
+   * lies within a single chunk of the pool, as StringPool::Get(...) expects.
+   */
+   bool AreNamesComplete(const FrozenTree<FileInfo>& tree, const FileNames& fileNames)
+   {
+      constexpr auto chunkSize = StringPool::CHARACTERS_PER_CHUNK;
+
+      const auto* const data = tree.GetDataArray();
+
+      const auto poolSize = fileNames.names.GetSize();
+      const auto extensionCount = fileNames.extensions.GetSize();
+
+      for (std::size_t index = 0; index < tree.Size(); ++index)
+      {
+         const auto& name = data[index].name;
+
+         if (std::size_t{ name.offset } + name.length > poolSize ||
+            name.offset % chunkSize + name.length > chunkSize ||
+            data[index].extension >= extensionCount)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+}
+
+std::string GetNamesFileName(const std::string& treeFileName)
+{
+   return treeFileName + ".names";
+}
+
+void SaveScan(const Tree<FileInfo>& tree, const FileNames& fileNames, const std::string& fileName)
+{
+   TreeSerialization::WriteToFile(tree, fileName);
+
+   const auto namesFileName = GetNamesFileName(fileName);
+   std::ofstream stream{ namesFileName, std::ios::binary | std::ios::trunc };
+
+   NamesHeader header{};
+   std::memcpy(header.magic, MAGIC, sizeof MAGIC);
+
+   header.version = FORMAT_VERSION;
+   header.byteOrderMark = BYTE_ORDER_MARK;
+   header.characterSize = sizeof(NativeChar);
+
+   stream.write(reinterpret_cast<const char*>(&header), sizeof header);
+
+   fileNames.names.WriteTo(stream);
+   fileNames.extensions.WriteTo(stream);
+
+   stream.flush();
+
+   if (!stream)
+   {
+      throw std::runtime_error{ "Could not write: " + namesFileName };
+   }
+}
+
+LoadedScan LoadScan(const std::string& fileName)
+{
+   auto tree = TreeSerialization::MapFromFile<FileInfo>(fileName);
+
+   const auto namesFileName = GetNamesFileName(fileName);
+   std::ifstream stream{ namesFileName, std::ios::binary };
+
+   if (!stream)
+   {
+      throw std::runtime_error{ "Could not open: " + namesFileName };
+   }
+
+   NamesHeader header;
+   if (!stream.read(reinterpret_cast<char*>(&header), sizeof header) ||
+      std::memcmp(header.magic, MAGIC, sizeof MAGIC) != 0)
+   {
+      throw std::runtime_error{ "Not a names file: " + namesFileName };
+   }
+
+   if (header.version != FORMAT_VERSION ||
+      header.byteOrderMark != BYTE_ORDER_MARK ||
+      header.characterSize != sizeof(NativeChar))
+   {
+      throw std::runtime_error{ "Incompatible names file: " + namesFileName };
+   }
+
+   auto fileNames = std::make_shared<FileNames>();
+
+   try
+   {
+      fileNames->names.ReadFrom(stream);
+      fileNames->extensions.ReadFrom(stream);
+   }
+   catch (const std::exception& error)
+   {
+      // Besides running out of data, a corrupt length can also fail the allocation it asks for:
+      throw std::runtime_error{ "Corrupt names file: " + namesFileName + " (" + error.what() + ")" };
+   }
+
+   // A names file that belongs to another tree would otherwise hand out views past the end of
+   // the pool:
+   if (!AreNamesComplete(tree, *fileNames))
+   {
+      throw std::runtime_error{ "The names file doesn't match the tree: " + namesFileName };
+   }
+
+   return LoadedScan{ std::move(tree), std::move(fileNames) };
+}
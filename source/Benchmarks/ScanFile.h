@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "../Tree/Tree.hpp"
+#include "FileInfo.hpp"
+
+/**
+* @brief A scanned tree that was loaded from disk, along with the names that its FileInfo records
+* refer to.
+*/
+struct LoadedScan
+{
+   FrozenTree<FileInfo> tree;
+   std::shared_ptr<FileNames> fileNames;
+};
+
+/**
+* @returns The name of the file that holds the names of the tree stored in the specified file.
+*/
+std::string GetNamesFileName(const std::string& treeFileName);
+
+/**
+* @brief Writes a scanned tree to disk, such that it can be loaded again without rescanning.
+*
+* Since a FileInfo only refers to its name and extension, the tree itself is written by
+* TreeSerialization::WriteToFile(...), while the name pool and the extension table are written
+* to a companion file, named by GetNamesFileName(...).
+*
+* @throws std::runtime_error if either file can't be written.
+*/
+void SaveScan(const Tree<FileInfo>& tree, const FileNames& fileNames, const std::string& fileName);
+
+/**
+* @brief Loads a scan written by SaveScan(...). The tree is mapped straight from its file, while
+* the names are read into memory.
+*
+* @throws std::runtime_error if either file can't be read, is corrupt, or if the names don't
+* cover every FileInfo in the tree.
+*/
+LoadedScan LoadScan(const std::string& fileName);
@@ -0,0 +1,96 @@
+#include "ScanTelemetry.h"
+
+namespace
+{
+   /**
+   * @returns The number of items per second, or zero if no time has passed yet.
+   */
+   double GetRate(std::uint64_t count, std::chrono::nanoseconds elapsedTime) noexcept
+   {
+      const auto seconds = std::chrono::duration<double>{ elapsedTime }.count();
+      return seconds > 0 ? count / seconds : 0;
+   }
+}
+
+double ScanProgress::GetDirectoriesPerSecond() const noexcept
+{
+   return GetRate(directoryCount, elapsedTime);
+}
+
+double ScanProgress::GetFilesPerSecond() const noexcept
+{
+   return GetRate(fileCount, elapsedTime);
+}
+
+std::ostream& operator<<(std::ostream& stream, const ScanProgress& progress)
+{
+   using Milliseconds = std::chrono::milliseconds;
+
+   return stream
+      << progress.directoryCount << " directories ("
+      << static_cast<std::uint64_t>(progress.GetDirectoriesPerSecond()) << "/s), "
+      << progress.fileCount << " files ("
+      << static_cast<std::uint64_t>(progress.GetFilesPerSecond()) << "/s), "
+      << progress.byteCount << " bytes, "
+      << progress.skippedLinkCount << " links skipped, "
+      << progress.failedDirectoryCount << " failures, "
+      << progress.systemCallCount << " system calls ("
+      << progress.individualLookupCount << " lookups), "
+      << progress.queuedTaskCount << " queued, "
+      << std::chrono::duration_cast<Milliseconds>(progress.lockWaitTime).count()
+      << " ms waiting on locks, "
+      << std::chrono::duration_cast<Milliseconds>(progress.elapsedTime).count() << " ms elapsed";
+}
+
+ScanTelemetry::ScanTelemetry(std::size_t threadCount) :
+   m_threadCount{ threadCount },
+   m_counters{ std::make_unique<Counters[]>(threadCount) },
+   m_startTime{ std::chrono::steady_clock::now() }
+{
+}
+
+ScanTelemetry::Counters& ScanTelemetry::GetCounters(std::size_t threadIndex) noexcept
+{
+   return m_counters[threadIndex];
+}
+
+void ScanTelemetry::Reset() noexcept
+{
+   for (std::size_t index = 0; index < m_threadCount; ++index)
+   {
+      auto& counters = m_counters[index];
+
+      counters.directories.store(0, std::memory_order_relaxed);
+      counters.files.store(0, std::memory_order_relaxed);
+      counters.bytes.store(0, std::memory_order_relaxed);
+      counters.skippedLinks.store(0, std::memory_order_relaxed);
+      counters.failedDirectories.store(0, std::memory_order_relaxed);
+      counters.systemCalls.store(0, std::memory_order_relaxed);
+      counters.individualLookups.store(0, std::memory_order_relaxed);
+   }
+
+   m_startTime = std::chrono::steady_clock::now();
+}
+
+ScanProgress ScanTelemetry::TakeSnapshot() const noexcept
+{
+   ScanProgress progress;
+
+   for (std::size_t index = 0; index < m_threadCount; ++index)
+   {
+      const auto& counters = m_counters[index];
+
+      progress.directoryCount += counters.directories.load(std::memory_order_relaxed);
+      progress.fileCount += counters.files.load(std::memory_order_relaxed);
+      progress.byteCount += counters.bytes.load(std::memory_order_relaxed);
+      progress.skippedLinkCount += counters.skippedLinks.load(std::memory_order_relaxed);
+      progress.failedDirectoryCount += counters.failedDirectories.load(std::memory_order_relaxed);
+      progress.systemCallCount += counters.systemCalls.load(std::memory_order_relaxed);
+      progress.individualLookupCount += counters.individualLookups.load(std::memory_order_relaxed);
+   }
+
+   progress.elapsedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - m_startTime);
+
+   return progress;
+}
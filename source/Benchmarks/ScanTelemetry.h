@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+/**
+* @brief A snapshot of how far a scan has come, and of what it took to get there.
+*/
+struct ScanProgress
+{
+   std::uint64_t directoryCount{ 0 };
+   std::uint64_t fileCount{ 0 };
+   std::uint64_t byteCount{ 0 };
+
+   /**
+   * Symbolic links, junctions, and mount points, none of which are followed.
+   */
+   std::uint64_t skippedLinkCount{ 0 };
+
+   /**
+   * Directories that could not be enumerated, such as for lack of permissions.
+   */
+   std::uint64_t failedDirectoryCount{ 0 };
+
+   std::uint64_t systemCallCount{ 0 };
+
+   /**
+   * Entries that had to be looked up individually, because the directory listing itself didn't
+   * say enough about them. See EnumerationStatistics.
+   */
+   std::uint64_t individualLookupCount{ 0 };
+
+   /**
+   * The number of directories waiting to be picked up by a scanning thread.
+   */
+   std::size_t queuedTaskCount{ 0 };
+
+   /**
+   * The time spent by scanning threads waiting on locks that other threads were holding.
+   */
+   std::chrono::nanoseconds lockWaitTime{ 0 };
+
+   std::chrono::nanoseconds elapsedTime{ 0 };
+
+   /**
+   * Only set on the last snapshot of a rescan.
+   */
+   std::uint64_t changedDirectoryCount{ 0 };
+   std::uint64_t removedNodeCount{ 0 };
+
+   bool isComplete{ false };
+
+   double GetDirectoriesPerSecond() const noexcept;
+
+   double GetFilesPerSecond() const noexcept;
+};
+
+/**
+* @brief Writes the progress out in a single line, for the console.
+*/
+std::ostream& operator<<(std::ostream& stream, const ScanProgress& progress);
+
+/**
+* @brief The Scan Telemetry class keeps count of what the scanning threads are doing.
+*
+* Every thread counts into a set of counters of its own, on a cache line of its own, so that
+* counting never contends with any other thread. Since each counter only ever has the one writer,
+* counting doesn't even take an atomic read-modify-write, only a relaxed load and store. A snapshot
+* sums up the counters of all threads, and may be taken from any thread at any time.
+*/
+class ScanTelemetry
+{
+public:
+
+   /**
+   * @brief The counters of a single thread.
+   */
+   struct alignas(64) Counters
+   {
+      std::atomic<std::uint64_t> directories{ 0 };
+      std::atomic<std::uint64_t> files{ 0 };
+      std::atomic<std::uint64_t> bytes{ 0 };
+      std::atomic<std::uint64_t> skippedLinks{ 0 };
+      std::atomic<std::uint64_t> failedDirectories{ 0 };
+      std::atomic<std::uint64_t> systemCalls{ 0 };
+      std::atomic<std::uint64_t> individualLookups{ 0 };
+   };
+
+   /**
+   * @param[in] threadCount         The number of threads that will be counting.
+   */
+   explicit ScanTelemetry(std::size_t threadCount);
+
+   ScanTelemetry(const ScanTelemetry&) = delete;
+   ScanTelemetry& operator=(const ScanTelemetry&) = delete;
+
+   /**
+   * @returns The counters of the thread with the specified index. These must only ever be counted
+   * into by that one thread.
+   */
+   Counters& GetCounters(std::size_t threadIndex) noexcept;
+
+   /**
+   * @brief Adds to a counter that has no other writer than the calling thread.
+   */
+   static void Add(std::atomic<std::uint64_t>& counter, std::uint64_t amount) noexcept
+   {
+      counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+   }
+
+   /**
+   * @brief Sets all counters back to zero, and restarts the clock. Must not be called while any
+   * thread is counting.
+   */
+   void Reset() noexcept;
+
+   /**
+   * @returns The sum of the counters of all threads, along with the time since the last reset.
+   * The remaining fields are left for the caller to fill in.
+   */
+   ScanProgress TakeSnapshot() const noexcept;
+
+private:
+
+   std::size_t m_threadCount;
+   std::unique_ptr<Counters[]> m_counters;
+
+   std::chrono::steady_clock::time_point m_startTime;
+};
@@ -0,0 +1,244 @@
+#include "StringPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+   template<typename ValueType>
+   void Write(std::ostream& stream, const ValueType& value)
+   {
+      stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+   }
+
+   void Write(std::ostream& stream, const NativeChar* characters, std::size_t count)
+   {
+      stream.write(
+         reinterpret_cast<const char*>(characters),
+         static_cast<std::streamsize>(count * sizeof(NativeChar)));
+   }
+
+   template<typename ValueType>
+   ValueType Read(std::istream& stream)
+   {
+      ValueType value;
+      if (!stream.read(reinterpret_cast<char*>(&value), sizeof(value)))
+      {
+         throw std::runtime_error{ "Unexpected end of the string data." };
+      }
+
+      return value;
+   }
+
+   void Read(std::istream& stream, NativeChar* characters, std::size_t count)
+   {
+      if (!stream.read(
+         reinterpret_cast<char*>(characters),
+         static_cast<std::streamsize>(count * sizeof(NativeChar))))
+      {
+         throw std::runtime_error{ "Unexpected end of the string data." };
+      }
+   }
+}
+
+constexpr std::size_t StringPool::CHARACTERS_PER_CHUNK;
+constexpr std::size_t StringPool::MAXIMUM_LENGTH;
+constexpr std::size_t StringPool::MAXIMUM_CHUNK_COUNT;
+
+constexpr InternTable::Id InternTable::EMPTY_STRING_ID;
+
+StringPool::StringPool() :
+   StringPool{ MAXIMUM_CHUNK_COUNT }
+{
+}
+
+StringPool::StringPool(std::size_t maximumChunkCount) :
+   m_maximumChunkCount{ std::min(maximumChunkCount, MAXIMUM_CHUNK_COUNT) },
+   m_chunks{ new std::unique_ptr<NativeChar[]>[m_maximumChunkCount] }
+{
+}
+
+StringPool::Reference StringPool::Append(NativeStringView string)
+{
+   const auto length = std::min(string.size(), MAXIMUM_LENGTH);
+
+   // Empty strings take up no space, and can be referred to without looking at the pool at all:
+   if (length == 0)
+   {
+      return { 0, 0 };
+   }
+
+   const std::lock_guard<decltype(m_mutex)> lock{ m_mutex };
+
+   // Strings never straddle two chunks, so that they can always be handed out as a single view:
+   auto offset = m_size;
+
+   const auto usedInChunk = offset % CHARACTERS_PER_CHUNK;
+   if (usedInChunk + length > CHARACTERS_PER_CHUNK)
+   {
+      offset += CHARACTERS_PER_CHUNK - usedInChunk;
+   }
+
+   if (offset + length > m_maximumChunkCount * CHARACTERS_PER_CHUNK)
+   {
+      throw std::length_error{ "The string pool has run out of chunks." };
+   }
+
+   if (offset / CHARACTERS_PER_CHUNK == m_chunkCount)
+   {
+      // Zeroing the chunk keeps the gaps at the end of full chunks from holding garbage, which
+      // would otherwise be written out by WriteTo(...):
+      m_chunks[m_chunkCount].reset(new NativeChar[CHARACTERS_PER_CHUNK]());
+      ++m_chunkCount;
+   }
+
+   const Reference reference{
+      static_cast<std::uint32_t>(offset), static_cast<std::uint16_t>(length) };
+
+   auto* const destination = m_chunks[m_chunkCount - 1].get() + offset % CHARACTERS_PER_CHUNK;
+   std::copy_n(string.data(), length, destination);
+
+   m_size = offset + length;
+
+   return reference;
+}
+
+NativeStringView StringPool::Get(Reference reference) const noexcept
+{
+   if (reference.length == 0)
+   {
+      return {};
+   }
+
+   const auto& chunk = m_chunks[reference.offset / CHARACTERS_PER_CHUNK];
+   return { chunk.get() + reference.offset % CHARACTERS_PER_CHUNK, reference.length };
+}
+
+std::size_t StringPool::GetSize() const noexcept
+{
+   return m_size;
+}
+
+void StringPool::WriteTo(std::ostream& stream) const
+{
+   const std::lock_guard<decltype(m_mutex)> lock{ m_mutex };
+
+   Write(stream, static_cast<std::uint64_t>(m_size));
+
+   for (std::size_t index = 0; index < m_chunkCount; ++index)
+   {
+      const auto count = std::min(m_size - index * CHARACTERS_PER_CHUNK, CHARACTERS_PER_CHUNK);
+      Write(stream, m_chunks[index].get(), count);
+   }
+}
+
+void StringPool::ReadFrom(std::istream& stream)
+{
+   // Chunks are read in from the start, so anything already in the pool would be left
+   // inconsistent with its size:
+   if (m_chunkCount != 0)
+   {
+      throw std::logic_error{ "Strings can only be read into an empty pool." };
+   }
+
+   const auto size = Read<std::uint64_t>(stream);
+   if (size > m_maximumChunkCount * CHARACTERS_PER_CHUNK)
+   {
+      throw std::runtime_error{ "The string data holds more than the pool can address." };
+   }
+
+   for (std::uint64_t offset = 0; offset < size; offset += CHARACTERS_PER_CHUNK)
+   {
+      const auto count = static_cast<std::size_t>(
+         std::min<std::uint64_t>(size - offset, CHARACTERS_PER_CHUNK));
+
+      m_chunks[m_chunkCount].reset(new NativeChar[CHARACTERS_PER_CHUNK]());
+      Read(stream, m_chunks[m_chunkCount].get(), count);
+
+      ++m_chunkCount;
+      m_size = static_cast<std::size_t>(offset) + count;
+   }
+}
+
+InternTable::InternTable()
+{
+   Intern({});
+}
+
+InternTable::Id InternTable::Intern(NativeStringView string)
+{
+   {
+      const std::shared_lock<decltype(m_mutex)> lock{ m_mutex };
+
+      const auto itr = m_ids.find(string);
+      if (itr != std::end(m_ids))
+      {
+         return itr->second;
+      }
+   }
+
+   const std::lock_guard<decltype(m_mutex)> lock{ m_mutex };
+
+   // Another thread may have added the same string in the meantime:
+   const auto itr = m_ids.find(string);
+   if (itr != std::end(m_ids))
+   {
+      return itr->second;
+   }
+
+   const auto id = static_cast<Id>(m_views.size());
+
+   m_strings.emplace_back(string);
+   m_views.emplace_back(m_strings.back());
+   m_ids.emplace(m_views.back(), id);
+
+   return id;
+}
+
+NativeStringView InternTable::Get(Id id) const
+{
+   const std::shared_lock<decltype(m_mutex)> lock{ m_mutex };
+   return m_views[id];
+}
+
+std::size_t InternTable::GetSize() const
+{
+   const std::shared_lock<decltype(m_mutex)> lock{ m_mutex };
+   return m_views.size();
+}
+
+void InternTable::WriteTo(std::ostream& stream) const
+{
+   const std::shared_lock<decltype(m_mutex)> lock{ m_mutex };
+
+   Write(stream, static_cast<std::uint64_t>(m_views.size()));
+
+   for (const auto& view : m_views)
+   {
+      Write(stream, static_cast<std::uint64_t>(view.size()));
+      Write(stream, view.data(), view.size());
+   }
+}
+
+void InternTable::ReadFrom(std::istream& stream)
+{
+   if (GetSize() != 1)
+   {
+      throw std::logic_error{ "Strings can only be read into an empty table." };
+   }
+
+   const auto count = Read<std::uint64_t>(stream);
+
+   // Interning the strings in their original order hands out the same IDs once more:
+   std::basic_string<NativeChar> string;
+   for (std::uint64_t id = 0; id < count; ++id)
+   {
+      string.resize(static_cast<std::size_t>(Read<std::uint64_t>(stream)));
+      Read(stream, &string[0], string.size());
+
+      if (Intern(string) != id)
+      {
+         throw std::runtime_error{ "The string data holds duplicate or misplaced strings." };
+      }
+   }
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <experimental/filesystem>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+* @brief Names are stored in the native encoding of the platform: UTF-16 on Windows, and
+* (usually) UTF-8 elsewhere. This way, no name ever has to be converted while scanning.
+*/
+using NativeChar = std::experimental::filesystem::path::value_type;
+using NativeStringView = std::basic_string_view<NativeChar>;
+
+/**
+* @brief The String Pool class is an append-only arena for many small strings.
+*
+* Strings are copied, back to back, into large chunks, and are then referred to by their offset
+* and length. Compared to a `std::basic_string` per string, this saves the string objects
+* themselves, the heap allocation for every string that's too long for the small string buffer,
+* and the bookkeeping the allocator keeps for each of these.
+*/
+class StringPool
+{
+public:
+
+   /**
+   * @brief Identifies a string in the pool.
+   */
+   struct Reference
+   {
+      std::uint32_t offset;
+      std::uint16_t length;
+   };
+
+   static constexpr std::size_t CHARACTERS_PER_CHUNK{ 1 << 20 };
+   static constexpr std::size_t MAXIMUM_LENGTH{ UINT16_MAX };
+
+   /**
+   * The number of chunks that 32-bit offsets can address.
+   */
+   static constexpr std::size_t MAXIMUM_CHUNK_COUNT{
+      (std::size_t{ UINT32_MAX } + 1) / CHARACTERS_PER_CHUNK };
+
+   /**
+   * @brief Creates a pool that may grow for as long as 32-bit offsets can address its chunks.
+   */
+   StringPool();
+
+   /**
+   * @param[in] maximumChunkCount   The number of chunks beyond which the pool refuses to grow,
+   *                                which is capped at what 32-bit offsets can address.
+   */
+   explicit StringPool(std::size_t maximumChunkCount);
+
+   StringPool(const StringPool&) = delete;
+   StringPool& operator=(const StringPool&) = delete;
+
+   /**
+   * @brief Copies a string into the pool. Safe to call from multiple threads at once.
+   *
+   * @note Strings longer than MAXIMUM_LENGTH are truncated.
+   *
+   * @throws std::length_error if the pool has no room left in its chunks, in which case the pool
+   * is left as it was.
+   *
+   * @returns A reference by which the string can later be retrieved.
+   */
+   Reference Append(NativeStringView string);
+
+   /**
+   * @note This may be called while other threads are appending, since chunks never move once
+   * they've been allocated; the reference must merely have been handed out before.
+   *
+   * @returns The string identified by the given reference.
+   */
+   NativeStringView Get(Reference reference) const noexcept;
+
+   /**
+   * @returns The number of characters stored in the pool, including any unused space at the end
+   * of full chunks.
+   */
+   std::size_t GetSize() const noexcept;
+
+   /**
+   * @brief Writes the contents of the pool to a binary stream, such that ReadFrom(...) can
+   * restore them with every Reference intact.
+   */
+   void WriteTo(std::ostream& stream) const;
+
+   /**
+   * @brief Restores the contents of a pool written by WriteTo(...). Must only be called on an
+   * empty pool, and not while any other thread is using it.
+   *
+   * @throws std::logic_error if the pool isn't empty.
+   *
+   * @throws std::runtime_error if the stream ends early, or holds more than the pool can address.
+   */
+   void ReadFrom(std::istream& stream);
+
+private:
+
+   const std::size_t m_maximumChunkCount;
+
+   // A fixed table of chunks, rather than a growing vector, ensures that appending never moves
+   // the pointers that concurrent lookups are reading:
+   std::unique_ptr<std::unique_ptr<NativeChar[]>[]> m_chunks;
+
+   std::size_t m_chunkCount{ 0 };
+   std::size_t m_size{ 0 };
+
+   mutable std::mutex m_mutex;
+};
+
+/**
+* @brief The Intern Table class assigns a small, unique ID to each distinct string.
+*
+* This is meant for strings that repeat a lot, such as file extensions, of which a scan of
+* millions of files will typically only encounter a few thousand distinct ones.
+*/
+class InternTable
+{
+public:
+
+   using Id = std::uint32_t;
+
+   /**
+   * The ID of the empty string, which is always present.
+   */
+   static constexpr Id EMPTY_STRING_ID{ 0 };
+
+   InternTable();
+
+   InternTable(const InternTable&) = delete;
+   InternTable& operator=(const InternTable&) = delete;
+
+   /**
+   * @brief Looks up or adds a string. Safe to call from multiple threads at once. Strings that
+   * have been seen before are found without allocating any memory.
+   *
+   * @returns The ID of the string.
+   */
+   Id Intern(NativeStringView string);
+
+   /**
+   * @returns The string with the given ID.
+   */
+   NativeStringView Get(Id id) const;
+
+   /**
+   * @returns The number of distinct strings in the table.
+   */
+   std::size_t GetSize() const;
+
+   /**
+   * @brief Writes every string to a binary stream, in the order of their IDs, such that
+   * ReadFrom(...) can restore them under the same IDs.
+   */
+   void WriteTo(std::ostream& stream) const;
+
+   /**
+   * @brief Restores the strings written by WriteTo(...). Must only be called on a table that
+   * holds nothing but the empty string, and not while any other thread is using it.
+   *
+   * @throws std::logic_error if the table holds anything but the empty string.
+   *
+   * @throws std::runtime_error if the stream ends early, or doesn't start with the empty string.
+   */
+   void ReadFrom(std::istream& stream);
+
+private:
+
+   // The strings are kept in a deque, since it never moves its elements around, which means that
+   // the views into those strings remain valid:
+   std::deque<std::basic_string<NativeChar>> m_strings;
+   std::vector<NativeStringView> m_views;
+
+   std::unordered_map<NativeStringView, Id> m_ids;
+
+   mutable std::shared_mutex m_mutex;
+};
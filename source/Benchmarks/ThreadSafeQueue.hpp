@@ -1,11 +1,32 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
 #include <type_traits>
-#include <queue>
+#include <utility>
 
+/**
+* @brief The Thread Safe Queue class is a bounded, multi-producer, multi-consumer queue.
+*
+* The elements live in a ring buffer that is allocated once, up front. Each slot in the buffer
+* carries a sequence number, which tells producers whether the slot is free for the current lap
+* around the buffer, and consumers whether it has been filled. Claiming a slot therefore only takes
+* a single compare-and-swap on either the head or the tail of the queue, and producers and
+* consumers never contend over a lock. The batch operations claim a whole run of slots with that
+* same single compare-and-swap.
+*
+* Only the blocking operations ever take a lock, and then only once spinning has failed to turn up
+* an element (or a free slot), in order to go to sleep. The other side only takes that lock to wake
+* up sleepers, and only if there are any.
+*/
 template<typename Type>
 class ThreadSafeQueue
 {
@@ -13,86 +34,478 @@ class ThreadSafeQueue
 
 public:
 
-   void Push(Type data)
+   static constexpr std::size_t DEFAULT_CAPACITY{ 1024 };
+
+   /**
+   * @brief Constructs an empty queue.
+   *
+   * @param[in] capacity            The number of elements that the queue can hold at once. This
+   *                                is rounded up to the next power of two.
+   */
+   explicit ThreadSafeQueue(std::size_t capacity = DEFAULT_CAPACITY)
+      : m_capacity{ RoundUpToPowerOfTwo(capacity) },
+      m_slots{ std::make_unique<Slot[]>(m_capacity) }
    {
-      const std::lock_guard<decltype(m_mutex)> lock{ m_mutex };
+      for (std::size_t index = 0; index < m_capacity; ++index)
+      {
+         m_slots[index].sequence.store(index, std::memory_order_relaxed);
+      }
+   }
 
-      m_queue.push(std::move(data));
+   /**
+   * @brief Destroys any elements still in the queue.
+   */
+   ~ThreadSafeQueue()
+   {
+      while (TryPop())
+      {
+      }
+   }
+
+   ThreadSafeQueue(const ThreadSafeQueue&) = delete;
+   ThreadSafeQueue& operator=(const ThreadSafeQueue&) = delete;
 
-      m_conditionVariable.notify_one();
+   /**
+   * @brief Adds an element to the back of the queue, waiting for a free slot if the queue is full.
+   */
+   void Push(Type data)
+   {
+      Emplace(std::move(data));
    }
 
+   /**
+   * @brief Constructs an element in place at the back of the queue, waiting for a free slot if
+   * the queue is full.
+   */
    template<typename... Args>
    void Emplace(Args&&... args)
    {
-      const std::lock_guard<decltype(m_mutex)> lock{ m_mutex };
+      std::size_t position;
+      WaitUntil(
+         [&] { return TryClaim(m_tail, 0, 1, position) > 0; },
+         [this] { return IsSlotReady(m_tail, 0); },
+         m_sleepingProducers, m_spaceAvailable);
 
-      m_queue.emplace(std::forward<Args>(args)...);
+      Fill(position, std::forward<Args>(args)...);
+      WakeUp(m_sleepingConsumers, m_dataAvailable);
+   }
 
-      m_conditionVariable.notify_one();
+   /**
+   * @brief Adds an element to the back of the queue, unless the queue is full.
+   *
+   * @returns True if the element was added, and false otherwise.
+   */
+   bool TryPush(Type data)
+   {
+      return TryEmplace(std::move(data));
    }
 
-   void WaitAndPop(Type& data)
+   /**
+   * @brief Constructs an element in place at the back of the queue, unless the queue is full.
+   *
+   * @returns True if the element was added, and false otherwise.
+   */
+   template<typename... Args>
+   bool TryEmplace(Args&&... args)
    {
-      std::unique_lock<decltype(m_mutex)> lock{ m_mutex };
-      m_conditionVariable.wait(lock, [this] { return !m_queue.empty(); });
+      std::size_t position;
+      if (TryClaim(m_tail, 0, 1, position) == 0)
+      {
+         return false;
+      }
 
-      data = std::move(m_queue.front());
+      Fill(position, std::forward<Args>(args)...);
+      WakeUp(m_sleepingConsumers, m_dataAvailable);
 
-      m_queue.pop();
+      return true;
    }
 
-   std::shared_ptr<Type> WaitAndPop()
+   /**
+   * @brief Moves every element in the specified range to the back of the queue, waiting for free
+   * slots whenever the queue is full. The elements are added in as few runs as the free space in
+   * the queue allows, with each run claimed in one go.
+   */
+   template<typename InputIteratorType>
+   void PushBatch(InputIteratorType first, InputIteratorType last)
    {
-      std::unique_lock<decltype(m_mutex)> lock{ m_mutex };
-      m_conditionVariable.wait(lock, [this] { return !m_queue.empty(); });
+      std::size_t remaining = static_cast<std::size_t>(std::distance(first, last));
+      while (remaining > 0)
+      {
+         std::size_t position;
+         std::size_t count;
+         WaitUntil(
+            [&] { return (count = TryClaim(m_tail, 0, remaining, position)) > 0; },
+            [this] { return IsSlotReady(m_tail, 0); },
+            m_sleepingProducers, m_spaceAvailable);
 
-      const auto result = std::make_shared<Type>(std::move(m_queue.front()));
-      m_queue.pop();
+         for (std::size_t index = 0; index < count; ++index, ++first)
+         {
+            Fill(position + index, std::move(*first));
+         }
 
-      return result;
+         remaining -= count;
+         WakeUp(m_sleepingConsumers, m_dataAvailable, count);
+      }
    }
 
-   bool TryPop(Type& data)
+   /**
+   * @brief Removes the element at the front of the queue, waiting for one to arrive if the queue
+   * is empty.
+   */
+   void WaitAndPop(Type& data)
    {
-      const std::lock_guard<decltype(m_mutex)> lock{ m_mutex };
+      data = WaitAndPop();
+   }
 
-      if (m_queue.empty())
+   /**
+   * @overload
+   */
+   Type WaitAndPop()
+   {
+      std::size_t position;
+      WaitUntil(
+         [&] { return TryClaim(m_head, 1, 1, position) > 0; },
+         [this] { return IsSlotReady(m_head, 1); },
+         m_sleepingConsumers, m_dataAvailable);
+
+      Type data = Drain(position);
+      WakeUp(m_sleepingProducers, m_spaceAvailable);
+
+      return data;
+   }
+
+   /**
+   * @brief Removes the element at the front of the queue, unless the queue is empty.
+   *
+   * @returns True if an element was removed, and false otherwise.
+   */
+   bool TryPop(Type& data)
+   {
+      auto element = TryPop();
+      if (!element)
       {
          return false;
       }
 
-      data = std::move(m_queue.front());
-      m_queue.pop();
-
+      data = std::move(*element);
       return true;
    }
 
-   std::shared_ptr<Type> TryPop()
+   /**
+   * @overload
+   *
+   * @returns The removed element, if there was one.
+   */
+   std::optional<Type> TryPop()
    {
-      const std::lock_guard<decltype(m_mutex)> lock{ m_mutex };
+      std::size_t position;
+      if (TryClaim(m_head, 1, 1, position) == 0)
+      {
+         return std::nullopt;
+      }
 
-      if (m_queue.empty())
+      std::optional<Type> data{ Drain(position) };
+      WakeUp(m_sleepingProducers, m_spaceAvailable);
+
+      return data;
+   }
+
+   /**
+   * @brief Removes up to the specified number of elements from the front of the queue in one go,
+   * without waiting for more to arrive.
+   *
+   * @param[out] output             Where the removed elements are written to, in order.
+   * @param[in] maxCount            The largest number of elements to remove.
+   *
+   * @returns The number of elements removed.
+   */
+   template<typename OutputIteratorType>
+   std::size_t TryPopBatch(OutputIteratorType output, std::size_t maxCount)
+   {
+      std::size_t position;
+      const auto count = TryClaim(m_head, 1, maxCount, position);
+
+      for (std::size_t index = 0; index < count; ++index, ++output)
       {
-         return { };
+         *output = Drain(position + index);
       }
 
-      const auto result = std::make_shared<Type>(std::move(m_queue.front()));
-      m_queue.pop();
+      if (count > 0)
+      {
+         WakeUp(m_sleepingProducers, m_spaceAvailable, count);
+      }
 
-      return result;
+      return count;
    }
 
-   bool IsEmpty() const
+   /**
+   * @returns True if the queue held no elements at the time of the call.
+   *
+   * @note With other threads pushing and popping, the answer may be out of date by the time it
+   * is returned.
+   */
+   bool IsEmpty() const noexcept
    {
-      const std::lock_guard<decltype(m_mutex)> lock{ m_mutex };
-      return m_queue.empty();
+      return m_tail.position.load() == m_head.position.load();
+   }
+
+   /**
+   * @returns The number of elements that the queue can hold at once.
+   */
+   std::size_t GetCapacity() const noexcept
+   {
+      return m_capacity;
    }
 
 private:
 
-   mutable std::mutex m_mutex;
+   /**
+   * The size of a cache line, hard-coded, since std::hardware_destructive_interference_size is not
+   * yet available everywhere.
+   */
+   static constexpr std::size_t CACHE_LINE_SIZE{ 64 };
+
+   /**
+   * @brief A slot in the ring buffer.
+   *
+   * A slot at index `i` is free for the producer of position `p` (where `p % capacity == i`) when
+   * its sequence number equals `p`, and filled for the consumer of that position when it equals
+   * `p + 1`. Draining the slot advances its sequence number to `p + capacity`, making it free for
+   * the next lap.
+   */
+   struct Slot
+   {
+      std::atomic<std::size_t> sequence;
+      std::aligned_storage_t<sizeof(Type), alignof(Type)> storage;
+   };
+
+   /**
+   * @brief Either end of the queue, on a cache line of its own, so that producers and consumers
+   * don't invalidate each other's line on every claim.
+   */
+   struct alignas(CACHE_LINE_SIZE) Cursor
+   {
+      std::atomic<std::size_t> position{ 0 };
+   };
+
+   static std::size_t RoundUpToPowerOfTwo(std::size_t value) noexcept
+   {
+      std::size_t result{ 1 };
+      while (result < value)
+      {
+         result <<= 1;
+      }
+
+      return result;
+   }
+
+   Slot& GetSlot(std::size_t position) const noexcept
+   {
+      return m_slots[position & (m_capacity - 1)];
+   }
+
+   /**
+   * @returns True if the slot at the specified end of the queue is ready, or if that end has
+   * already moved on, in which case only another attempt can tell.
+   *
+   * Unlike comparing the head with the tail, this takes into account that a claimed slot only
+   * becomes ready once the other side has filled, or drained, it. A thread sleeping on this
+   * condition is therefore only woken up once its next attempt can succeed, rather than as soon as
+   * the other side has claimed the slot, only to spin until the slot has been published.
+   *
+   * @param[in] cursor              The end of the queue to check.
+   * @param[in] readyOffset         See TryClaim(...).
+   */
+   bool IsSlotReady(const Cursor& cursor, std::size_t readyOffset) const noexcept
+   {
+      const auto position = cursor.position.load();
+      const auto sequence = GetSlot(position).sequence.load();
+
+      return static_cast<std::ptrdiff_t>(sequence - (position + readyOffset)) >= 0;
+   }
+
+   /**
+   * @brief Claims a run of consecutive positions at one end of the queue.
+   *
+   * @param[in] cursor              The end of the queue to claim from.
+   * @param[in] readyOffset         The offset, relative to a position, of the sequence number that
+   *                                marks its slot as ready: zero for producers, who need a free
+   *                                slot, and one for consumers, who need a filled slot.
+   * @param[in] maxCount            The largest number of positions to claim.
+   * @param[out] position           The first of the claimed positions.
+   *
+   * @returns The number of positions claimed, which is zero if not even the first slot was ready.
+   */
+   std::size_t TryClaim(
+      Cursor& cursor,
+      std::size_t readyOffset,
+      std::size_t maxCount,
+      std::size_t& position) noexcept
+   {
+      maxCount = std::min(maxCount, m_capacity);
+      if (maxCount == 0)
+      {
+         return 0;
+      }
+
+      position = cursor.position.load(std::memory_order_relaxed);
+      while (true)
+      {
+         const auto lead = [&] (std::size_t offset) noexcept
+         {
+            const auto& slot = GetSlot(position + offset);
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto expected = position + offset + readyOffset;
+
+            return static_cast<std::ptrdiff_t>(sequence - expected);
+         };
+
+         const auto firstLead = lead(0);
+         if (firstLead < 0)
+         {
+            // The queue is either full or empty, depending on the end:
+            return 0;
+         }
+
+         if (firstLead > 0)
+         {
+            // Another thread claimed this position in the meantime:
+            position = cursor.position.load(std::memory_order_relaxed);
+            continue;
+         }
+
+         // Extend the claim across the run of ready slots. Once a slot is ready, it stays that
+         // way until the position it is ready for has been claimed:
+         std::size_t count{ 1 };
+         while (count < maxCount && lead(count) == 0)
+         {
+            ++count;
+         }
+
+         if (cursor.position.compare_exchange_weak(position, position + count))
+         {
+            return count;
+         }
+      }
+   }
+
+   /**
+   * @brief Constructs the element at a claimed position, and publishes its slot to consumers.
+   *
+   * @note The sequence number is stored with sequential consistency, rather than just with
+   * release semantics, since sleeping consumers check that very store. See WaitUntil(...).
+   */
+   template<typename... Args>
+   void Fill(std::size_t position, Args&&... args)
+   {
+      auto& slot = GetSlot(position);
+      new (&slot.storage) Type(std::forward<Args>(args)...);
+
+      slot.sequence.store(position + 1);
+   }
+
+   /**
+   * @brief Moves the element out of a claimed position, and hands its slot back to producers.
+   *
+   * @note As in Fill(...), the sequence number is stored with sequential consistency, since
+   * sleeping producers check that very store.
+   */
+   Type Drain(std::size_t position)
+   {
+      auto& slot = GetSlot(position);
+      auto* const element = std::launder(reinterpret_cast<Type*>(&slot.storage));
+
+      Type data{ std::move(*element) };
+      element->~Type();
+
+      slot.sequence.store(position + m_capacity);
+
+      return data;
+   }
 
-   std::queue<Type> m_queue;
-   std::condition_variable m_conditionVariable;
+   /**
+   * @brief Repeatedly attempts an operation, yielding in between attempts for a while, and then
+   * going to sleep until the condition under which the operation could succeed holds again.
+   */
+   template<typename AttemptType, typename ConditionType>
+   void WaitUntil(
+      AttemptType&& attempt,
+      ConditionType&& condition,
+      std::atomic<std::size_t>& sleeperCount,
+      std::condition_variable& wakeUpSignal)
+   {
+      constexpr auto SPIN_COUNT{ 64 };
+
+      while (true)
+      {
+         for (auto spin{ 0 }; spin < SPIN_COUNT; ++spin)
+         {
+            if (attempt())
+            {
+               return;
+            }
+
+            std::this_thread::yield();
+         }
+
+         std::unique_lock<decltype(m_sleepMutex)> lock{ m_sleepMutex };
+
+         // The sleeper count is raised before the condition is checked, while the other side
+         // publishes its slot before it checks the sleeper count. Since all of these accesses are
+         // sequentially consistent, at least one side will see the other's change, and so no
+         // wake-up can be missed:
+         sleeperCount.fetch_add(1);
+         wakeUpSignal.wait(lock, condition);
+         sleeperCount.fetch_sub(1);
+      }
+   }
+
+   /**
+   * @brief Wakes up as many threads sleeping on the specified signal as there are new elements
+   * (or free slots) for, but only takes the lock if there is anyone sleeping at all.
+   */
+   void WakeUp(
+      const std::atomic<std::size_t>& sleeperCount,
+      std::condition_variable& wakeUpSignal,
+      std::size_t count = 1)
+   {
+      if (sleeperCount.load() == 0)
+      {
+         return;
+      }
+
+      {
+         // Taking the lock, however briefly, ensures that no thread can be caught between checking
+         // the condition and going to sleep, and thus miss this notification:
+         const std::lock_guard<decltype(m_sleepMutex)> lock{ m_sleepMutex };
+      }
+
+      if (count == 1)
+      {
+         wakeUpSignal.notify_one();
+      }
+      else
+      {
+         wakeUpSignal.notify_all();
+      }
+   }
+
+   const std::size_t m_capacity;
+   const std::unique_ptr<Slot[]> m_slots;
+
+   Cursor m_head;
+   Cursor m_tail;
+
+   std::atomic<std::size_t> m_sleepingProducers{ 0 };
+   std::atomic<std::size_t> m_sleepingConsumers{ 0 };
+
+   std::mutex m_sleepMutex;
+   std::condition_variable m_dataAvailable;
+   std::condition_variable m_spaceAvailable;
 };
+
+template<typename Type>
+constexpr std::size_t ThreadSafeQueue<Type>::DEFAULT_CAPACITY;
+
+template<typename Type>
+constexpr std::size_t ThreadSafeQueue<Type>::CACHE_LINE_SIZE;
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "Stopwatch.hpp"
+
+/**
+* @brief The Trial Statistics struct summarizes the times taken by repeated trials of a benchmark.
+*
+* The minimum, median, and 99th percentile are taken over every trial, since they are either
+* robust against outliers to begin with, or meant to capture them. The mean and standard
+* deviation, on the other hand, are taken only over the trials that fall within Tukey's outer
+* fences (three interquartile ranges beyond the first and third quartiles), so that the odd trial
+* that got preempted or page-faulted doesn't skew them.
+*
+* All times are expressed in the units of the ChronoType that the trials were run with, but with
+* fractional precision.
+*/
+struct TrialStatistics
+{
+   double minimum{ 0 };
+   double median{ 0 };
+   double percentile99{ 0 };
+   double mean{ 0 };
+   double standardDeviation{ 0 };
+
+   std::size_t trialCount{ 0 };
+   std::size_t outlierCount{ 0 };
+
+   /**
+   * @brief Computes the statistics of the specified trial times.
+   */
+   static TrialStatistics FromSamples(std::vector<double> samples)
+   {
+      TrialStatistics statistics;
+      statistics.trialCount = samples.size();
+
+      if (samples.empty())
+      {
+         return statistics;
+      }
+
+      std::sort(std::begin(samples), std::end(samples));
+
+      // Nearest-rank percentiles:
+      const auto percentile = [&] (double fraction) noexcept
+      {
+         const auto rank = static_cast<std::size_t>(std::ceil(fraction * samples.size()));
+         return samples[std::max<std::size_t>(rank, 1) - 1];
+      };
+
+      statistics.minimum = samples.front();
+      statistics.median = percentile(0.50);
+      statistics.percentile99 = percentile(0.99);
+
+      const auto interquartileRange = percentile(0.75) - percentile(0.25);
+      const auto lowerFence = percentile(0.25) - 3 * interquartileRange;
+      const auto upperFence = percentile(0.75) + 3 * interquartileRange;
+
+      const auto first = std::lower_bound(std::begin(samples), std::end(samples), lowerFence);
+      const auto last = std::upper_bound(first, std::end(samples), upperFence);
+
+      const auto inlierCount = static_cast<std::size_t>(std::distance(first, last));
+      statistics.outlierCount = samples.size() - inlierCount;
+
+      statistics.mean = std::accumulate(first, last, 0.0) / inlierCount;
+
+      if (inlierCount > 1)
+      {
+         const auto squaredDeviations = std::accumulate(first, last, 0.0,
+            [&] (double total, double sample) noexcept
+         {
+            return total + (sample - statistics.mean) * (sample - statistics.mean);
+         });
+
+         statistics.standardDeviation = std::sqrt(squaredDeviations / (inlierCount - 1));
+      }
+
+      return statistics;
+   }
+};
+
+/**
+* @brief Writes the statistics out in a single line, for the console.
+*/
+inline std::ostream& operator<<(std::ostream& stream, const TrialStatistics& statistics)
+{
+   return stream
+      << "median " << statistics.median
+      << " (min " << statistics.minimum
+      << ", p99 " << statistics.percentile99
+      << ", mean " << statistics.mean
+      << ", std. dev. " << statistics.standardDeviation
+      << ", " << statistics.outlierCount << " of " << statistics.trialCount << " trials rejected)";
+}
+
+/**
+* @brief Times a number of trials of the specified callable object, after first running a few
+* untimed trials to warm up the caches and the branch predictors.
+*
+* @param[in] trialCount            The number of timed trials.
+* @param[in] warmUpCount           The number of untimed trials run beforehand.
+* @param[in] lambda                The code to be timed.
+* @param[in] prepare               Code that is run, untimed, before every trial, including the
+*                                  warm-up trials, such as to set up state for the trial to consume.
+*
+* @returns The statistics of the timed trials, in ChronoType units.
+*/
+template<
+   typename ChronoType,
+   typename LambdaType,
+   typename PrepareType
+>
+TrialStatistics RunTrials(
+   std::size_t trialCount,
+   std::size_t warmUpCount,
+   LambdaType&& lambda,
+   PrepareType&& prepare)
+{
+   using FractionalChronoType = std::chrono::duration<double, typename ChronoType::period>;
+
+   for (std::size_t trial = 0; trial < warmUpCount; ++trial)
+   {
+      prepare();
+      lambda();
+   }
+
+   std::vector<double> samples;
+   samples.reserve(trialCount);
+
+   for (std::size_t trial = 0; trial < trialCount; ++trial)
+   {
+      prepare();
+
+      const auto clock = Stopwatch<std::chrono::nanoseconds>([&] () noexcept { lambda(); });
+      samples.emplace_back(
+         std::chrono::duration_cast<FractionalChronoType>(clock.GetElapsedTime()).count());
+   }
+
+   return TrialStatistics::FromSamples(std::move(samples));
+}
+
+/**
+* @overload
+*/
+template<
+   typename ChronoType,
+   typename LambdaType
+>
+TrialStatistics RunTrials(std::size_t trialCount, std::size_t warmUpCount, LambdaType&& lambda)
+{
+   return RunTrials<ChronoType>(
+      trialCount, warmUpCount, std::forward<LambdaType>(lambda), [] () noexcept { });
+}
@@ -0,0 +1,127 @@
+#ifdef _WIN32
+
+#include "DirectoryEnumerator.h"
+
+#include <memory>
+
+#include <Windows.h>
+
+namespace
+{
+   /**
+   * @brief Closes a search handle that was opened by `FindFirstFileExW(...)`.
+   */
+   struct SearchHandleDeleter
+   {
+      void operator()(HANDLE handle) const noexcept
+      {
+         FindClose(handle);
+      }
+   };
+
+   using SearchHandle = std::unique_ptr<void, SearchHandleDeleter>;
+
+   /**
+   * @returns True if the given name refers to either the directory itself, or to its parent.
+   */
+   bool IsDotOrDotDot(const wchar_t* name) noexcept
+   {
+      return name[0] == L'.' && (name[1] == L'\0' || (name[1] == L'.' && name[2] == L'\0'));
+   }
+
+   /**
+   * @returns The type of file described by the given search result.
+   */
+   FileType ClassifyEntry(const WIN32_FIND_DATAW& data) noexcept
+   {
+      const auto isDirectory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+
+      if (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)
+      {
+         // For reparse points, the search result also carries the reparse tag, which means that
+         // there's no need to open the file and query it with `DeviceIoControl(...)`. Other kinds
+         // of reparse points, such as deduplicated or cloud-backed files, still take up space of
+         // their own, and are therefore treated as regular files:
+         const auto tag = data.dwReserved0;
+         if (isDirectory || tag == IO_REPARSE_TAG_SYMLINK || tag == IO_REPARSE_TAG_MOUNT_POINT)
+         {
+            return FileType::SYMLINK;
+         }
+      }
+
+      return isDirectory ? FileType::DIRECTORY : FileType::REGULAR;
+   }
+}
+
+bool EnumerateDirectory(
+   const std::experimental::filesystem::path& directory,
+   const std::function<void(const DirectoryEntry&)>& visitor,
+   EnumerationStatistics* statistics)
+{
+   EnumerationStatistics localStatistics;
+   auto& counts = statistics ? *statistics : localStatistics;
+
+   const auto searchPattern = (directory / L"*").wstring();
+
+   // The basic information level skips the short 8.3 name, which the file system would otherwise
+   // have to look up for every entry, and the large fetch asks for bigger batches per call:
+   WIN32_FIND_DATAW data;
+   const auto rawHandle = FindFirstFileExW(
+      /* fileName = */ searchPattern.c_str(),
+      /* infoLevelId = */ FindExInfoBasic,
+      /* findFileData = */ &data,
+      /* searchOp = */ FindExSearchNameMatch,
+      /* searchFilter = */ nullptr,
+      /* additionalFlags = */ FIND_FIRST_EX_LARGE_FETCH);
+
+   ++counts.systemCalls;
+
+   if (rawHandle == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   const SearchHandle handle{ rawHandle };
+
+   // One more call to close the handle, on top of one for each call to FindNextFileW(...):
+   ++counts.systemCalls;
+
+   DirectoryEntry entry;
+
+   do
+   {
+      ++counts.systemCalls;
+
+      if (IsDotOrDotDot(data.cFileName))
+      {
+         continue;
+      }
+
+      const auto highWord = static_cast<std::uintmax_t>(data.nFileSizeHigh);
+
+      entry.name = data.cFileName;
+      entry.size = (highWord << sizeof(data.nFileSizeLow) * 8) | data.nFileSizeLow;
+      entry.type = ClassifyEntry(data);
+
+      visitor(entry);
+   }
+   while (FindNextFileW(handle.get(), &data));
+
+   return true;
+}
+
+std::int64_t GetLastWriteTime(const std::experimental::filesystem::path& directory)
+{
+   WIN32_FILE_ATTRIBUTE_DATA data;
+   if (!GetFileAttributesExW(directory.c_str(), GetFileExInfoStandard, &data))
+   {
+      return 0;
+   }
+
+   const auto highWord = static_cast<std::uint64_t>(data.ftLastWriteTime.dwHighDateTime);
+   const auto lowWord = static_cast<std::uint64_t>(data.ftLastWriteTime.dwLowDateTime);
+
+   return static_cast<std::int64_t>((highWord << 32) | lowWord);
+}
+
+#endif
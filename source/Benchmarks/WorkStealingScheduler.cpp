@@ -0,0 +1,202 @@
+#include "WorkStealingScheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+   /**
+   * @brief Identifies the scheduler and queue that the current thread works for, if any.
+   */
+   struct WorkerIdentity
+   {
+      const WorkStealingScheduler* scheduler;
+      std::size_t queueIndex;
+   };
+
+   thread_local WorkerIdentity currentWorker{ nullptr, 0 };
+}
+
+WorkStealingScheduler::WorkStealingScheduler(unsigned int threadCount)
+{
+   threadCount = std::max(threadCount, 1u);
+
+   m_queues.reserve(threadCount);
+   for (unsigned int index = 0; index < threadCount; ++index)
+   {
+      m_queues.emplace_back(std::make_unique<WorkerQueue>());
+   }
+
+   m_workers.reserve(threadCount);
+   for (std::size_t index = 0; index < threadCount; ++index)
+   {
+      m_workers.emplace_back([this, index] { RunWorker(index); });
+   }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler()
+{
+   Wait();
+
+   {
+      const std::lock_guard<decltype(m_stateMutex)> lock{ m_stateMutex };
+      m_isShuttingDown = true;
+   }
+
+   m_workAvailable.notify_all();
+
+   for (auto& worker : m_workers)
+   {
+      worker.join();
+   }
+}
+
+void WorkStealingScheduler::Spawn(Task task)
+{
+   const auto queueIndex = currentWorker.scheduler == this
+      ? currentWorker.queueIndex
+      : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+   m_unfinishedTasks.fetch_add(1);
+
+   {
+      auto& queue = *m_queues[queueIndex];
+      const auto lock = LockQueue(queue);
+      queue.tasks.emplace_back(std::move(task));
+      m_queuedTasks.fetch_add(1);
+   }
+
+   {
+      // Taking the lock, however briefly, ensures that no worker can be caught between checking
+      // for work and going to sleep, and thus miss this notification:
+      const std::lock_guard<decltype(m_stateMutex)> lock{ m_stateMutex };
+   }
+
+   m_workAvailable.notify_one();
+}
+
+void WorkStealingScheduler::Wait()
+{
+   std::unique_lock<decltype(m_stateMutex)> lock{ m_stateMutex };
+   m_allTasksFinished.wait(lock, [this] { return m_unfinishedTasks.load() == 0; });
+}
+
+bool WorkStealingScheduler::WaitFor(std::chrono::milliseconds timeout)
+{
+   std::unique_lock<decltype(m_stateMutex)> lock{ m_stateMutex };
+   return m_allTasksFinished.wait_for(
+      lock, timeout, [this] { return m_unfinishedTasks.load() == 0; });
+}
+
+unsigned int WorkStealingScheduler::GetThreadCount() const noexcept
+{
+   return static_cast<unsigned int>(m_workers.size());
+}
+
+std::size_t WorkStealingScheduler::GetCurrentWorkerIndex() const noexcept
+{
+   return currentWorker.scheduler == this ? currentWorker.queueIndex : m_workers.size();
+}
+
+std::size_t WorkStealingScheduler::GetQueuedTaskCount() const noexcept
+{
+   return m_queuedTasks.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds WorkStealingScheduler::GetLockWaitTime() const noexcept
+{
+   return std::chrono::nanoseconds{ m_lockWaitNanoseconds.load(std::memory_order_relaxed) };
+}
+
+void WorkStealingScheduler::RunWorker(std::size_t workerIndex)
+{
+   currentWorker = WorkerIdentity{ this, workerIndex };
+
+   Task task;
+   while (true)
+   {
+      if (TryAcquireTask(workerIndex, task))
+      {
+         task();
+         task = nullptr;
+
+         FinishTask();
+         continue;
+      }
+
+      std::unique_lock<decltype(m_stateMutex)> lock{ m_stateMutex };
+      m_workAvailable.wait(lock, [this] { return m_isShuttingDown || m_queuedTasks.load() > 0; });
+
+      if (m_isShuttingDown)
+      {
+         return;
+      }
+   }
+}
+
+bool WorkStealingScheduler::TryAcquireTask(std::size_t workerIndex, Task& task)
+{
+   const auto queueCount = m_queues.size();
+
+   for (std::size_t offset = 0; offset < queueCount; ++offset)
+   {
+      const auto isOwnQueue = offset == 0;
+
+      auto& queue = *m_queues[(workerIndex + offset) % queueCount];
+      const auto lock = LockQueue(queue);
+
+      if (queue.tasks.empty())
+      {
+         continue;
+      }
+
+      if (isOwnQueue)
+      {
+         task = std::move(queue.tasks.back());
+         queue.tasks.pop_back();
+      }
+      else
+      {
+         task = std::move(queue.tasks.front());
+         queue.tasks.pop_front();
+      }
+
+      m_queuedTasks.fetch_sub(1);
+      return true;
+   }
+
+   return false;
+}
+
+void WorkStealingScheduler::FinishTask()
+{
+   if (m_unfinishedTasks.fetch_sub(1) != 1)
+   {
+      return;
+   }
+
+   {
+      const std::lock_guard<decltype(m_stateMutex)> lock{ m_stateMutex };
+   }
+
+   m_allTasksFinished.notify_all();
+}
+
+std::unique_lock<std::mutex> WorkStealingScheduler::LockQueue(WorkerQueue& queue)
+{
+   std::unique_lock<std::mutex> lock{ queue.mutex, std::try_to_lock };
+   if (lock.owns_lock())
+   {
+      return lock;
+   }
+
+   const auto start = std::chrono::steady_clock::now();
+   lock.lock();
+   const auto waitTime = std::chrono::steady_clock::now() - start;
+
+   m_lockWaitNanoseconds.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(waitTime).count(),
+      std::memory_order_relaxed);
+
+   return lock;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* @brief The Work Stealing Scheduler class runs tasks on a fixed number of worker threads.
+*
+* Each worker owns a queue of tasks. Tasks spawned by a worker are pushed onto the back of that
+* worker's own queue, and the worker takes its next task from that same end. This keeps a
+* depth-first traversal on the same core for as long as possible. Only when a worker runs dry does
+* it steal from the front of another worker's queue, where the oldest (and, for a recursive scan,
+* typically the largest) pieces of work are waiting.
+*/
+class WorkStealingScheduler
+{
+public:
+
+   using Task = std::function<void()>;
+
+   /**
+   * @brief Starts the worker threads.
+   *
+   * @param[in] threadCount         The number of worker threads; zero is treated as one.
+   */
+   explicit WorkStealingScheduler(unsigned int threadCount);
+
+   /**
+   * @brief Waits for all outstanding tasks to finish, and then stops the worker threads.
+   */
+   ~WorkStealingScheduler();
+
+   WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+   WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+   /**
+   * @brief Queues up a task. When called from one of the worker threads, the task goes to the
+   * front of the line of that worker; otherwise, tasks are dealt out to the workers in turn.
+   *
+   * @note Tasks must not throw.
+   *
+   * @param[in] task                The task to run.
+   */
+   void Spawn(Task task);
+
+   /**
+   * @brief Blocks until every task, including those spawned by other tasks, has finished.
+   */
+   void Wait();
+
+   /**
+   * @brief Blocks until every task has finished, or until the timeout expires, whichever comes
+   * first.
+   *
+   * @returns True if every task has finished, and false if the timeout expired.
+   */
+   bool WaitFor(std::chrono::milliseconds timeout);
+
+   /**
+   * @returns The number of worker threads.
+   */
+   unsigned int GetThreadCount() const noexcept;
+
+   /**
+   * @returns The index of the worker thread that the calling thread is, or GetThreadCount() if
+   * the calling thread isn't one of the workers of this scheduler.
+   */
+   std::size_t GetCurrentWorkerIndex() const noexcept;
+
+   /**
+   * @returns The number of tasks that are waiting to be picked up by a worker.
+   */
+   std::size_t GetQueuedTaskCount() const noexcept;
+
+   /**
+   * @returns The total time that threads have spent waiting to lock the queue of a worker, because
+   * another thread was holding the lock. Uncontended locks are never timed, and don't count.
+   */
+   std::chrono::nanoseconds GetLockWaitTime() const noexcept;
+
+private:
+
+   /**
+   * @brief The queue of tasks owned by a single worker.
+   */
+   struct WorkerQueue
+   {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+   };
+
+   /**
+   * @brief The main loop of each worker thread.
+   *
+   * @param[in] workerIndex         The index of the queue owned by the worker.
+   */
+   void RunWorker(std::size_t workerIndex);
+
+   /**
+   * @brief Takes the most recently spawned task from the worker's own queue, or, failing that,
+   * the oldest task from the queue of any of the other workers.
+   *
+   * @returns True if a task was found, and false otherwise.
+   */
+   bool TryAcquireTask(std::size_t workerIndex, Task& task);
+
+   /**
+   * @brief Marks a task as finished, waking up anyone waiting if it was the last one.
+   */
+   void FinishTask();
+
+   /**
+   * @brief Locks the queue of a worker, keeping track of how long that took if the lock was
+   * already held by another thread.
+   */
+   std::unique_lock<std::mutex> LockQueue(WorkerQueue& queue);
+
+   std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+   std::vector<std::thread> m_workers;
+
+   std::atomic<std::size_t> m_queuedTasks{ 0 };
+   std::atomic<std::size_t> m_unfinishedTasks{ 0 };
+   std::atomic<std::size_t> m_nextQueue{ 0 };
+
+   std::atomic<std::int64_t> m_lockWaitNanoseconds{ 0 };
+
+   std::mutex m_stateMutex;
+   std::condition_variable m_workAvailable;
+   std::condition_variable m_allTasksFinished;
+
+   bool m_isShuttingDown{ false };
+};
@@ -26,24 +26,249 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename DataType>
+class FrozenTree;
+
+struct PreOrderTraversal;
+struct PostOrderTraversal;
+struct LevelOrderTraversal;
+struct LeafTraversal;
+
+/**
+ * The DefaultTreePolicy describes which optional bookkeeping the nodes of a Tree perform; by
+ * default, none at all. To opt into any of it, derive a policy from this one, override the
+ * relevant flags, and pass that policy to the Tree as its second template argument.
+ */
+struct DefaultTreePolicy
+{
+   /**
+    * Whether each Node caches the number of nodes in the subtree rooted at it. This turns
+    * Tree::Size() and Node::CountAllDescendants() into constant time operations, at the cost of
+    * having to update the counts of all ancestors whenever a Node is added or removed.
+    */
+   static constexpr bool TrackSubtreeSize = false;
+
+   /**
+    * Whether each Node caches the number of leaves in the subtree rooted at it. This requires
+    * TrackSubtreeSize to be enabled as well.
+    */
+   static constexpr bool TrackLeafCount = false;
+
+   /**
+    * Whether each Node carries a flag that can be set through Node::MarkVisited(...) and queried
+    * through Node::HasBeenVisited(). None of the iterators rely on this flag, so it's only needed
+    * by algorithms that want to mark nodes themselves.
+    */
+   static constexpr bool TrackVisitation = false;
+};
+
+/**
+ * The SubtreeCountingPolicy has every Node keep track of both its subtree size and leaf count.
+ */
+struct SubtreeCountingPolicy : DefaultTreePolicy
+{
+   static constexpr bool TrackSubtreeSize = true;
+   static constexpr bool TrackLeafCount = true;
+};
+
+/**
+ * The VisitationTrackingPolicy gives every Node a visitation flag.
+ */
+struct VisitationTrackingPolicy : DefaultTreePolicy
+{
+   static constexpr bool TrackVisitation = true;
+};
+
+namespace TreeInternals
+{
+   /**
+    * @brief Holds the subtree counts that a Node caches, as selected by the policy of its Tree.
+    * Counts that aren't tracked take up no space at all.
+    */
+   template <bool TrackSubtreeSize, bool TrackLeafCount>
+   class SubtreeCounts
+   {
+      static_assert(!TrackLeafCount, "Tracking leaf counts requires tracking subtree sizes.");
+
+    protected:
+      constexpr std::size_t TrackedSubtreeSize() const noexcept
+      {
+         return 0;
+      }
+
+      constexpr std::size_t TrackedLeafCount() const noexcept
+      {
+         return 0;
+      }
+
+      void AdjustSubtreeCounts(std::ptrdiff_t, std::ptrdiff_t) noexcept
+      {
+      }
+   };
+
+   template <>
+   class SubtreeCounts<true, false>
+   {
+    public:
+      /**
+       * @complexity Constant.
+       *
+       * @returns The number of nodes in the subtree rooted at this Node, including the Node
+       * itself.
+       */
+      constexpr std::size_t GetSubtreeSize() const noexcept
+      {
+         return m_subtreeSize;
+      }
+
+    protected:
+      constexpr std::size_t TrackedSubtreeSize() const noexcept
+      {
+         return m_subtreeSize;
+      }
+
+      constexpr std::size_t TrackedLeafCount() const noexcept
+      {
+         return 0;
+      }
+
+      void AdjustSubtreeCounts(std::ptrdiff_t sizeDelta, std::ptrdiff_t) noexcept
+      {
+         m_subtreeSize += static_cast<std::size_t>(sizeDelta);
+      }
+
+      std::size_t m_subtreeSize{ 1 };
+   };
+
+   template <>
+   class SubtreeCounts<true, true>
+   {
+    public:
+      /**
+       * @complexity Constant.
+       *
+       * @returns The number of nodes in the subtree rooted at this Node, including the Node
+       * itself.
+       */
+      constexpr std::size_t GetSubtreeSize() const noexcept
+      {
+         return m_subtreeSize;
+      }
+
+      /**
+       * @complexity Constant.
+       *
+       * @returns The number of leaves in the subtree rooted at this Node. A leaf counts itself.
+       */
+      constexpr std::size_t GetLeafCount() const noexcept
+      {
+         return m_leafCount;
+      }
+
+    protected:
+      constexpr std::size_t TrackedSubtreeSize() const noexcept
+      {
+         return m_subtreeSize;
+      }
+
+      constexpr std::size_t TrackedLeafCount() const noexcept
+      {
+         return m_leafCount;
+      }
+
+      void AdjustSubtreeCounts(std::ptrdiff_t sizeDelta, std::ptrdiff_t leafDelta) noexcept
+      {
+         m_subtreeSize += static_cast<std::size_t>(sizeDelta);
+         m_leafCount += static_cast<std::size_t>(leafDelta);
+      }
+
+      std::size_t m_subtreeSize{ 1 };
+      std::size_t m_leafCount{ 1 };
+   };
+
+   /**
+    * @brief Holds the visitation flag of a Node, if the policy of its Tree asks for one, on top of
+    * the rest of the bookkeeping that the Node performs. Without a flag, this takes up no space.
+    */
+   template <bool TrackVisitation, typename BaseType>
+   class VisitationFlag : public BaseType
+   {
+   };
+
+   template <typename BaseType>
+   class VisitationFlag<true, BaseType> : public BaseType
+   {
+    public:
+      /**
+       * @brief MarkVisited sets node visitation status.
+       *
+       * @note Marking nodes is left to the caller; none of the iterators read or write this flag.
+       *
+       * @param[in] visited             Whether the node should be marked as having been visited.
+       */
+      inline void MarkVisited(const bool visited = true) noexcept
+      {
+         m_visited = visited;
+      }
+
+      /**
+       * @returns True if the node has been marked as visited.
+       */
+      inline constexpr bool HasBeenVisited() const noexcept
+      {
+         return m_visited;
+      }
+
+    private:
+      bool m_visited{ false };
+   };
+
+   /**
+    * @brief The default sort function of Node::SortChildren(...), which sorts on the calling
+    * thread.
+    */
+   struct StableSort
+   {
+      template <typename IteratorType, typename ComparatorType>
+      void operator()(IteratorType first, IteratorType last, const ComparatorType& comparator) const
+      {
+         std::stable_sort(first, last, comparator);
+      }
+   };
+} // namespace TreeInternals
 
 /**
  * The Tree class declares a basic tree, built on top of templatized Node nodes.
  *
- * Each tree consists of a simple root Node and nothing else.
+ * Each tree consists of a simple root Node and nothing else. Nodes are allocated on the heap,
+ * unless the Tree was constructed with a NodeArena, in which case every Node is carved out of
+ * the arena's slabs instead.
  */
-template <typename DataType>
+template <typename DataType, typename PolicyType = DefaultTreePolicy>
 class Tree
 {
  public:
    class Node;
+   class NodeArena;
 
    class Iterator;
    class PreOrderIterator;
    class PostOrderIterator;
    class LeafIterator;
    class SiblingIterator;
+   class LevelOrderIterator;
 
    // Typedefs needed for STL compliance:
    using value_type = Node;
@@ -65,41 +290,126 @@ class Tree
    {
    }
 
+   /**
+    * @brief Tree constructs a new Tree with the provided data encapsulated in a new
+    * Node. The root Node, and every Node subsequently added to the Tree, will be carved out of
+    * the provided NodeArena.
+    *
+    * @note Nodes belonging to an arena-backed Tree have to be removed through
+    * Node::DeleteFromTree(), since they cannot be passed to `delete`.
+    *
+    * @param[in] data                The data to be stored in the root Node.
+    * @param[in] arena               The arena that will own the memory of every Node.
+    */
+   Tree(DataType data, std::unique_ptr<NodeArena> arena)
+       : m_arena{ std::move(arena) },
+         m_root{ m_arena ? m_arena->Create(std::move(data)) : new Node{ std::move(data) } }
+   {
+   }
+
    /**
     * @brief Copy constructor.
+    *
+    * If the other Tree is backed by a NodeArena, then the copy will be backed by an arena of its
+    * own.
+    */
+   Tree(const Tree& other)
+   {
+      if (!other.m_arena)
+      {
+         m_root = Node::CopySubtree(*other.m_root, nullptr);
+         return;
+      }
+
+      // Counting the nodes up front allows all of them to be carved out of a single slab:
+      m_arena = std::make_unique<NodeArena>(other.m_arena->GetNodesPerSlab());
+      m_arena->Reserve(static_cast<std::size_t>(other.Size()));
+
+      m_root = Node::CopySubtree(*other.m_root, m_arena.get());
+   }
+
+   /**
+    * @brief Move constructor. Takes over every Node of the other Tree, along with its NodeArena,
+    * if it has one.
+    *
+    * @note The moved-from Tree is left without a root, after which it may only be assigned to or
+    * destroyed.
     */
-   Tree(const Tree<DataType>& other) : m_root{ new Node{ *other.m_root } }
+   Tree(Tree&& other) noexcept
+       : m_arena{ std::move(other.m_arena) }, m_root{ std::exchange(other.m_root, nullptr) }
    {
    }
 
    /**
-    * @brief Assignment operator.
+    * @brief Assignment operator. Copies or moves, depending on how the argument was constructed.
     */
-   Tree<DataType>& operator=(Tree<DataType> other)
+   Tree& operator=(Tree other) noexcept
    {
       swap(*this, other);
       return *this;
    }
 
+   /**
+    * @brief Creates a deep copy of the Tree, all of whose nodes are carved out of a single slab
+    * of a new NodeArena, in pre-order, regardless of where the nodes of this Tree live.
+    *
+    * The nodes are counted first, after which the copy is made in a single, non-recursive pass,
+    * with only one allocation for all of the nodes, on top of whatever the data itself allocates.
+    * This makes the copy well suited as a snapshot to be read from while this Tree is modified.
+    *
+    * @note Like any other arena-backed Tree, nodes of the copy have to be removed through
+    * Node::DeleteFromTree().
+    *
+    * @returns The copy.
+    */
+   Tree CopyIntoArena() const
+   {
+      auto arena = std::make_unique<NodeArena>();
+      arena->Reserve(static_cast<std::size_t>(Size()));
+
+      Node* const root = Node::CopySubtree(*m_root, arena.get());
+      return Tree{ std::move(arena), root };
+   }
+
    /**
     * @brief Swaps all member variables of the left-hand side with that of the right-hand side.
     */
-   friend void
-   swap(Tree<DataType>& lhs, Tree<DataType>& rhs) noexcept(noexcept(swap(lhs.m_root, rhs.m_root)))
+   friend void swap(Tree& lhs, Tree& rhs) noexcept
    {
       // Enable Argument Dependent Lookup (ADL):
       using std::swap;
 
+      swap(lhs.m_arena, rhs.m_arena);
       swap(lhs.m_root, rhs.m_root);
    }
 
    /**
     * @brief Deletes the root Node, which, in turn, will trigger a deletion of every
     * Node in the Tree.
+    *
+    * If the Tree is backed by a NodeArena, then the nodes aren't unlinked and deleted one at a
+    * time. Instead, only the encapsulated data is destroyed, after which the arena releases all
+    * of its slabs in one go. If the data is trivially destructible, even that is skipped, and the
+    * Tree is dropped without visiting a single Node.
     */
    ~Tree()
    {
-      delete m_root;
+      if (!m_root)
+      {
+         // The nodes were taken over by something else:
+         return;
+      }
+
+      if (!m_arena)
+      {
+         delete m_root;
+         return;
+      }
+
+      if (!std::is_trivially_destructible<DataType>::value)
+      {
+         ForEach<PostOrderTraversal>([](reference node) noexcept { node.m_data.~DataType(); });
+      }
    }
 
    /**
@@ -110,18 +420,99 @@ class Tree
       return m_root;
    }
 
+   /**
+    * @returns A pointer to the NodeArena backing the Tree, if there is one; nullptr otherwise.
+    */
+   inline NodeArena* GetArena() const noexcept
+   {
+      return m_arena.get();
+   }
+
    /**
     * @brief Computes the number of nodes in the Tree.
     *
-    * @complexity Linear in the size of the Tree.
+    * @complexity Linear in the size of the Tree, unless the policy of the Tree tracks subtree
+    * sizes, in which case this is a constant time operation.
     *
     * @returns The total number of nodes in the Tree. This includes leaf and non-leaf nodes,
     * in addition to the root node.
     */
    inline auto Size() const noexcept
    {
-      return std::count_if(
-          std::begin(*this), std::end(*this), [](const auto&) noexcept { return true; });
+      return m_root->CountAllDescendants() + 1;
+   }
+
+   /**
+    * @brief Finds the Node that a pre-order traversal of the Tree would visit at the specified
+    * position.
+    *
+    * @note Requires a policy that tracks subtree sizes.
+    *
+    * @complexity Linear in the depth of the target Node times the number of siblings skipped
+    * along the way, rather than in the size of the Tree.
+    *
+    * @returns The Node at the specified pre-order index, or nullptr if the index is out of range.
+    */
+   Node* GetNodeAtPreOrderIndex(std::size_t index) const noexcept
+   {
+      static_assert(PolicyType::TrackSubtreeSize, "The Tree's policy must track subtree sizes.");
+
+      if (index >= m_root->GetSubtreeSize())
+      {
+         return nullptr;
+      }
+
+      Node* node = m_root;
+      while (index > 0)
+      {
+         // Step past the current node, and then past any children whose subtrees precede the
+         // target:
+         --index;
+
+         Node* child = node->GetFirstChild();
+         while (index >= child->GetSubtreeSize())
+         {
+            index -= child->GetSubtreeSize();
+            child = child->GetNextSibling();
+         }
+
+         node = child;
+      }
+
+      return node;
+   }
+
+   /**
+    * @brief Computes the position at which a pre-order traversal of the Tree would visit the
+    * specified Node.
+    *
+    * @note Requires a policy that tracks subtree sizes.
+    *
+    * @complexity Linear in the depth of the Node times the number of preceding siblings along
+    * the way, rather than in the size of the Tree.
+    *
+    * @returns The zero-indexed pre-order index of the Node.
+    */
+   static std::size_t GetPreOrderIndex(const Node& node) noexcept
+   {
+      static_assert(PolicyType::TrackSubtreeSize, "The Tree's policy must track subtree sizes.");
+
+      std::size_t index{ 0 };
+
+      for (const Node* current = &node; current->GetParent(); current = current->GetParent())
+      {
+         // The parent precedes the current node, as do the subtrees of all preceding siblings:
+         ++index;
+
+         const Node* sibling = current->GetPreviousSibling();
+         while (sibling)
+         {
+            index += sibling->GetSubtreeSize();
+            sibling = sibling->GetPreviousSibling();
+         }
+      }
+
+      return index;
    }
 
    /**
@@ -146,7 +537,7 @@ class Tree
     */
    inline typename Tree::PreOrderIterator beginPreOrder() const noexcept
    {
-      const auto iterator = Tree<DataType>::PreOrderIterator{ m_root };
+      const auto iterator = Tree::PreOrderIterator{ m_root };
       return iterator;
    }
 
@@ -155,7 +546,7 @@ class Tree
     */
    inline typename Tree::PreOrderIterator endPreOrder() const noexcept
    {
-      const auto iterator = Tree<DataType>::PreOrderIterator{ nullptr };
+      const auto iterator = Tree::PreOrderIterator{ nullptr };
       return iterator;
    }
 
@@ -165,7 +556,7 @@ class Tree
     */
    inline typename Tree::PostOrderIterator begin() const noexcept
    {
-      const auto iterator = Tree<DataType>::PostOrderIterator{ m_root };
+      const auto iterator = Tree::PostOrderIterator{ m_root };
       return iterator;
    }
 
@@ -174,7 +565,7 @@ class Tree
     */
    inline typename Tree::PostOrderIterator end() const noexcept
    {
-      const auto iterator = Tree<DataType>::PostOrderIterator{ nullptr };
+      const auto iterator = Tree::PostOrderIterator{ nullptr };
       return iterator;
    }
 
@@ -184,7 +575,7 @@ class Tree
     */
    inline typename Tree::LeafIterator beginLeaf() const noexcept
    {
-      const auto iterator = Tree<DataType>::LeafIterator{ m_root };
+      const auto iterator = Tree::LeafIterator{ m_root };
       return iterator;
    }
 
@@ -193,129 +584,426 @@ class Tree
     */
    inline typename Tree::LeafIterator endLeaf() const noexcept
    {
-      const auto iterator = Tree<DataType>::LeafIterator{ nullptr };
+      const auto iterator = Tree::LeafIterator{ nullptr };
       return iterator;
    }
 
- private:
-   Node* m_root{ nullptr };
-};
-
-/**
- * The Node class represents the nodes that make up the Tree.
- *
- * Each node has a pointer to its parent, its first and last child, its previous and next
- * sibling, and, of course, to the data it encapsulates.
- */
-template <typename DataType>
-class Tree<DataType>::Node
-{
- public:
-   // Typedefs needed for STL compliance:
-   using value_type = DataType;
-   using reference = DataType&;
-   using const_reference = const DataType&;
-
    /**
-    * @brief Node default constructs a new Node. All outgoing links from this new node will
-    * initialized to a nullptr.
+    * @returns A level-order iterator that will visit every Node in the Tree, depth by depth,
+    * starting with the root of the Tree.
     */
-   constexpr Node() noexcept = default;
+   inline typename Tree::LevelOrderIterator beginLevelOrder() const
+   {
+      return Tree::LevelOrderIterator{ m_root };
+   }
 
    /**
-    * @brief Node constructs a new Node encapsulating the specified data. All outgoing links
-    * from the node will be initialized to nullptr.
+    * @returns A LevelOrderIterator that points past the last Node in the Tree.
     */
-   Node(DataType data) : m_data{ std::move(data) }
+   inline typename Tree::LevelOrderIterator endLevelOrder() const noexcept
    {
+      return Tree::LevelOrderIterator{};
    }
 
    /**
-    * @brief Node performs a copy-construction of the specified Node.
+    * @brief Creates an immutable, compact snapshot of the Tree.
     *
-    * The nodes in the Node are deep-copied, while the data contained in the tree is
-    * shallow-copied.
+    * @complexity Linear in the size of the Tree.
+    *
+    * @returns A FrozenTree containing a copy of all data in the Tree.
     */
-   Node(const Node& other) : m_data{ other.m_data }
+   FrozenTree<DataType> Freeze() const
    {
-      Copy(other, *this);
+      return FrozenTree<DataType>{ *this };
    }
 
    /**
-    * @brief Destroys the Node and all Nodes under it.
+    * @brief Visits every Node in the subtree rooted at the specified node, in the order of the
+    * specified traversal.
+    *
+    * Where an iterator has to work out where it left off on every increment, and has to check
+    * whether it has run past the end of its subtree, ForEach(...) drives the entire traversal
+    * from a single loop. This lets the compiler keep the traversal in registers and inline the
+    * visitor into the loop, which makes it the fastest way to visit a whole subtree.
+    *
+    * @complexity Linear in the size of the subtree.
+    *
+    * @tparam TraversalType          One of PreOrderTraversal, PostOrderTraversal,
+    *                                LevelOrderTraversal, or LeafTraversal.
+    *
+    * @param[in] node                The root of the subtree to visit.
+    * @param[in] visitor             The callable object to be invoked on every visited Node.
     */
-   ~Node()
+   template <typename TraversalType, typename VisitorType>
+   static void ForEach(Node& node, VisitorType&& visitor)
    {
-      DetachFromTree();
-
-      if (m_childCount == 0)
-      {
-         m_parent = nullptr;
-         m_firstChild = nullptr;
-         m_lastChild = nullptr;
-         m_previousSibling = nullptr;
-         m_nextSibling = nullptr;
-
-         return;
-      }
-
-      assert(m_firstChild && m_lastChild);
-
-      Node* childNode = m_firstChild;
-      Node* nextNode = nullptr;
-
-      while (childNode != nullptr)
-      {
-         nextNode = childNode->m_nextSibling;
-         delete childNode;
-         childNode = nextNode;
-      }
-
-      m_parent = nullptr;
-      m_firstChild = nullptr;
-      m_lastChild = nullptr;
-      m_previousSibling = nullptr;
-      m_nextSibling = nullptr;
+      TraversalType::ForEach(node, visitor);
    }
 
    /**
-    * @brief Assignment operator.
+    * @overload
     */
-   Node& operator=(Node other)
+   template <typename TraversalType, typename VisitorType>
+   static void ForEach(const Node& node, VisitorType&& visitor)
    {
-      swap(*this, other);
-      return *this;
+      TraversalType::ForEach(node, visitor);
    }
 
    /**
-    * @returns True if the data encapsulated in the left-hand side Node is less than
-    * the data encapsulated in the right-hand side Node.
+    * @brief Visits every Node in the Tree, in the order of the specified traversal.
     */
-   friend auto operator<(const Node& lhs, const Node& rhs)
+   template <typename TraversalType, typename VisitorType>
+   void ForEach(VisitorType&& visitor) const
    {
-      return lhs.GetData() < rhs.GetData();
+      TraversalType::ForEach(*m_root, visitor);
    }
 
    /**
-    * @returns True if the data encapsulated in the left-hand side Node is less than
-    * or equal to the data encapsulated in the right-hand side Node.
+    * @brief Relocates every Node in the Tree into a single, contiguous block of memory, laid out
+    * in the order in which the specified traversal would visit them.
+    *
+    * Traversals over a Tree that was built up over time tend to be dominated by cache misses,
+    * since consecutive nodes can end up anywhere on the heap. Once relocated, a traversal of the
+    * chosen type will instead walk through memory sequentially, and Node::GetIndex() will return
+    * each node's position in that traversal.
+    *
+    * Any nodes that the traversal doesn't visit (as is the case with the non-leaf nodes in a
+    * LeafTraversal) are placed after all visited nodes, in post-order.
+    *
+    * @note After relocation, the Tree will be backed by a NodeArena, and all pointers and
+    * iterators into the Tree will have been invalidated.
+    *
+    * @complexity Linear in the size of the Tree.
+    *
+    * @tparam TraversalType          One of PreOrderTraversal, PostOrderTraversal,
+    *                                LevelOrderTraversal, or LeafTraversal.
     */
-   friend auto operator<=(const Node& lhs, const Node& rhs)
+   template <typename TraversalType>
+   void OptimizeMemoryLayoutFor()
    {
-      return !(lhs > rhs);
+      const auto nodeCount = static_cast<std::size_t>(Size());
+
+      std::vector<Node*> layout;
+      layout.reserve(nodeCount);
+
+      ForEach<TraversalType>([&](reference node) { layout.emplace_back(&node); });
+
+      if (layout.size() < nodeCount)
+      {
+         ForEach<PostOrderTraversal>([&](reference node) {
+            if (node.HasChildren())
+            {
+               layout.emplace_back(&node);
+            }
+         });
+      }
+
+      assert(layout.size() == nodeCount);
+
+      Relocate(layout);
    }
 
+ private:
    /**
-    * @returns True if the data encapsulated in the left-hand side Node is greater than
-    * the data encapsulated in the right-hand side Node.
+    * @brief Assembles a Tree out of an existing root Node and the NodeArena it lives in.
     */
-   friend auto operator>(const Node& lhs, const Node& rhs)
+   Tree(std::unique_ptr<NodeArena> arena, Node* root) noexcept
+       : m_arena{ std::move(arena) }, m_root{ root }
    {
-      return rhs < lhs;
    }
 
    /**
-    * @returns True if the data encapsulated in the left-hand side Node is greater than
+    * @brief Moves the specified nodes into a fresh NodeArena, such that they occupy consecutive
+    * slots in the given order, and then releases the original nodes.
+    *
+    * @param[in] layout              Every node in the Tree, in the desired memory order.
+    */
+   void Relocate(const std::vector<Node*>& layout)
+   {
+      const auto nodesPerSlab =
+          m_arena ? m_arena->GetNodesPerSlab() : NodeArena::DEFAULT_NODES_PER_SLAB;
+
+      auto arena = std::make_unique<NodeArena>(nodesPerSlab);
+      arena->Reserve(layout.size());
+
+      // Move the data into the new nodes, and carry over the links as they are. These links will
+      // still point at the original nodes for the time being:
+      for (auto* const original : layout)
+      {
+         auto* const relocated = arena->Create(std::move(original->m_data));
+
+         relocated->m_parent = original->m_parent;
+         relocated->m_firstChild = original->m_firstChild;
+         relocated->m_lastChild = original->m_lastChild;
+         relocated->m_previousSibling = original->m_previousSibling;
+         relocated->m_nextSibling = original->m_nextSibling;
+         relocated->m_childCount = original->m_childCount;
+
+         static_cast<typename Node::BookkeepingType&>(*relocated) =
+             static_cast<const typename Node::BookkeepingType&>(*original);
+
+         // Now that its links have been copied, the original's parent pointer can serve as a
+         // forwarding address to its relocated counterpart:
+         original->m_parent = relocated;
+      }
+
+      const auto forward = [](Node*& link) noexcept {
+         if (link)
+         {
+            link = link->m_parent;
+         }
+      };
+
+      for (auto* const original : layout)
+      {
+         auto* const relocated = original->m_parent;
+
+         forward(relocated->m_parent);
+         forward(relocated->m_firstChild);
+         forward(relocated->m_lastChild);
+         forward(relocated->m_previousSibling);
+         forward(relocated->m_nextSibling);
+      }
+
+      auto* const newRoot = m_root->m_parent;
+
+      // Release the original nodes, taking care not to trigger the recursive deletion of the
+      // (now stale) child links:
+      for (auto* const original : layout)
+      {
+         if (original->m_arena)
+         {
+            original->m_data.~DataType();
+            continue;
+         }
+
+         original->m_parent = nullptr;
+         original->m_firstChild = nullptr;
+         original->m_lastChild = nullptr;
+         original->m_previousSibling = nullptr;
+         original->m_nextSibling = nullptr;
+         original->m_childCount = 0;
+
+         delete original;
+      }
+
+      m_arena = std::move(arena);
+      m_root = newRoot;
+   }
+
+   std::unique_ptr<NodeArena> m_arena{ nullptr };
+
+   Node* m_root{ nullptr };
+};
+
+/**
+ * The Node class represents the nodes that make up the Tree.
+ *
+ * Each node has a pointer to its parent, its first and last child, its previous and next
+ * sibling, and, of course, to the data it encapsulates. Depending on the policy of the Tree, each
+ * node may also cache the size and leaf count of the subtree rooted at it, and carry a visitation
+ * flag.
+ */
+template <typename DataType, typename PolicyType>
+class Tree<DataType, PolicyType>::Node
+    : public TreeInternals::VisitationFlag<
+          PolicyType::TrackVisitation,
+          TreeInternals::SubtreeCounts<PolicyType::TrackSubtreeSize, PolicyType::TrackLeafCount>>
+{
+   friend class Tree;
+   friend class Tree::NodeArena;
+
+   using SubtreeCountsType =
+       TreeInternals::SubtreeCounts<PolicyType::TrackSubtreeSize, PolicyType::TrackLeafCount>;
+
+   using BookkeepingType =
+       TreeInternals::VisitationFlag<PolicyType::TrackVisitation, SubtreeCountsType>;
+
+ public:
+   // Typedefs needed for STL compliance:
+   using value_type = DataType;
+   using reference = DataType&;
+   using const_reference = const DataType&;
+
+   static constexpr std::size_t INVALID_INDEX{ std::numeric_limits<std::size_t>::max() };
+
+   /**
+    * @brief Node default constructs a new Node. All outgoing links from this new node will
+    * initialized to a nullptr.
+    */
+   constexpr Node() noexcept = default;
+
+   /**
+    * @brief Node constructs a new Node encapsulating the specified data. All outgoing links
+    * from the node will be initialized to nullptr.
+    */
+   Node(DataType data) : m_data{ std::move(data) }
+   {
+   }
+
+   /**
+    * @brief Node performs a copy-construction of the specified Node.
+    *
+    * The nodes in the Node are deep-copied, while the data contained in the tree is
+    * shallow-copied.
+    */
+   Node(const Node& other) : m_data{ other.m_data }
+   {
+      Copy(other, *this);
+   }
+
+   /**
+    * @brief Node performs a move-construction of the specified Node.
+    *
+    * The new Node takes over both the data and the children of the other Node, without copying
+    * any of the descendants; the children keep living wherever they were allocated. The other
+    * Node stays where it is in its Tree, as a leaf holding moved-from data.
+    */
+   Node(Node&& other) noexcept(std::is_nothrow_move_constructible<DataType>::value)
+       : m_data{ std::move(other.m_data) }
+   {
+      if (!other.m_firstChild)
+      {
+         return;
+      }
+
+      const auto sizeDelta = static_cast<std::ptrdiff_t>(other.TrackedSubtreeSize()) - 1;
+      const auto leafDelta = static_cast<std::ptrdiff_t>(other.TrackedLeafCount());
+
+      m_firstChild = std::exchange(other.m_firstChild, nullptr);
+      m_lastChild = std::exchange(other.m_lastChild, nullptr);
+      m_childCount = std::exchange(other.m_childCount, 0);
+
+      for (Node* child = m_firstChild; child; child = child->m_nextSibling)
+      {
+         child->m_parent = this;
+      }
+
+      static_cast<SubtreeCountsType&>(*this) = static_cast<const SubtreeCountsType&>(other);
+
+      // Having lost all its children, the other Node becomes a leaf itself:
+      other.PropagateSubtreeCounts(-sizeDelta, 1 - leafDelta);
+   }
+
+   /**
+    * @brief Destroys the Node and all Nodes under it.
+    *
+    * The descendants are destroyed without recursion, so even a Tree that degenerates into a
+    * single, arbitrarily long chain can be torn down without running out of stack space.
+    */
+   ~Node()
+   {
+      DetachFromTree();
+
+      if (m_childCount > 0)
+      {
+         assert(m_firstChild && m_lastChild);
+         DestroyDescendants();
+      }
+
+      m_parent = nullptr;
+      m_firstChild = nullptr;
+      m_lastChild = nullptr;
+      m_previousSibling = nullptr;
+      m_nextSibling = nullptr;
+   }
+
+   /**
+    * @brief Copy assignment operator. Replaces the data and the descendants of this Node with
+    * copies of those of the other Node, while the Node itself keeps its place in its Tree.
+    *
+    * The copies are made before anything is replaced, so the other Node may even be one of the
+    * descendants of this Node.
+    */
+   Node& operator=(const Node& other)
+   {
+      if (this == &other)
+      {
+         return *this;
+      }
+
+      DataType data = other.m_data;
+
+      std::vector<Node*> children;
+      children.reserve(other.m_childCount);
+
+      try
+      {
+         for (Node* child = other.m_firstChild; child; child = child->m_nextSibling)
+         {
+            children.emplace_back(CopySubtree(*child, m_arena));
+         }
+      }
+      catch (...)
+      {
+         std::for_each(std::begin(children), std::end(children), DestroyNode);
+         throw;
+      }
+
+      DestroyChildren();
+      m_data = std::move(data);
+
+      for (Node* const child : children)
+      {
+         AppendChild(*child);
+      }
+
+      return *this;
+   }
+
+   /**
+    * @brief Move assignment operator. Replaces the data and the descendants of this Node with
+    * those of the other Node, which are taken over without copying. The Node itself keeps its
+    * place in its Tree, while the other Node is left behind as a leaf holding moved-from data.
+    *
+    * @note Both nodes have to store their nodes in the same way: either on the heap, or in the
+    * same NodeArena. Neither Node may be a descendant of the other.
+    */
+   Node& operator=(Node&& other) noexcept(std::is_nothrow_move_assignable<DataType>::value)
+   {
+      if (this == &other)
+      {
+         return *this;
+      }
+
+      assert(!IsWithinSubtreeOf(other) && !other.IsWithinSubtreeOf(*this));
+
+      DestroyChildren();
+      m_data = std::move(other.m_data);
+      SpliceChildren(other);
+
+      return *this;
+   }
+
+   /**
+    * @returns True if the data encapsulated in the left-hand side Node is less than
+    * the data encapsulated in the right-hand side Node.
+    */
+   friend auto operator<(const Node& lhs, const Node& rhs)
+   {
+      return lhs.GetData() < rhs.GetData();
+   }
+
+   /**
+    * @returns True if the data encapsulated in the left-hand side Node is less than
+    * or equal to the data encapsulated in the right-hand side Node.
+    */
+   friend auto operator<=(const Node& lhs, const Node& rhs)
+   {
+      return !(lhs > rhs);
+   }
+
+   /**
+    * @returns True if the data encapsulated in the left-hand side Node is greater than
+    * the data encapsulated in the right-hand side Node.
+    */
+   friend auto operator>(const Node& lhs, const Node& rhs)
+   {
+      return rhs < lhs;
+   }
+
+   /**
+    * @returns True if the data encapsulated in the left-hand side Node is greater than
     * or equal to the data encapsulated in the right-hand side Node.
     */
    friend auto operator>=(const Node& lhs, const Node& rhs)
@@ -354,17 +1042,20 @@ class Tree<DataType>::Node
       swap(lhs.m_lastChild, rhs.m_lastChild);
       swap(lhs.m_previousSibling, rhs.m_previousSibling);
       swap(lhs.m_nextSibling, rhs.m_nextSibling);
+      swap(lhs.m_arena, rhs.m_arena);
+      swap(static_cast<BookkeepingType&>(lhs), static_cast<BookkeepingType&>(rhs));
       swap(lhs.m_data, rhs.m_data);
       swap(lhs.m_childCount, rhs.m_childCount);
-      swap(lhs.m_visited, rhs.m_visited);
    }
 
    /**
     * @brief Detaches and then deletes the Node from the Tree it's part of.
+    *
+    * @note If the Node was carved out of a NodeArena, its memory is handed back to that arena.
     */
    inline void DeleteFromTree() noexcept
    {
-      delete this;
+      DestroyNode(this);
    }
 
    /**
@@ -383,24 +1074,6 @@ class Tree<DataType>::Node
       return &m_data;
    }
 
-   /**
-    * @brief MarkVisited sets node visitation status.
-    *
-    * @param[in] visited             Whether the node should be marked as having been visited.
-    */
-   inline void MarkVisited(const bool visited = true) noexcept
-   {
-      m_visited = visited;
-   }
-
-   /**
-    * @returns True if the node has been marked as visited.
-    */
-   inline constexpr bool HasBeenVisited() const noexcept
-   {
-      return m_visited;
-   }
-
    /**
     * @brief PrependChild will prepend the specified Node as the first child of the Node.
     *
@@ -410,6 +1083,8 @@ class Tree<DataType>::Node
     */
    inline Node* PrependChild(Node& child) noexcept
    {
+      assert(child.m_arena == m_arena);
+
       child.m_parent = this;
 
       if (!m_firstChild)
@@ -425,6 +1100,8 @@ class Tree<DataType>::Node
 
       m_childCount++;
 
+      UpdateCountsAfterAttaching(child, /* wasLeaf = */ false);
+
       return m_firstChild;
    }
 
@@ -438,7 +1115,7 @@ class Tree<DataType>::Node
     */
    inline Node* PrependChild(const DataType& data)
    {
-      const auto* newNode = new Node(data);
+      auto* const newNode = CreateNode(data);
       return PrependChild(*newNode);
    }
 
@@ -447,7 +1124,7 @@ class Tree<DataType>::Node
     */
    inline Node* PrependChild(DataType&& data)
    {
-      auto* const newNode = new Node(std::move(data));
+      auto* const newNode = CreateNode(std::move(data));
       return PrependChild(*newNode);
    }
 
@@ -460,6 +1137,8 @@ class Tree<DataType>::Node
     */
    inline Node* AppendChild(Node& child) noexcept
    {
+      assert(child.m_arena == m_arena);
+
       child.m_parent = this;
 
       if (!m_lastChild)
@@ -475,6 +1154,8 @@ class Tree<DataType>::Node
 
       m_childCount++;
 
+      UpdateCountsAfterAttaching(child, /* wasLeaf = */ false);
+
       return m_lastChild;
    }
 
@@ -487,7 +1168,7 @@ class Tree<DataType>::Node
     */
    inline Node* AppendChild(const DataType& data)
    {
-      auto* const newNode = new Node(data);
+      auto* const newNode = CreateNode(data);
       return AppendChild(*newNode);
    }
 
@@ -496,65 +1177,303 @@ class Tree<DataType>::Node
     */
    inline Node* AppendChild(DataType&& data)
    {
-      auto* const newNode = new Node(std::move(data));
+      auto* const newNode = CreateNode(std::move(data));
       return AppendChild(*newNode);
    }
 
    /**
-    * @returns The underlying data stored in the Node.
+    * @brief AppendChildConcurrently will construct and append a new Node as the last child of
+    * the Node, and is safe to call from multiple threads at once.
+    *
+    * Instead of a single lock for the whole Tree, each parent is guarded by one of a fixed set
+    * of lock stripes, selected by the address of the parent. Threads that append children to
+    * different parents will therefore rarely have to wait on one another. Carving the new Node
+    * out of a NodeArena is synchronized separately, and only for as long as it takes to claim a
+    * slot.
+    *
+    * @note Calls to this function are only synchronized with one another. No other operation
+    * may modify or read the affected parts of the Tree while such calls might be in flight.
+    *
+    * @param[in] data                The underlying data to be stored in the new Node.
+    *
+    * @returns The newly appended Node.
     */
-   inline DataType& GetData() noexcept
+   inline Node* AppendChildConcurrently(const DataType& data)
    {
-      return m_data;
+      auto* const newNode = CreateNodeConcurrently(data);
+      return AttachConcurrently(*newNode);
    }
 
    /**
     * @overload
     */
-   inline const DataType& GetData() const noexcept
+   inline Node* AppendChildConcurrently(DataType&& data)
    {
-      return m_data;
+      auto* const newNode = CreateNodeConcurrently(std::move(data));
+      return AttachConcurrently(*newNode);
    }
 
    /**
-    * @returns A pointer to the Node's parent, if it exists; nullptr otherwise.
+    * @brief Appends a Node that isn't yet part of any Tree as the last child of this Node, and is
+    * safe to call from multiple threads at once, just like the overloads that construct the Node.
+    *
+    * This allows a Node to be built up, possibly along with its own children, before it is known
+    * whether it should be part of the Tree at all, as well as for a batch of nodes to be created
+    * with NodeArena::CreateConcurrently(...) up front.
+    *
+    * @param[in] child               The Node to be appended, which must live wherever the other
+    *                                nodes in this Tree live.
+    *
+    * @returns The appended Node.
     */
-   inline constexpr Node* GetParent() const
+   inline Node* AppendChildConcurrently(Node& child) noexcept
    {
-      return m_parent;
+      assert(!child.m_parent && child.m_arena == m_arena);
+      return AttachConcurrently(child);
    }
 
    /**
-    * @returns A pointer to the Node's first child.
+    * @brief AppendChildren will construct a new Node from every element in the specified range,
+    * and append all of them, in order, as the last children of the Node.
+    *
+    * The new nodes are first linked up amongst themselves, and then attached in a single step,
+    * which means that cached subtree counts are only updated once for the whole batch. If this
+    * Node was carved out of a NodeArena, and the size of the range is known up front, the new
+    * nodes will also occupy consecutive slots. Should the construction of any Node throw, none of
+    * the new nodes will have been attached.
+    *
+    * @param[in] first               The first element of the range.
+    * @param[in] last                One past the last element of the range.
+    *
+    * @returns The first of the newly appended nodes, or nullptr if the range was empty.
     */
-   inline constexpr Node* GetFirstChild() const
+   template <typename InputIteratorType>
+   Node* AppendChildren(InputIteratorType first, InputIteratorType last)
    {
-      return m_firstChild;
-   }
+      if (m_arena)
+      {
+         ReserveSlots(
+             first,
+             last,
+             typename std::iterator_traits<InputIteratorType>::iterator_category{});
+      }
 
-   /**
-    * @returns A pointer to the Node's last child.
-    */
-   inline constexpr Node* GetLastChild() const
-   {
-      return m_lastChild;
+      Node* head = nullptr;
+      Node* tail = nullptr;
+      unsigned int count{ 0 };
+
+      try
+      {
+         for (; first != last; ++first)
+         {
+            auto* const newNode = m_arena ? m_arena->CreateContiguously(*first) : new Node(*first);
+
+            newNode->m_parent = this;
+            newNode->m_previousSibling = tail;
+
+            if (tail)
+            {
+               tail->m_nextSibling = newNode;
+            }
+            else
+            {
+               head = newNode;
+            }
+
+            tail = newNode;
+            ++count;
+         }
+      }
+      catch (...)
+      {
+         while (head)
+         {
+            auto* const next = head->m_nextSibling;
+            head->m_parent = nullptr;
+            DestroyNode(head);
+            head = next;
+         }
+
+         throw;
+      }
+
+      if (!head)
+      {
+         return nullptr;
+      }
+
+      // Every new Node is a leaf, and so counts as a subtree of one node, with one leaf:
+      const auto sizeDelta = PolicyType::TrackSubtreeSize ? static_cast<std::ptrdiff_t>(count) : 0;
+      return AttachSiblings(*head, *tail, count, sizeDelta, sizeDelta);
    }
 
    /**
-    * @returns A pointer to the Node's next sibling.
+    * @overload
+    *
+    * @param[in] range               Any range that std::begin(...) and std::end(...) accept.
     */
-   inline constexpr Node* GetNextSibling() const
+   template <typename RangeType>
+   Node* AppendChildren(const RangeType& range)
    {
-      return m_nextSibling;
+      using std::begin;
+      using std::end;
+
+      return AppendChildren(begin(range), end(range));
    }
 
    /**
-    * @returns A pointer to the Node's previous sibling.
+    * @brief SpliceChildren will move all children of the specified Node, along with their
+    * subtrees, to the end of the list of children of this Node. Nothing is copied; the children
+    * are unlinked from their old parent, and relinked to this Node, as a whole.
+    *
+    * The source may belong to another Tree, as long as both trees store their nodes in the same
+    * way: either both on the heap, or in the same NodeArena.
+    *
+    * @note This Node may not be part of the subtree rooted at the source.
+    *
+    * @complexity Linear in the number of children moved, since each child's parent link has to
+    * be updated, but independent of the size of their subtrees. If the Tree tracks subtree
+    * counts, the ancestors of either Node have to be updated as well.
+    *
+    * @param[in] source              The Node whose children are to be moved.
+    *
+    * @returns The first of the moved children, or nullptr if the source had no children.
     */
-   inline constexpr Node* GetPreviousSibling() const
+   Node* SpliceChildren(Node& source) noexcept
    {
-      return m_previousSibling;
-   }
+      assert(source.m_arena == m_arena);
+      assert(!IsWithinSubtreeOf(source) || &source == this);
+
+      if (&source == this || !source.m_firstChild)
+      {
+         return nullptr;
+      }
+
+      Node* const head = source.m_firstChild;
+      Node* const tail = source.m_lastChild;
+      const auto count = source.m_childCount;
+
+      const auto sizeDelta = static_cast<std::ptrdiff_t>(source.TrackedSubtreeSize()) - 1;
+      const auto leafDelta = static_cast<std::ptrdiff_t>(source.TrackedLeafCount());
+
+      source.m_firstChild = nullptr;
+      source.m_lastChild = nullptr;
+      source.m_childCount = 0;
+
+      // Having lost all its children, the source becomes a leaf itself:
+      source.PropagateSubtreeCounts(-sizeDelta, 1 - leafDelta);
+
+      for (Node* child = head; child; child = child->m_nextSibling)
+      {
+         child->m_parent = this;
+      }
+
+      return AttachSiblings(*head, *tail, count, sizeDelta, leafDelta);
+   }
+
+   /**
+    * @brief GraftSubtree will detach the specified Node, along with its subtree, from wherever it
+    * currently resides, and append it as the last child of this Node, without copying anything.
+    *
+    * The Node may belong to another Tree, as long as both trees store their nodes in the same
+    * way: either both on the heap, or in the same NodeArena.
+    *
+    * @note The Node may not be the root of a Tree, nor may this Node be part of its subtree. To
+    * graft the entirety of another Tree, use GraftSubtree(Tree&&) instead.
+    *
+    * @complexity Constant, unless the Tree tracks subtree counts, in which case the ancestors of
+    * both the old and the new parent have to be updated.
+    *
+    * @param[in] root                The root of the subtree to be moved.
+    *
+    * @returns The grafted Node.
+    */
+   Node* GraftSubtree(Node& root) noexcept
+   {
+      assert(root.m_arena == m_arena);
+      assert(!IsWithinSubtreeOf(root));
+
+      root.DetachFromTree();
+      return AppendChild(root);
+   }
+
+   /**
+    * @brief GraftSubtree will take over every Node of the specified Tree, and append the root of
+    * that Tree as the last child of this Node, without copying anything.
+    *
+    * @note Only trees whose nodes are allocated on the heap can be grafted onto one another,
+    * since the slabs of a NodeArena can't change hands. The other Tree is left without a root,
+    * after which the only thing that may be done with it is to destroy it.
+    *
+    * @param[in] tree                The Tree to be consumed.
+    *
+    * @returns The former root of the other Tree.
+    */
+   Node* GraftSubtree(Tree&& tree) noexcept
+   {
+      assert(!m_arena && !tree.m_arena && tree.m_root);
+
+      Node* const root = tree.m_root;
+      tree.m_root = nullptr;
+
+      return AppendChild(*root);
+   }
+
+   /**
+    * @returns The underlying data stored in the Node.
+    */
+   inline DataType& GetData() noexcept
+   {
+      return m_data;
+   }
+
+   /**
+    * @overload
+    */
+   inline const DataType& GetData() const noexcept
+   {
+      return m_data;
+   }
+
+   /**
+    * @returns A pointer to the Node's parent, if it exists; nullptr otherwise.
+    */
+   inline constexpr Node* GetParent() const
+   {
+      return m_parent;
+   }
+
+   /**
+    * @returns A pointer to the Node's first child.
+    */
+   inline constexpr Node* GetFirstChild() const
+   {
+      return m_firstChild;
+   }
+
+   /**
+    * @returns A pointer to the Node's last child.
+    */
+   inline constexpr Node* GetLastChild() const
+   {
+      return m_lastChild;
+   }
+
+   /**
+    * @returns A pointer to the Node's next sibling.
+    */
+   inline constexpr Node* GetNextSibling() const
+   {
+      return m_nextSibling;
+   }
+
+   /**
+    * @returns A pointer to the Node's previous sibling.
+    */
+   inline constexpr Node* GetPreviousSibling() const
+   {
+      return m_previousSibling;
+   }
 
    /**
     * @returns True if this node has direct descendants.
@@ -575,153 +1494,317 @@ class Tree<DataType>::Node
    }
 
    /**
-    * @returns The total number of descendant nodes belonging to the node.
+    * @returns The position of the Node within the storage of the NodeArena that it was carved
+    * out of. After a call to Tree::OptimizeMemoryLayoutFor(...), this index reflects the order in
+    * which the chosen traversal visits the Node.
+    *
+    * @note Heap allocated Nodes don't have such a position, and will return INVALID_INDEX.
+    *
+    * @complexity Linear in the number of slabs owned by the NodeArena.
     */
-   inline auto CountAllDescendants() noexcept
+   inline std::size_t GetIndex() const noexcept
    {
-      const auto nodeCount = std::count_if(
-          Tree<DataType>::PostOrderIterator(this),
-          Tree<DataType>::PostOrderIterator(),
-          [](const auto&) noexcept { return true; });
+      return m_arena ? m_arena->IndexOf(this) : INVALID_INDEX;
+   }
 
-      return nodeCount - 1;
+   /**
+    * @complexity Linear in the number of descendants, unless the policy of the Tree tracks
+    * subtree sizes, in which case this is a constant time operation.
+    *
+    * @returns The total number of descendant nodes belonging to the node.
+    */
+   inline auto CountAllDescendants() const noexcept
+   {
+      return CountAllDescendants(std::integral_constant<bool, PolicyType::TrackSubtreeSize>{});
    }
 
    /**
-    * @brief SortChildren performs a merge sort of the direct descendants nodes.
+    * @brief SortChildren performs a stable sort of the direct descendants of the Node.
+    *
+    * Rather than sorting the linked-list of siblings in place, which chases pointers all over
+    * memory, the children are first gathered into a contiguous buffer, which is then sorted, after
+    * which the siblings are relinked in a single pass. The buffer is kept around, per thread, for
+    * the next call to reuse.
+    *
+    * @note Should the comparator or the sort function throw, the order of the children is left
+    * untouched.
     *
     * @param[in] comparator          A callable type to be used as the basis for the sorting
     *                                comparison. This type should be equivalent to:
     *                                   bool comparator(const Node& lhs, const Node& rhs);
+    * @param[in] sortFunction        A callable type that sorts the gathered children, and which
+    *                                should be equivalent to:
+    *                                   void sort(Iterator first, Iterator last, Compare compare);
+    *                                where the iterators refer to Node pointers. It must sort stably
+    *                                for the sort as a whole to be stable.
     */
-   template <typename ComparatorType>
-   void SortChildren(const ComparatorType& comparator) noexcept(noexcept(comparator))
+   template <typename ComparatorType, typename SortFunctionType = TreeInternals::StableSort>
+   void SortChildren(const ComparatorType& comparator, const SortFunctionType& sortFunction = {})
    {
-      if (!m_firstChild)
+      if (m_childCount < 2)
       {
          return;
       }
 
-      Node* head = MergeSort(m_firstChild, comparator);
+      thread_local std::vector<Node*> scratchBuffer;
 
-      // @todo Set first and last child in constant time.
-      if (head->m_parent)
+      // Taking over the buffer, instead of using it in place, keeps a comparator that itself sorts
+      // the children of some other Node from clobbering it:
+      std::vector<Node*> children;
+      children.swap(scratchBuffer);
+
+      try
       {
-         head->m_parent->m_firstChild = head;
+         children.clear();
+         children.reserve(m_childCount);
 
-         Node* temp = head;
-         while (temp->m_nextSibling)
+         for (Node* child = m_firstChild; child; child = child->m_nextSibling)
          {
-            temp = temp->m_nextSibling;
+            children.emplace_back(child);
          }
 
-         head->m_parent->m_lastChild = temp;
+         sortFunction(
+             std::begin(children),
+             std::end(children),
+             [&comparator](const Node* lhs, const Node* rhs) { return comparator(*lhs, *rhs); });
+      }
+      catch (...)
+      {
+         children.swap(scratchBuffer);
+         throw;
       }
+
+      RelinkChildren(children);
+      children.swap(scratchBuffer);
    }
 
  private:
+   /**
+    * @overload
+    */
+   auto CountAllDescendants(std::true_type) const noexcept
+   {
+      return static_cast<std::ptrdiff_t>(this->m_subtreeSize) - 1;
+   }
 
    /**
-    * @brief Splits the linked-list of sibling nodes in two.
-    *
-    * @returns The head of the second list.
+    * @overload
     */
-   Node* Split(Node* head)
+   auto CountAllDescendants(std::false_type) const noexcept
    {
-      Node* hare = head;
-      Node* tortoise = head;
+      const auto nodeCount = std::count_if(
+          Tree::PostOrderIterator(this),
+          Tree::PostOrderIterator(),
+          [](const auto&) noexcept { return true; });
+
+      return nodeCount - 1;
+   }
 
-      while (hare->m_nextSibling && hare->m_nextSibling->m_nextSibling)
+   /**
+    * @brief Adds the specified deltas to the cached subtree counts of this Node and of all its
+    * ancestors.
+    */
+   void PropagateSubtreeCounts(std::ptrdiff_t sizeDelta, std::ptrdiff_t leafDelta) noexcept
+   {
+      if (!PolicyType::TrackSubtreeSize)
       {
-         hare = hare->m_nextSibling->m_nextSibling;
-         tortoise = tortoise->m_nextSibling;
+         return;
       }
 
-      Node* secondHead = tortoise->m_nextSibling;
-      tortoise->m_nextSibling = nullptr;
-
-      return secondHead;
+      for (Node* node = this; node; node = node->m_parent)
+      {
+         node->AdjustSubtreeCounts(sizeDelta, leafDelta);
+      }
    }
 
    /**
-    * @brief MergeSort is the main entry point into the merge sort implementation.
-    *
-    * @todo A recursive solution may run out of stack space!
+    * @brief Accounts for the subtree rooted at the specified child, which was just attached to
+    * this Node.
     *
-    * @param[in] list                The first Node in the list to be sorted.
-    * @param[in] comparator          The comparator function to be called to figure out which node
-    *                                is the lesser of the two.
+    * @param[in] child               The newly attached child.
+    * @param[in] wasLeaf             Whether this Node was a leaf before the child was attached.
     */
-   template <typename ComparatorType>
-   Node* MergeSort(Node*& head, const ComparatorType& comparator) noexcept(noexcept(comparator))
+   void UpdateCountsAfterAttaching(const Node& child, bool wasLeaf) noexcept
    {
-      if (!head || !head->m_nextSibling)
-      {
-         return head;
-      }
+      const auto childSize = static_cast<std::ptrdiff_t>(child.TrackedSubtreeSize());
+      const auto childLeaves = static_cast<std::ptrdiff_t>(child.TrackedLeafCount());
 
-      Node* second = Split(head);
-
-      head = MergeSort(head, comparator);
-      second = MergeSort(second, comparator);
- 
-      return MergeSortedHalves(head, second, comparator);
+      // A leaf that gains a child no longer counts as a leaf itself:
+      PropagateSubtreeCounts(childSize, wasLeaf ? childLeaves - 1 : childLeaves);
    }
 
    /**
-    * @brief MergeSortedHalves is a helper function that will merge the sorted halves.
+    * @brief Appends an already linked chain of siblings, whose parent links already point at
+    * this Node, to the end of the list of children of this Node.
     *
-    * @param[in] lhs                 The first node of the sorted left half.
-    * @param[in] rhs                 The first node of the sorted right half.
+    * @param[in] head                The first Node in the chain.
+    * @param[in] tail                The last Node in the chain.
+    * @param[in] count               The number of nodes in the chain.
+    * @param[in] sizeDelta           The combined subtree size of the nodes in the chain.
+    * @param[in] leafDelta           The combined leaf count of the nodes in the chain.
     *
-    * @returns The first node of the merged Node list.
+    * @returns The first Node in the chain.
     */
-   template <typename ComparatorType>
-   Node* MergeSortedHalves(Node* lhs, Node* rhs, const ComparatorType& comparator) noexcept(
-       noexcept(comparator))
+   Node* AttachSiblings(
+       Node& head,
+       Node& tail,
+       unsigned int count,
+       std::ptrdiff_t sizeDelta,
+       std::ptrdiff_t leafDelta) noexcept
    {
-      Node* head = nullptr;
-      if (comparator(*lhs, *rhs))
+      const bool wasLeaf = !m_lastChild;
+
+      if (m_lastChild)
       {
-         head = lhs;
-         lhs = lhs->m_nextSibling;
+         m_lastChild->m_nextSibling = &head;
+         head.m_previousSibling = m_lastChild;
       }
       else
       {
-         head = rhs;
-         rhs = rhs->m_nextSibling;
+         m_firstChild = &head;
       }
 
-      head->m_previousSibling = nullptr;
+      m_lastChild = &tail;
+      m_childCount += count;
 
-      Node* tail = head;
-      Node* previous = nullptr;
+      // A leaf that gains children no longer counts as a leaf itself:
+      PropagateSubtreeCounts(sizeDelta, wasLeaf ? leafDelta - 1 : leafDelta);
 
-      while (lhs && rhs)
-      {
-         previous = tail;
+      return &head;
+   }
 
-         if (comparator(*lhs, *rhs))
+   /**
+    * @returns True if this Node is either the specified Node, or one of its descendants.
+    */
+   bool IsWithinSubtreeOf(const Node& node) const noexcept
+   {
+      for (const Node* ancestor = this; ancestor; ancestor = ancestor->m_parent)
+      {
+         if (ancestor == &node)
          {
-            tail->m_nextSibling = lhs;
-            lhs = lhs->m_nextSibling;
+            return true;
          }
-         else
+      }
+
+      return false;
+   }
+
+   /**
+    * @brief Makes sure that the nodes about to be created from the specified range will occupy
+    * consecutive slots in the NodeArena.
+    */
+   template <typename IteratorType>
+   void ReserveSlots(IteratorType first, IteratorType last, std::forward_iterator_tag)
+   {
+      m_arena->Reserve(static_cast<std::size_t>(std::distance(first, last)));
+   }
+
+   /**
+    * @overload
+    *
+    * @note Single-pass ranges can't be measured without consuming them, so nothing is reserved.
+    */
+   template <typename IteratorType>
+   void ReserveSlots(IteratorType, IteratorType, std::input_iterator_tag) noexcept
+   {
+   }
+
+   /**
+    * @brief Relinks the children of the Node, such that they follow one another in the order in
+    * which they appear in the specified buffer.
+    *
+    * @param[in] children            Every child of the Node, each appearing exactly once.
+    */
+   void RelinkChildren(const std::vector<Node*>& children) noexcept
+   {
+      assert(children.size() == m_childCount);
+
+      Node* previous = nullptr;
+      for (Node* const child : children)
+      {
+         child->m_previousSibling = previous;
+
+         if (previous)
          {
-            tail->m_nextSibling = rhs;
-            rhs = rhs->m_nextSibling;
+            previous->m_nextSibling = child;
          }
 
-         tail = tail->m_nextSibling;
-         tail->m_previousSibling = previous;
+         previous = child;
       }
 
-      previous = tail;
-      tail->m_nextSibling = lhs ? lhs : rhs;
-      tail = tail->m_nextSibling;
-      tail->m_previousSibling = previous;
+      previous->m_nextSibling = nullptr;
+
+      m_firstChild = children.front();
+      m_lastChild = children.back();
+   }
+
+   /**
+    * @brief Constructs a new Node that lives wherever this Node lives: if this Node was carved
+    * out of a NodeArena, the new Node will be as well; otherwise it will be heap allocated.
+    *
+    * @param[in] args                The arguments to forward to the Node's constructor.
+    *
+    * @returns The newly constructed, but not yet attached, Node.
+    */
+   template <typename... Args>
+   Node* CreateNode(Args&&... args)
+   {
+      return m_arena ? m_arena->Create(std::forward<Args>(args)...)
+                     : new Node(std::forward<Args>(args)...);
+   }
+
+   /**
+    * @brief Thread-safe counterpart of CreateNode(...).
+    */
+   template <typename... Args>
+   Node* CreateNodeConcurrently(Args&&... args)
+   {
+      return m_arena ? m_arena->CreateConcurrently(std::forward<Args>(args)...)
+                     : new Node(std::forward<Args>(args)...);
+   }
+
+   /**
+    * @brief Appends the specified child while holding the lock stripe that guards this Node.
+    */
+   Node* AttachConcurrently(Node& child) noexcept
+   {
+      static_assert(
+          !PolicyType::TrackSubtreeSize,
+          "Maintaining subtree counts touches every ancestor, and can't be done concurrently.");
+
+      const std::lock_guard<std::mutex> lock{ GetAttachmentLock(*this) };
+      return AppendChild(child);
+   }
+
+   /**
+    * @returns The lock stripe that guards the list of children of the specified Node.
+    */
+   static std::mutex& GetAttachmentLock(const Node& parent) noexcept
+   {
+      static std::mutex stripes[ATTACHMENT_LOCK_STRIPE_COUNT];
+
+      // Nodes that were carved out of the same slab sit exactly one Node apart, so counting in
+      // units of Nodes spreads neighbouring parents across neighbouring stripes:
+      const auto address = reinterpret_cast<std::uintptr_t>(&parent);
+      return stripes[(address / sizeof(Node)) % ATTACHMENT_LOCK_STRIPE_COUNT];
+   }
 
-      return head;
+   /**
+    * @brief Destroys the specified Node and all Nodes under it, returning its memory to either
+    * the NodeArena it was carved out of, or to the heap.
+    *
+    * @param[in] node                The Node to be destroyed.
+    */
+   static void DestroyNode(Node* node) noexcept
+   {
+      if (node->m_arena)
+      {
+         node->m_arena->Destroy(node);
+      }
+      else
+      {
+         delete node;
+      }
    }
 
    /**
@@ -740,64 +1823,203 @@ class Tree<DataType>::Node
 
       m_childCount++;
 
+      UpdateCountsAfterAttaching(child, /* wasLeaf = */ true);
+
       return m_firstChild;
    }
 
    /**
-    * @brief Helper function to recursively copy the specified |source| Node and all its
-    * descendants.
+    * @brief Helper function to copy all descendants of the specified |source| Node, and to
+    * append those copies to the |sink| Node.
     *
     * @param[in] source              The Node to copy information from.
     * @param[out] sink               The Node to place a copy of the information into.
     */
-   void Copy(const Node& source, Node& sink)
+   static void Copy(const Node& source, Node& sink)
    {
-      if (!source.HasChildren())
+      for (const Node* child = source.m_firstChild; child; child = child->m_nextSibling)
       {
-         return;
+         sink.AppendChild(*CopySubtree(*child, sink.m_arena));
       }
+   }
 
-      std::for_each(
-          Tree<DataType>::SiblingIterator(source.GetFirstChild()),
-          Tree<DataType>::SiblingIterator(),
-          [&](Tree<DataType>::const_reference node) { sink.AppendChild(node.GetData()); });
+   /**
+    * @brief Copies the specified Node, along with all of its descendants, in a single pre-order
+    * pass that doesn't recurse, and so can't run out of stack space on deep trees.
+    *
+    * Since the copy has exactly the same shape as the original, the cached subtree counts are
+    * simply copied along, rather than recomputed.
+    *
+    * @param[in] source              The root of the subtree to copy.
+    * @param[in] arena               The NodeArena to carve the copies out of, if any; otherwise
+    *                                the copies are allocated on the heap.
+    *
+    * @returns The root of the copy, which isn't attached to anything yet.
+    */
+   static Node* CopySubtree(const Node& source, NodeArena* arena)
+   {
+      const auto copyOf = [arena](const Node& original) {
+         Node* const copy = arena ? arena->Create(original.m_data) : new Node(original.m_data);
+         static_cast<BookkeepingType&>(*copy) = static_cast<const BookkeepingType&>(original);
+
+         return copy;
+      };
+
+      const auto linkAsLastChild = [](Node& parent, Node& child) noexcept {
+         child.m_parent = &parent;
+         child.m_previousSibling = parent.m_lastChild;
+
+         if (parent.m_lastChild)
+         {
+            parent.m_lastChild->m_nextSibling = &child;
+         }
+         else
+         {
+            parent.m_firstChild = &child;
+         }
+
+         parent.m_lastChild = &child;
+         ++parent.m_childCount;
+      };
+
+      Node* const root = copyOf(source);
+
+      try
+      {
+         // The copy of whichever original Node is currently being visited:
+         const Node* original = &source;
+         Node* copy = root;
+
+         while (true)
+         {
+            if (original->m_firstChild)
+            {
+               original = original->m_firstChild;
+
+               Node* const child = copyOf(*original);
+               linkAsLastChild(*copy, *child);
+               copy = child;
+
+               continue;
+            }
+
+            while (original != &source && !original->m_nextSibling)
+            {
+               original = original->m_parent;
+               copy = copy->m_parent;
+            }
+
+            if (original == &source)
+            {
+               return root;
+            }
 
-      auto sourceItr = Tree<DataType>::SiblingIterator{ source.GetFirstChild() };
-      auto sinkItr = Tree<DataType>::SiblingIterator{ sink.GetFirstChild() };
+            original = original->m_nextSibling;
 
-      const auto end = Tree<DataType>::SiblingIterator{};
-      while (sourceItr != end)
+            Node* const sibling = copyOf(*original);
+            linkAsLastChild(*copy->m_parent, *sibling);
+            copy = sibling;
+         }
+      }
+      catch (...)
       {
-         Copy(*sourceItr++, *sinkItr++);
+         DestroyNode(root);
+         throw;
       }
    }
 
    /**
-    * @brief Removes the Node from the tree structure, updating all surrounding links
-    * as appropriate.
+    * @brief Destroys every descendant of the Node in a single post-order pass that doesn't
+    * recurse, and so can't run out of stack space on deep trees.
     *
-    * @note This function does not actually delete the node.
+    * Nodes are only ever removed from the front of their parent's list of children, which lets
+    * the links of the nodes that remain double as the state of the traversal. Since the whole
+    * subtree is going away, each Node is cut loose before it is destroyed, so its destructor has
+    * neither a parent to detach from, nor any children of its own left to destroy, nor any counts
+    * to propagate up the Tree.
     *
-    * @returns A pointer to the detached Node. This returned Node can safely be deleted
-    * once detached.
+    * @note This leaves the Node itself without children, but doesn't update its counts; it is
+    * meant to be called on a Node that is about to be destroyed.
     */
-   Node* DetachFromTree() noexcept
+   void DestroyDescendants() noexcept
    {
-      if (m_previousSibling && m_nextSibling)
-      {
-         m_previousSibling->m_nextSibling = m_nextSibling;
-         m_nextSibling->m_previousSibling = m_previousSibling;
-      }
-      else if (m_previousSibling)
-      {
-         m_previousSibling->m_nextSibling = nullptr;
-      }
-      else if (m_nextSibling)
-      {
-         m_nextSibling->m_previousSibling = nullptr;
-      }
+      Node* parent = this;
 
-      if (!m_parent)
+      while (true)
+      {
+         Node* const child = parent->m_firstChild;
+
+         if (!child)
+         {
+            // Every child of the parent is gone, so the parent is now a leaf that will be
+            // destroyed by the next iteration:
+            if (parent == this)
+            {
+               break;
+            }
+
+            parent = parent->m_parent;
+            continue;
+         }
+
+         if (child->m_firstChild)
+         {
+            parent = child;
+            continue;
+         }
+
+         parent->m_firstChild = child->m_nextSibling;
+
+         child->m_parent = nullptr;
+         child->m_lastChild = nullptr;
+         child->m_previousSibling = nullptr;
+         child->m_nextSibling = nullptr;
+         child->m_childCount = 0;
+
+         DestroyNode(child);
+      }
+
+      m_lastChild = nullptr;
+      m_childCount = 0;
+   }
+
+   /**
+    * @brief Destroys every descendant of the Node.
+    */
+   void DestroyChildren() noexcept
+   {
+      while (m_firstChild)
+      {
+         DestroyNode(m_firstChild);
+      }
+   }
+
+   /**
+    * @brief Removes the Node from the tree structure, updating all surrounding links
+    * as appropriate.
+    *
+    * @note This function does not actually delete the node.
+    *
+    * @returns A pointer to the detached Node. This returned Node can safely be deleted
+    * once detached.
+    */
+   Node* DetachFromTree() noexcept
+   {
+      if (m_previousSibling && m_nextSibling)
+      {
+         m_previousSibling->m_nextSibling = m_nextSibling;
+         m_nextSibling->m_previousSibling = m_previousSibling;
+      }
+      else if (m_previousSibling)
+      {
+         m_previousSibling->m_nextSibling = nullptr;
+      }
+      else if (m_nextSibling)
+      {
+         m_nextSibling->m_previousSibling = nullptr;
+      }
+
+      if (!m_parent)
       {
          return this;
       }
@@ -820,30 +2042,338 @@ class Tree<DataType>::Node
 
       m_parent->m_childCount--;
 
+      // A parent that loses its last child becomes a leaf itself:
+      const auto size = static_cast<std::ptrdiff_t>(this->TrackedSubtreeSize());
+      const auto leaves = static_cast<std::ptrdiff_t>(this->TrackedLeafCount());
+      m_parent->PropagateSubtreeCounts(-size, m_parent->HasChildren() ? -leaves : 1 - leaves);
+
+      m_parent = nullptr;
+      m_previousSibling = nullptr;
+      m_nextSibling = nullptr;
+
       return this;
    }
 
+   static constexpr std::size_t ATTACHMENT_LOCK_STRIPE_COUNT{ 64 };
+
    Node* m_parent{ nullptr };
    Node* m_firstChild{ nullptr };
    Node* m_lastChild{ nullptr };
    Node* m_previousSibling{ nullptr };
    Node* m_nextSibling{ nullptr };
 
+   NodeArena* m_arena{ nullptr };
+
    DataType m_data{};
 
    unsigned int m_childCount{ 0 };
+};
+
+/**
+ * The NodeArena class carves Nodes out of large, contiguous slabs of memory.
+ *
+ * Building a large Tree out of individually heap-allocated nodes means that most of the time
+ * spent constructing and tearing down that Tree is actually spent in the allocator. An arena, on
+ * the other hand, only visits the allocator once per slab, recycles the memory of deleted nodes,
+ * and releases all of its slabs in one bulk operation when it is destroyed.
+ *
+ * @note Apart from CreateConcurrently(...) and DestroyConcurrently(...), the NodeArena is not
+ * thread-safe; all other operations require external synchronization.
+ */
+template <typename DataType, typename PolicyType>
+class Tree<DataType, PolicyType>::NodeArena
+{
+ public:
+   static constexpr std::size_t DEFAULT_NODES_PER_SLAB{ 4096 };
+
+   /**
+    * @brief Constructs an empty arena. No memory is allocated until the first Node is created.
+    *
+    * @param[in] nodesPerSlab        The number of nodes that will fit in each slab.
+    */
+   explicit NodeArena(std::size_t nodesPerSlab = DEFAULT_NODES_PER_SLAB) noexcept
+       : m_nodesPerSlab{ nodesPerSlab > 0 ? nodesPerSlab : 1 }
+   {
+   }
+
+   NodeArena(const NodeArena&) = delete;
+   NodeArena& operator=(const NodeArena&) = delete;
+
+   /**
+    * @brief Constructs a new Node in the next available slot.
+    *
+    * @param[in] args                The arguments to forward to the Node's constructor.
+    *
+    * @returns A pointer to the newly constructed Node.
+    */
+   template <typename... Args>
+   Node* Create(Args&&... args)
+   {
+      return Construct(Allocate(), std::forward<Args>(args)...);
+   }
+
+   /**
+    * @brief Constructs a new Node in the next unused slot of the current slab, bypassing the
+    * slots recycled from destroyed Nodes. Following a call to Reserve(count), the next `count`
+    * Nodes created this way are therefore guaranteed to occupy consecutive slots.
+    *
+    * @param[in] args                The arguments to forward to the Node's constructor.
+    *
+    * @returns A pointer to the newly constructed Node.
+    */
+   template <typename... Args>
+   Node* CreateContiguously(Args&&... args)
+   {
+      return Construct(AllocateFromSlab(), std::forward<Args>(args)...);
+   }
+
+   /**
+    * @brief Constructs a new Node in the next available slot, and is safe to call from multiple
+    * threads at once. Only claiming the slot is serialized; the Node is constructed afterwards.
+    *
+    * @param[in] args                The arguments to forward to the Node's constructor.
+    *
+    * @returns A pointer to the newly constructed Node.
+    */
+   template <typename... Args>
+   Node* CreateConcurrently(Args&&... args)
+   {
+      Slot* slot = nullptr;
+      {
+         const std::lock_guard<std::mutex> lock{ m_mutex };
+         slot = Allocate();
+      }
+
+      Node* node = nullptr;
+      try
+      {
+         node = ::new (static_cast<void*>(&slot->storage)) Node(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+         const std::lock_guard<std::mutex> lock{ m_mutex };
+         Recycle(slot);
+         throw;
+      }
+
+      node->m_arena = this;
+      return node;
+   }
+
+   /**
+    * @brief Destroys the specified Node, and makes its slot available for reuse.
+    *
+    * @param[in] node                A Node that was previously created by this arena.
+    */
+   void Destroy(Node* node) noexcept
+   {
+      assert(node && node->m_arena == this);
+
+      node->~Node();
+      Recycle(reinterpret_cast<Slot*>(node));
+   }
+
+   /**
+    * @brief Thread-safe counterpart of Destroy(...), for nodes that aren't part of a Tree, such
+    * as those obtained from CreateConcurrently(...) that turn out not to be needed after all.
+    * Only recycling the slot is serialized; the Node is destroyed beforehand.
+    *
+    * @param[in] node                A childless Node that was previously created by this arena,
+    *                                which has no parent.
+    */
+   void DestroyConcurrently(Node* node) noexcept
+   {
+      assert(node && node->m_arena == this);
+      assert(!node->m_parent && !node->m_firstChild);
+
+      node->~Node();
+
+      const std::lock_guard<std::mutex> lock{ m_mutex };
+      Recycle(reinterpret_cast<Slot*>(node));
+   }
+
+   /**
+    * @brief Ensures that the next `count` Nodes created by the arena will occupy consecutive
+    * slots, by starting a new slab if the current one doesn't have enough room left.
+    *
+    * @note Slots recycled from destroyed Nodes are handed out first, and do not count towards
+    * this guarantee.
+    *
+    * @param[in] count               The number of Nodes that should be contiguous.
+    */
+   void Reserve(std::size_t count)
+   {
+      const auto remainingSlots = m_slabs.empty() ? 0 : m_slabs.back().capacity - m_slotsUsed;
+      if (remainingSlots < count)
+      {
+         AddSlab(std::max(count, m_nodesPerSlab));
+      }
+   }
+
+   /**
+    * @returns The position of the specified Node within the arena's storage, where the slots of
+    * each slab are numbered consecutively, and slabs are numbered in order of allocation.
+    *
+    * @param[in] node                A Node that was previously created by this arena.
+    */
+   std::size_t IndexOf(const Node* node) const noexcept
+   {
+      const auto* const slot = reinterpret_cast<const Slot*>(node);
+      const std::less<const Slot*> isLessThan;
+
+      for (const auto& slab : m_slabs)
+      {
+         const auto* const first = slab.slots.get();
+         if (!isLessThan(slot, first) && isLessThan(slot, first + slab.capacity))
+         {
+            return slab.firstIndex + static_cast<std::size_t>(slot - first);
+         }
+      }
+
+      assert(!"The Node does not belong to this arena.");
+      return Node::INVALID_INDEX;
+   }
+
+   /**
+    * @returns The number of nodes that fit in a single slab.
+    */
+   inline std::size_t GetNodesPerSlab() const noexcept
+   {
+      return m_nodesPerSlab;
+   }
+
+   /**
+    * @returns The number of slabs that have been allocated so far.
+    */
+   inline std::size_t GetSlabCount() const noexcept
+   {
+      return m_slabs.size();
+   }
+
+ private:
+   union Slot {
+      Slot* nextFreeSlot;
+      typename std::aligned_storage<sizeof(Node), alignof(Node)>::type storage;
+   };
+
+   /**
+    * @returns An unused slot, either recycled from a previously destroyed Node, or freshly carved
+    * out of the current slab.
+    */
+   Slot* Allocate()
+   {
+      if (m_freeList)
+      {
+         Slot* const slot = m_freeList;
+         m_freeList = slot->nextFreeSlot;
+
+         return slot;
+      }
+
+      return AllocateFromSlab();
+   }
+
+   /**
+    * @returns The next unused slot of the current slab, starting a new slab if necessary.
+    */
+   Slot* AllocateFromSlab()
+   {
+      if (m_slabs.empty() || m_slotsUsed == m_slabs.back().capacity)
+      {
+         AddSlab(m_nodesPerSlab);
+      }
+
+      return &m_slabs.back().slots[m_slotsUsed++];
+   }
+
+   /**
+    * @brief Constructs a Node in the specified slot, handing the slot back should the
+    * construction throw.
+    */
+   template <typename... Args>
+   Node* Construct(Slot* slot, Args&&... args)
+   {
+      Node* node = nullptr;
+      try
+      {
+         node = ::new (static_cast<void*>(&slot->storage)) Node(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+         Recycle(slot);
+         throw;
+      }
+
+      node->m_arena = this;
+      return node;
+   }
+
+   /**
+    * @brief Allocates a new slab, which will then serve all subsequent allocations that can't be
+    * satisfied by the free list.
+    *
+    * @param[in] capacity            The number of slots in the new slab.
+    */
+   void AddSlab(std::size_t capacity)
+   {
+      const auto firstIndex =
+          m_slabs.empty() ? 0 : m_slabs.back().firstIndex + m_slabs.back().capacity;
+
+      m_slabs.push_back(
+          Slab{ std::unique_ptr<Slot[]>{ new Slot[capacity] }, capacity, firstIndex });
+      m_slotsUsed = 0;
+   }
+
+   /**
+    * @brief Pushes the specified slot onto the free list.
+    */
+   void Recycle(Slot* slot) noexcept
+   {
+      slot->nextFreeSlot = m_freeList;
+      m_freeList = slot;
+   }
+
+   struct Slab
+   {
+      std::unique_ptr<Slot[]> slots;
+      std::size_t capacity;
+      std::size_t firstIndex;
+   };
+
+   std::vector<Slab> m_slabs;
 
-   bool m_visited{ false };
+   Slot* m_freeList{ nullptr };
+
+   std::size_t m_nodesPerSlab{ DEFAULT_NODES_PER_SLAB };
+   std::size_t m_slotsUsed{ 0 };
+
+   std::mutex m_mutex;
 };
 
+template <typename DataType, typename PolicyType>
+constexpr std::size_t Tree<DataType, PolicyType>::Node::INVALID_INDEX;
+
+template <typename DataType, typename PolicyType>
+constexpr std::size_t Tree<DataType, PolicyType>::Node::ATTACHMENT_LOCK_STRIPE_COUNT;
+
+template <typename DataType, typename PolicyType>
+constexpr std::size_t Tree<DataType, PolicyType>::NodeArena::DEFAULT_NODES_PER_SLAB;
+
 /**
  * @brief The Iterator class
  *
  * This is the base iterator class that all other iterators (sibling, leaf, post-, pre-, and
  * in-order) will derive from. This class can only instantiated by derived types.
+ *
+ * Every iterator finds its next node purely by following the links of the current one; none of
+ * them keep a stack, and none of them write to the nodes they visit. Any number of threads may
+ * therefore iterate over the same Tree at once, as long as no thread modifies it in the meantime.
+ *
+ * The base class holds nothing but the current node; the iterators that need to know where their
+ * traversal ends keep track of that themselves, so that the others stay a single pointer wide.
  */
-template <typename DataType>
-class Tree<DataType>::Iterator
+template <typename DataType, typename PolicyType>
+class Tree<DataType, PolicyType>::Iterator
 {
  public:
    // Typedefs needed for STL compliance:
@@ -868,65 +2398,1348 @@ class Tree<DataType>::Iterator
     */
    inline Node& operator*() noexcept
    {
-      return *m_currentNode;
+      return *m_currentNode;
+   }
+
+   /**
+    * @overload
+    */
+   inline const Node& operator*() const noexcept
+   {
+      return *m_currentNode;
+   }
+
+   /**
+    * @returns A pointer to the Node.
+    */
+   inline Node* operator&() noexcept
+   {
+      return m_currentNode;
+   }
+
+   /**
+    * @overload
+    */
+   inline const Node* operator&() const noexcept
+   {
+      return m_currentNode;
+   }
+
+   /**
+    * @returns A pointer to the Node pointed to by the Tree:Iterator.
+    */
+   inline Node* operator->() noexcept
+   {
+      return m_currentNode;
+   }
+
+   /**
+    * @overload
+    */
+   inline const Node* operator->() const noexcept
+   {
+      return m_currentNode;
+   }
+
+   /**
+    * @returns True if the Iterator points to the same node as the other Iterator,
+    * and false otherwise.
+    */
+   inline bool operator==(const Iterator& other) const
+   {
+      return m_currentNode == other.m_currentNode;
+   }
+
+   /**
+    * @returns True if the Iterator points to the same node as the other Iterator,
+    * and false otherwise.
+    */
+   bool operator!=(const Iterator& other) const noexcept
+   {
+      return m_currentNode != other.m_currentNode;
+   }
+
+ protected:
+   /**
+    * Default constructor.
+    */
+   Iterator() noexcept = default;
+
+   /**
+    * Copy constructor.
+    */
+   explicit Iterator(const Iterator& other) = default;
+
+   /**
+    * Constructs a Iterator started at the specified node.
+    */
+   explicit Iterator(const Node* node) noexcept : m_currentNode{ const_cast<Node*>(node) }
+   {
+   }
+
+   Node* m_currentNode{ nullptr };
+};
+
+/**
+ * @brief The PreOrderIterator class
+ */
+template <typename DataType, typename PolicyType>
+class Tree<DataType, PolicyType>::PreOrderIterator final
+    : public Tree<DataType, PolicyType>::Iterator
+{
+ public:
+   /**
+    * Default constructor.
+    */
+   PreOrderIterator() noexcept = default;
+
+   /**
+    * Constructs an iterator that starts and ends at the specified node.
+    */
+   explicit PreOrderIterator(const Node* node) noexcept : Iterator{ node }
+   {
+      if (!node)
+      {
+         return;
+      }
+
+      if (node->GetNextSibling())
+      {
+         this->m_endingNode = node->GetNextSibling();
+      }
+      else
+      {
+         this->m_endingNode = node;
+         while (this->m_endingNode->GetParent() &&
+                !this->m_endingNode->GetParent()->GetNextSibling())
+         {
+            this->m_endingNode = this->m_endingNode->GetParent();
+         }
+
+         if (this->m_endingNode->GetParent())
+         {
+            this->m_endingNode = this->m_endingNode->GetParent()->GetNextSibling();
+         }
+         else
+         {
+            this->m_endingNode = nullptr;
+         }
+      }
+   }
+
+   /**
+    * Prefix increment operator.
+    */
+   typename Tree::PreOrderIterator& operator++() noexcept
+   {
+      assert(this->m_currentNode);
+      auto* traversingNode = this->m_currentNode;
+
+      if (traversingNode->HasChildren() && !m_skipChildren)
+      {
+         traversingNode = traversingNode->GetFirstChild();
+      }
+      else if (traversingNode->GetNextSibling())
+      {
+         traversingNode = traversingNode->GetNextSibling();
+      }
+      else
+      {
+         while (traversingNode->GetParent() && !traversingNode->GetParent()->GetNextSibling())
+         {
+            traversingNode = traversingNode->GetParent();
+         }
+
+         if (traversingNode->GetParent())
+         {
+            traversingNode = traversingNode->GetParent()->GetNextSibling();
+         }
+         else
+         {
+            traversingNode = nullptr;
+         }
+      }
+
+      m_skipChildren = false;
+
+      this->m_currentNode = (traversingNode != this->m_endingNode) ? traversingNode : nullptr;
+      return *this;
+   }
+
+   /**
+    * Postfix increment operator.
+    */
+   typename Tree::PreOrderIterator operator++(int) noexcept
+   {
+      const auto result = *this;
+      ++(*this);
+
+      return result;
+   }
+
+   /**
+    * @brief Has the next increment skip over all descendants of the current Node, moving
+    * straight on to its next sibling, or to the next sibling of the nearest ancestor that has
+    * one. This allows a traversal to prune the subtrees it isn't interested in, without visiting
+    * any of the nodes in them:
+    *
+    *    for (auto itr = tree.beginPreOrder(); itr != tree.endPreOrder(); ++itr)
+    *    {
+    *       if (!IsWorthLookingInto(*itr)) itr.SkipChildren();
+    *    }
+    *
+    * @note This only affects the very next increment; after that, the iterator descends into
+    * the children of the nodes it visits as usual.
+    */
+   void SkipChildren() noexcept
+   {
+      m_skipChildren = true;
+   }
+
+ private:
+   const Node* m_endingNode{ nullptr };
+
+   bool m_skipChildren{ false };
+};
+
+/**
+ * @brief The PostOrderIterator class
+ */
+template <typename DataType, typename PolicyType>
+class Tree<DataType, PolicyType>::PostOrderIterator final
+    : public Tree<DataType, PolicyType>::Iterator
+{
+ public:
+   /**
+    * Default constructor.
+    */
+   PostOrderIterator() noexcept = default;
+
+   /**
+    * Constructs an iterator that starts and ends at the specified node.
+    */
+   explicit PostOrderIterator(const Node* node) noexcept : Iterator{ node }
+   {
+      if (!node)
+      {
+         return;
+      }
+
+      // Compute and set the starting node:
+
+      auto* traversingNode = node;
+      while (traversingNode->GetFirstChild())
+      {
+         traversingNode = traversingNode->GetFirstChild();
+      }
+
+      assert(traversingNode);
+      this->m_currentNode = const_cast<Node*>(traversingNode);
+
+      // Commpute and set the ending node:
+
+      if (node->GetNextSibling())
+      {
+         traversingNode = node->GetNextSibling();
+         while (traversingNode->HasChildren())
+         {
+            traversingNode = traversingNode->GetFirstChild();
+         }
+
+         this->m_endingNode = traversingNode;
+      }
+      else
+      {
+         this->m_endingNode = node->GetParent();
+      }
+   }
+
+   /**
+    * Prefix increment operator.
+    */
+   typename Tree::PostOrderIterator& operator++() noexcept
+   {
+      assert(this->m_currentNode);
+      auto* traversingNode = this->m_currentNode;
+
+      // By the time a node is visited, its whole subtree already has been, so the next node is
+      // either the first leaf under the next sibling, or, lacking a sibling, the parent:
+      if (traversingNode->GetNextSibling())
+      {
+         traversingNode = traversingNode->GetNextSibling();
+         while (traversingNode->HasChildren())
+         {
+            traversingNode = traversingNode->GetFirstChild();
+         }
+      }
+      else
+      {
+         traversingNode = traversingNode->GetParent();
+      }
+
+      this->m_currentNode = (traversingNode != this->m_endingNode) ? traversingNode : nullptr;
+      return *this;
+   }
+
+   /**
+    * Postfix increment operator.
+    */
+   typename Tree::PostOrderIterator operator++(int) noexcept
+   {
+      const auto result = *this;
+      ++(*this);
+
+      return result;
+   }
+
+ private:
+   const Node* m_endingNode{ nullptr };
+};
+
+/**
+ * @brief The LeafIterator class
+ */
+template <typename DataType, typename PolicyType>
+class Tree<DataType, PolicyType>::LeafIterator final
+    : public Tree<DataType, PolicyType>::Iterator
+{
+ public:
+   /**
+    * Default constructor.
+    */
+   LeafIterator() noexcept = default;
+
+   /**
+    * Constructs an iterator that starts at the specified node and iterates to the end.
+    */
+   explicit LeafIterator(const Node* node) noexcept : Iterator{ node }
+   {
+      if (!node)
+      {
+         return;
+      }
+
+      // Compute and set the starting node:
+
+      if (node->HasChildren())
+      {
+         auto* firstNode = node;
+         while (firstNode->GetFirstChild())
+         {
+            firstNode = firstNode->GetFirstChild();
+         }
+
+         this->m_currentNode = const_cast<Node*>(firstNode);
+      }
+
+      // Compute and set the ending node:
+
+      if (node->GetNextSibling())
+      {
+         auto* lastNode = node->GetNextSibling();
+         while (lastNode->HasChildren())
+         {
+            lastNode = lastNode->GetFirstChild();
+         }
+
+         this->m_endingNode = lastNode;
+      }
+      else
+      {
+         this->m_endingNode = node;
+         while (this->m_endingNode->GetParent() &&
+                !this->m_endingNode->GetParent()->GetNextSibling())
+         {
+            this->m_endingNode = this->m_endingNode->GetParent();
+         }
+
+         if (this->m_endingNode->GetParent())
+         {
+            this->m_endingNode = this->m_endingNode->GetParent()->GetNextSibling();
+            while (this->m_endingNode->HasChildren())
+            {
+               this->m_endingNode = this->m_endingNode->GetFirstChild();
+            }
+         }
+         else
+         {
+            this->m_endingNode = nullptr;
+         }
+      }
+   }
+
+   /**
+    * Prefix increment operator.
+    */
+   typename Tree::LeafIterator& operator++() noexcept
+   {
+      assert(this->m_currentNode);
+      auto* traversingNode = this->m_currentNode;
+
+      if (traversingNode->HasChildren())
+      {
+         while (traversingNode->GetFirstChild())
+         {
+            traversingNode = traversingNode->GetFirstChild();
+         }
+      }
+      else if (traversingNode->GetNextSibling())
+      {
+         traversingNode = traversingNode->GetNextSibling();
+
+         while (traversingNode->GetFirstChild())
+         {
+            traversingNode = traversingNode->GetFirstChild();
+         }
+      }
+      else if (traversingNode->GetParent())
+      {
+         while (traversingNode->GetParent() && !traversingNode->GetParent()->GetNextSibling())
+         {
+            traversingNode = traversingNode->GetParent();
+         }
+
+         if (traversingNode->GetParent())
+         {
+            traversingNode = traversingNode->GetParent()->GetNextSibling();
+
+            while (traversingNode && traversingNode->HasChildren())
+            {
+               traversingNode = traversingNode->GetFirstChild();
+            }
+         }
+         else
+         {
+            traversingNode = nullptr;
+         }
+      }
+
+      this->m_currentNode = (traversingNode != this->m_endingNode) ? traversingNode : nullptr;
+      return *this;
+   }
+
+   /**
+    * Postfix increment operator.
+    */
+   typename Tree::LeafIterator operator++(int) noexcept
+   {
+      const auto result = *this;
+      ++(*this);
+
+      return result;
+   }
+
+ private:
+   const Node* m_endingNode{ nullptr };
+};
+
+/**
+ * @brief The SiblingIterator class
+ */
+template <typename DataType, typename PolicyType>
+class Tree<DataType, PolicyType>::SiblingIterator final
+    : public Tree<DataType, PolicyType>::Iterator
+{
+ public:
+   /**
+    * Default constructor.
+    */
+   SiblingIterator() noexcept = default;
+
+   /**
+    * Constructs an iterator that starts at the specified node and iterates to the end.
+    */
+   explicit SiblingIterator(const Node* node) noexcept : Iterator{ node }
+   {
+   }
+
+   /**
+    * Prefix increment operator.
+    */
+   typename Tree::SiblingIterator& operator++() noexcept
+   {
+      if (this->m_currentNode)
+      {
+         this->m_currentNode = this->m_currentNode->GetNextSibling();
+      }
+
+      return *this;
+   }
+
+   /**
+    * Postfix increment operator.
+    */
+   typename Tree::SiblingIterator operator++(int) noexcept
+   {
+      const auto result = *this;
+      ++(*this);
+
+      return result;
+   }
+};
+
+/**
+ * @brief The LevelOrderIterator class
+ *
+ * Visits the nodes of a subtree depth by depth, and every depth from left to right.
+ *
+ * Rather than queueing up every node of the next depth, the iterator only keeps track of the nodes
+ * at the previous depth that have children, since the nodes at the current depth are simply the
+ * children of those nodes, in order. The nodes at the current depth that have children are
+ * collected into a second buffer as they are visited, and once the current depth has been
+ * exhausted, the two buffers trade places. Both buffers are reused from one depth to the next, so
+ * after the first few depths, the iterator no longer allocates at all.
+ *
+ * @note Since the iterator owns its buffers, copying it (as the postfix increment operator does)
+ * copies the buffers as well.
+ */
+template <typename DataType, typename PolicyType>
+class Tree<DataType, PolicyType>::LevelOrderIterator final
+    : public Tree<DataType, PolicyType>::Iterator
+{
+ public:
+   /**
+    * Default constructor.
+    */
+   LevelOrderIterator() noexcept = default;
+
+   /**
+    * Constructs an iterator that starts at the specified node and visits every node in the
+    * subtree rooted at that node.
+    *
+    * @param[in] node                The root of the subtree to traverse.
+    * @param[in] frontierCapacity    The number of nodes with children that each of the two
+    *                                buffers should make room for up front. Passing the largest
+    *                                number of such nodes at any one depth avoids all
+    *                                allocations during the traversal.
+    */
+   explicit LevelOrderIterator(const Node* node, std::size_t frontierCapacity = 0)
+       : Iterator{ node }
+   {
+      m_parents.reserve(frontierCapacity);
+      m_nextParents.reserve(frontierCapacity);
+
+      if (node && node->HasChildren())
+      {
+         m_nextParents.emplace_back(node);
+      }
+   }
+
+   /**
+    * Prefix increment operator.
+    */
+   typename Tree::LevelOrderIterator& operator++()
+   {
+      assert(this->m_currentNode);
+
+      Node* traversingNode = nullptr;
+
+      // The starting node is the only node at its depth, even if it happens to have siblings:
+      if (m_depth > 0)
+      {
+         traversingNode = this->m_currentNode->GetNextSibling();
+      }
+
+      if (!traversingNode && ++m_parentIndex < m_parents.size())
+      {
+         traversingNode = m_parents[m_parentIndex]->GetFirstChild();
+      }
+
+      if (!traversingNode && !m_nextParents.empty())
+      {
+         // The current depth has been exhausted, so move on to the children of the nodes that
+         // were just visited:
+         std::swap(m_parents, m_nextParents);
+         m_nextParents.clear();
+         m_parentIndex = 0;
+         ++m_depth;
+
+         traversingNode = m_parents.front()->GetFirstChild();
+      }
+
+      if (traversingNode && traversingNode->HasChildren())
+      {
+         m_nextParents.emplace_back(traversingNode);
+      }
+
+      this->m_currentNode = traversingNode;
+      return *this;
+   }
+
+   /**
+    * Postfix increment operator.
+    */
+   typename Tree::LevelOrderIterator operator++(int)
+   {
+      const auto result = *this;
+      ++(*this);
+
+      return result;
+   }
+
+   /**
+    * @brief Has the iterator leave out all descendants of the current Node, such that the
+    * traversal of the deeper levels will only include the descendants of the other nodes.
+    *
+    * @note This only affects the current Node; the children of any other nodes at the same depth
+    * will still be visited.
+    */
+   void SkipChildren() noexcept
+   {
+      if (!m_nextParents.empty() && m_nextParents.back() == this->m_currentNode)
+      {
+         m_nextParents.pop_back();
+      }
+   }
+
+   /**
+    * @returns The depth of the current Node, relative to the node at which the iterator started.
+    */
+   inline unsigned int GetDepth() const noexcept
+   {
+      return m_depth;
+   }
+
+ private:
+   std::vector<const Node*> m_parents;
+   std::vector<const Node*> m_nextParents;
+
+   std::size_t m_parentIndex{ 0 };
+
+   unsigned int m_depth{ 0 };
+};
+
+/**
+ * The traversal types below can be used to select a traversal order at compile-time, as is done by
+ * Tree::ForEach(...) and Tree::OptimizeMemoryLayoutFor(...). Each type exposes the iterator that
+ * implements its traversal order through a nested `Iterator` alias template, and the same order as
+ * a single loop through a static `ForEach(...)` function template.
+ *
+ * The loops bound the traversal to the subtree rooted at the node they start from by comparing
+ * against that node, and keep no other state, so they work equally well on a `Node` and on a
+ * `const Node`, with the visitor being passed references of the same constness.
+ */
+struct PreOrderTraversal
+{
+   template <typename DataType, typename PolicyType = DefaultTreePolicy>
+   using Iterator = typename Tree<DataType, PolicyType>::PreOrderIterator;
+
+   /**
+    * @note Each node is visited before its children are looked at, so the visitor may rearrange
+    * the children of the node it is passed, such as by sorting them.
+    */
+   template <typename NodeType, typename VisitorType>
+   static void ForEach(NodeType& root, VisitorType& visitor)
+   {
+      NodeType* node = &root;
+
+      while (true)
+      {
+         visitor(*node);
+
+         if (node->GetFirstChild())
+         {
+            node = node->GetFirstChild();
+            continue;
+         }
+
+         while (node != &root && !node->GetNextSibling())
+         {
+            node = node->GetParent();
+         }
+
+         if (node == &root)
+         {
+            return;
+         }
+
+         node = node->GetNextSibling();
+      }
+   }
+};
+
+struct PostOrderTraversal
+{
+   template <typename DataType, typename PolicyType = DefaultTreePolicy>
+   using Iterator = typename Tree<DataType, PolicyType>::PostOrderIterator;
+
+   /**
+    * @note The next node is determined before the current one is visited, so the visitor may
+    * delete the node it is passed, since all of its descendants will already have been visited.
+    */
+   template <typename NodeType, typename VisitorType>
+   static void ForEach(NodeType& root, VisitorType& visitor)
+   {
+      NodeType* node = &root;
+
+      while (true)
+      {
+         while (node->GetFirstChild())
+         {
+            node = node->GetFirstChild();
+         }
+
+         while (true)
+         {
+            if (node == &root)
+            {
+               visitor(*node);
+               return;
+            }
+
+            NodeType* const sibling = node->GetNextSibling();
+            NodeType* const parent = node->GetParent();
+
+            visitor(*node);
+
+            if (sibling)
+            {
+               node = sibling;
+               break;
+            }
+
+            node = parent;
+         }
+      }
+   }
+};
+
+struct LevelOrderTraversal
+{
+   template <typename DataType, typename PolicyType = DefaultTreePolicy>
+   using Iterator = typename Tree<DataType, PolicyType>::LevelOrderIterator;
+
+   /**
+    * @note Like the LevelOrderIterator, this keeps track of the nodes with children at the current
+    * and at the next depth, and so has to allocate.
+    */
+   template <typename NodeType, typename VisitorType>
+   static void ForEach(NodeType& root, VisitorType& visitor)
+   {
+      visitor(root);
+
+      std::vector<NodeType*> parents;
+      std::vector<NodeType*> nextParents;
+
+      if (root.HasChildren())
+      {
+         parents.emplace_back(&root);
+      }
+
+      while (!parents.empty())
+      {
+         for (NodeType* const parent : parents)
+         {
+            for (NodeType* child = parent->GetFirstChild(); child; child = child->GetNextSibling())
+            {
+               visitor(*child);
+
+               if (child->HasChildren())
+               {
+                  nextParents.emplace_back(child);
+               }
+            }
+         }
+
+         std::swap(parents, nextParents);
+         nextParents.clear();
+      }
+   }
+};
+
+struct LeafTraversal
+{
+   template <typename DataType, typename PolicyType = DefaultTreePolicy>
+   using Iterator = typename Tree<DataType, PolicyType>::LeafIterator;
+
+   template <typename NodeType, typename VisitorType>
+   static void ForEach(NodeType& root, VisitorType& visitor)
+   {
+      NodeType* node = &root;
+
+      while (true)
+      {
+         while (node->GetFirstChild())
+         {
+            node = node->GetFirstChild();
+         }
+
+         visitor(*node);
+
+         while (node != &root && !node->GetNextSibling())
+         {
+            node = node->GetParent();
+         }
+
+         if (node == &root)
+         {
+            return;
+         }
+
+         node = node->GetNextSibling();
+      }
+   }
+};
+
+/**
+ * The FrozenTree class represents an immutable, compact snapshot of a Tree.
+ *
+ * Where every Tree::Node carries five pointers and some bookkeeping on top of its data, a
+ * FrozenTree stores its nodes in pre-order and describes the topology through just two arrays of
+ * 32-bit indices: the parent of each node, and the size of the subtree rooted at each node. The
+ * data itself is kept in a separate, contiguous array. Besides being much smaller than the Tree it
+ * was created from, this layout turns a pre-order traversal into a sequential scan.
+ *
+ * The FrozenTree offers the same iterator types as the Tree, with the same semantics, so that
+ * algorithms written against the iterators of a Tree will also work with a FrozenTree. Since the
+ * nodes of a FrozenTree don't exist as objects, its iterators yield lightweight Node handles.
+ */
+template <typename DataType>
+class FrozenTree
+{
+ public:
+   class Node;
+
+   class Iterator;
+   class PreOrderIterator;
+   class PostOrderIterator;
+   class LeafIterator;
+   class SiblingIterator;
+
+   using IndexType = std::uint32_t;
+
+   static constexpr IndexType INVALID_INDEX{ std::numeric_limits<IndexType>::max() };
+
+   // Typedefs needed for STL compliance:
+   using value_type = Node;
+   using reference = const Node&;
+   using const_reference = const Node&;
+
+   /**
+    * @brief Default constructor. Constructs an empty FrozenTree.
+    */
+   FrozenTree() noexcept = default;
+
+   /**
+    * @brief Constructs a FrozenTree containing a copy of every Node in the specified Tree.
+    *
+    * @throws std::length_error if the Tree contains more nodes than can be indexed
+    * using an IndexType.
+    */
+   template <typename PolicyType>
+   explicit FrozenTree(const Tree<DataType, PolicyType>& tree)
+   {
+      const auto nodeCount = static_cast<std::size_t>(tree.Size());
+      if (nodeCount >= INVALID_INDEX)
+      {
+         throw std::length_error{ "The Tree is too large to be frozen." };
+      }
+
+      auto arrays = std::make_shared<OwnedArrays>();
+
+      auto& parents = arrays->parents;
+      auto& subtreeSizes = arrays->subtreeSizes;
+      auto& data = arrays->data;
+
+      parents.reserve(nodeCount);
+      subtreeSizes.resize(nodeCount);
+      data.reserve(nodeCount);
+
+      // The ancestors of the node currently being visited, along with their indices:
+      std::vector<std::pair<const typename Tree<DataType, PolicyType>::Node*, IndexType>> ancestors;
+
+      IndexType index{ 0 };
+
+      const auto closeSubtree = [&]() noexcept {
+         const auto ancestorIndex = ancestors.back().second;
+         subtreeSizes[ancestorIndex] = index - ancestorIndex;
+
+         ancestors.pop_back();
+      };
+
+      std::for_each(
+          tree.beginPreOrder(),
+          tree.endPreOrder(),
+          [&](typename Tree<DataType, PolicyType>::const_reference node) {
+             while (!ancestors.empty() && ancestors.back().first != node.GetParent())
+             {
+                closeSubtree();
+             }
+
+             parents.emplace_back(ancestors.empty() ? INVALID_INDEX : ancestors.back().second);
+             data.emplace_back(node.GetData());
+
+             ancestors.emplace_back(&node, index++);
+          });
+
+      while (!ancestors.empty())
+      {
+         closeSubtree();
+      }
+
+      m_parents = parents.data();
+      m_subtreeSizes = subtreeSizes.data();
+      m_data = data.data();
+      m_size = nodeCount;
+
+      m_storage = std::move(arrays);
+   }
+
+   /**
+    * @brief Constructs a FrozenTree on top of arrays that live elsewhere, such as in a
+    * memory-mapped file, without copying any of them.
+    *
+    * @note The arrays are expected to describe a valid layout, which can be verified using
+    * IsValidLayout(...).
+    *
+    * @param[in] storage             Keeps the memory behind the arrays alive for as long as this
+    *                                FrozenTree, or any copy of it, is around.
+    * @param[in] parents             The index of the parent of each node, in pre-order.
+    * @param[in] subtreeSizes        The size of the subtree rooted at each node, in pre-order.
+    * @param[in] data                The data of each node, in pre-order.
+    * @param[in] size                The number of nodes.
+    */
+   FrozenTree(
+       std::shared_ptr<const void> storage,
+       const IndexType* parents,
+       const IndexType* subtreeSizes,
+       const DataType* data,
+       std::size_t size) noexcept
+       : m_storage{ std::move(storage) },
+         m_parents{ parents },
+         m_subtreeSizes{ subtreeSizes },
+         m_data{ data },
+         m_size{ size }
+   {
+      assert(size < INVALID_INDEX);
+   }
+
+   /**
+    * @brief Verifies that the specified arrays describe a FrozenTree: the first node has to be
+    * the root of a subtree spanning all nodes, and every other node has to directly follow
+    * either its parent or the subtree of its previous sibling, without extending past the end
+    * of the subtree of its parent.
+    *
+    * @complexity Linear in the number of nodes.
+    *
+    * @returns True if the layout is valid, and false otherwise.
+    */
+   static bool IsValidLayout(
+       const IndexType* parents, const IndexType* subtreeSizes, std::size_t size)
+   {
+      if (size == 0)
+      {
+         return true;
+      }
+
+      if (size >= INVALID_INDEX || parents[0] != INVALID_INDEX || subtreeSizes[0] != size)
+      {
+         return false;
+      }
+
+      // The nodes whose subtrees are still open, from the root on down:
+      std::vector<IndexType> openSubtrees{ 0 };
+
+      for (IndexType index = 1; index < size; ++index)
+      {
+         while (index >= openSubtrees.back() + subtreeSizes[openSubtrees.back()])
+         {
+            openSubtrees.pop_back();
+         }
+
+         const auto parent = openSubtrees.back();
+         const auto subtreeSize = subtreeSizes[index];
+
+         if (parents[index] != parent || subtreeSize == 0 ||
+             subtreeSize > parent + subtreeSizes[parent] - index)
+         {
+            return false;
+         }
+
+         openSubtrees.emplace_back(index);
+      }
+
+      return true;
+   }
+
+   /**
+    * @returns The index of the parent of each node, in pre-order. The root has INVALID_INDEX
+    * for a parent.
+    */
+   inline const IndexType* GetParentIndices() const noexcept
+   {
+      return m_parents;
+   }
+
+   /**
+    * @returns The size of the subtree rooted at each node, in pre-order.
+    */
+   inline const IndexType* GetSubtreeSizes() const noexcept
+   {
+      return m_subtreeSizes;
+   }
+
+   /**
+    * @returns The data of each node, in pre-order.
+    */
+   inline const DataType* GetDataArray() const noexcept
+   {
+      return m_data;
+   }
+
+   /**
+    * @returns The root Node of the FrozenTree, or an invalid Node if the FrozenTree is empty.
+    */
+   inline Node GetRoot() const noexcept
+   {
+      return m_size == 0 ? Node{} : Node{ this, 0 };
+   }
+
+   /**
+    * @returns The Node at the specified pre-order index.
+    */
+   inline Node GetNode(IndexType index) const noexcept
+   {
+      assert(index < Size());
+      return Node{ this, index };
+   }
+
+   /**
+    * @complexity Constant.
+    *
+    * @returns The total number of nodes in the FrozenTree.
+    */
+   inline std::size_t Size() const noexcept
+   {
+      return m_size;
+   }
+
+   /**
+    * @returns A pre-order iterator that will iterate over all Nodes in the tree.
+    */
+   inline PreOrderIterator beginPreOrder() const noexcept
+   {
+      return PreOrderIterator{ GetRoot() };
+   }
+
+   /**
+    * @returns A pre-order iterator pointing "past" the end of the tree.
+    */
+   inline PreOrderIterator endPreOrder() const noexcept
+   {
+      return PreOrderIterator{};
+   }
+
+   /**
+    * @returns A post-order iterator that will iterator over all nodes in the tree, starting
+    * with the root of the FrozenTree.
+    */
+   inline PostOrderIterator begin() const noexcept
+   {
+      return PostOrderIterator{ GetRoot() };
+   }
+
+   /**
+    * @returns A post-order iterator that points past the end of the FrozenTree.
+    */
+   inline PostOrderIterator end() const noexcept
+   {
+      return PostOrderIterator{};
+   }
+
+   /**
+    * @returns An iterator that will iterator over all leaf nodes in the FrozenTree, starting with
+    * the left-most leaf.
+    */
+   inline LeafIterator beginLeaf() const noexcept
+   {
+      return LeafIterator{ GetRoot() };
+   }
+
+   /**
+    * @return A LeafIterator that points past the last leaf Node in the FrozenTree.
+    */
+   inline LeafIterator endLeaf() const noexcept
+   {
+      return LeafIterator{};
+   }
+
+ private:
+   /**
+    * @returns The index one past the last node in the subtree rooted at the specified node.
+    */
+   inline IndexType EndOfSubtree(IndexType index) const noexcept
+   {
+      return index + m_subtreeSizes[index];
+   }
+
+   /**
+    * @returns The index of the next sibling of the specified node, or INVALID_INDEX if there
+    * is none.
+    */
+   inline IndexType NextSiblingOf(IndexType index) const noexcept
+   {
+      const auto parent = m_parents[index];
+      if (parent == INVALID_INDEX)
+      {
+         return INVALID_INDEX;
+      }
+
+      const auto candidate = EndOfSubtree(index);
+      return candidate < EndOfSubtree(parent) ? candidate : INVALID_INDEX;
+   }
+
+   /**
+    * @returns The index of the left-most leaf in the subtree rooted at the specified node.
+    */
+   inline IndexType LeftmostLeafOf(IndexType index) const noexcept
+   {
+      // Since the nodes are stored in pre-order, the first child of a node always directly
+      // follows its parent:
+      while (m_subtreeSizes[index] > 1)
+      {
+         ++index;
+      }
+
+      return index;
+   }
+
+   /**
+    * @brief The arrays of a FrozenTree that was created from a Tree.
+    */
+   struct OwnedArrays
+   {
+      std::vector<IndexType> parents;
+      std::vector<IndexType> subtreeSizes;
+      std::vector<DataType> data;
+   };
+
+   // Since the FrozenTree is immutable, copies can simply share the memory behind the arrays:
+   std::shared_ptr<const void> m_storage{ nullptr };
+
+   const IndexType* m_parents{ nullptr };
+   const IndexType* m_subtreeSizes{ nullptr };
+   const DataType* m_data{ nullptr };
+
+   std::size_t m_size{ 0 };
+};
+
+template <typename DataType>
+constexpr typename FrozenTree<DataType>::IndexType FrozenTree<DataType>::INVALID_INDEX;
+
+/**
+ * The Node class is a lightweight handle to a single node in a FrozenTree.
+ *
+ * A Node that doesn't refer to any node in a FrozenTree is considered invalid, and will evaluate
+ * to false. Functions that would return a nullptr for a Tree::Node will return such an invalid
+ * Node instead.
+ */
+template <typename DataType>
+class FrozenTree<DataType>::Node
+{
+   friend class FrozenTree<DataType>;
+   friend class FrozenTree<DataType>::Iterator;
+
+ public:
+   // Typedefs needed for STL compliance:
+   using value_type = DataType;
+   using reference = const DataType&;
+   using const_reference = const DataType&;
+
+   /**
+    * @brief Constructs an invalid Node.
+    */
+   constexpr Node() noexcept = default;
+
+   /**
+    * @returns True if the Node refers to an actual node in a FrozenTree; false otherwise.
+    */
+   explicit operator bool() const noexcept
+   {
+      return m_tree != nullptr;
+   }
+
+   /**
+    * @returns The underlying data stored in the Node.
+    */
+   inline const DataType& GetData() const noexcept
+   {
+      assert(m_tree);
+      return m_tree->m_data[m_index];
+   }
+
+   /**
+    * @returns The encapsulated data.
+    */
+   inline const DataType* operator->() const noexcept
+   {
+      return &GetData();
+   }
+
+   /**
+    * @returns The pre-order index of the Node in its FrozenTree.
+    */
+   inline IndexType GetIndex() const noexcept
+   {
+      return m_index;
+   }
+
+   /**
+    * @returns The Node's parent, if it exists; an invalid Node otherwise.
+    */
+   inline Node GetParent() const noexcept
+   {
+      return MakeNode(m_tree->m_parents[m_index]);
+   }
+
+   /**
+    * @returns The Node's first child, if it exists; an invalid Node otherwise.
+    */
+   inline Node GetFirstChild() const noexcept
+   {
+      return HasChildren() ? Node{ m_tree, m_index + 1 } : Node{};
+   }
+
+   /**
+    * @complexity Linear in the number of direct descendants.
+    *
+    * @returns The Node's last child, if it exists; an invalid Node otherwise.
+    */
+   inline Node GetLastChild() const noexcept
+   {
+      auto child = GetFirstChild();
+      if (!child)
+      {
+         return child;
+      }
+
+      for (auto next = child.GetNextSibling(); next; next = next.GetNextSibling())
+      {
+         child = next;
+      }
+
+      return child;
+   }
+
+   /**
+    * @returns The Node's next sibling, if it exists; an invalid Node otherwise.
+    */
+   inline Node GetNextSibling() const noexcept
+   {
+      return MakeNode(m_tree->NextSiblingOf(m_index));
+   }
+
+   /**
+    * @returns True if this node has direct descendants.
+    */
+   inline bool HasChildren() const noexcept
+   {
+      return m_tree->m_subtreeSizes[m_index] > 1;
+   }
+
+   /**
+    * @complexity Linear in the number of direct descendants.
+    *
+    * @returns The number of direct descendants that this node has.
+    */
+   inline unsigned int GetChildCount() const noexcept
+   {
+      unsigned int count{ 0 };
+      for (auto child = GetFirstChild(); child; child = child.GetNextSibling())
+      {
+         ++count;
+      }
+
+      return count;
+   }
+
+   /**
+    * @complexity Constant.
+    *
+    * @returns The total number of descendant nodes belonging to the node.
+    */
+   inline std::size_t CountAllDescendants() const noexcept
+   {
+      return m_tree->m_subtreeSizes[m_index] - 1;
    }
 
-   /**
-    * @overload
-    */
-   inline const Node& operator*() const noexcept
+ private:
+   Node(const FrozenTree* tree, IndexType index) noexcept : m_tree{ tree }, m_index{ index }
    {
-      return *m_currentNode;
    }
 
    /**
-    * @returns A pointer to the Node.
+    * @returns A Node referring to the specified index, or an invalid Node if the index is
+    * INVALID_INDEX.
     */
-   inline Node* operator&() noexcept
+   inline Node MakeNode(IndexType index) const noexcept
    {
-      return m_currentNode;
+      return index != INVALID_INDEX ? Node{ m_tree, index } : Node{};
    }
 
+   const FrozenTree* m_tree{ nullptr };
+   IndexType m_index{ INVALID_INDEX };
+};
+
+/**
+ * @brief The Iterator class
+ *
+ * This is the base iterator class that all other FrozenTree iterators derive from. This class
+ * can only instantiated by derived types.
+ */
+template <typename DataType>
+class FrozenTree<DataType>::Iterator
+{
+ public:
+   // Typedefs needed for STL compliance:
+   using value_type = Node;
+   using pointer = const Node*;
+   using reference = const Node&;
+   using const_reference = const Node&;
+   using size_type = std::size_t;
+   using difference_type = std::ptrdiff_t;
+   using iterator_category = std::forward_iterator_tag;
+
    /**
-    * @overload
+    * @returns True if the Iterator points to a valid Node; false otherwise.
     */
-   inline const Node* operator&() const noexcept
+   explicit operator bool() const noexcept
    {
-      return m_currentNode;
+      return static_cast<bool>(m_node);
    }
 
    /**
-    * @returns A pointer to the Node pointed to by the Tree:Iterator.
+    * @returns The Node pointed to by the Iterator.
     */
-   inline Node* operator->() noexcept
+   inline const Node& operator*() const noexcept
    {
-      return m_currentNode;
+      return m_node;
    }
 
    /**
-    * @overload
+    * @returns A pointer to the Node pointed to by the Iterator.
     */
    inline const Node* operator->() const noexcept
    {
-      return m_currentNode;
+      return &m_node;
    }
 
    /**
     * @returns True if the Iterator points to the same node as the other Iterator,
     * and false otherwise.
     */
-   inline bool operator==(const Iterator& other) const
+   inline bool operator==(const Iterator& other) const noexcept
    {
-      return m_currentNode == other.m_currentNode;
+      return m_node.m_index == other.m_node.m_index;
    }
 
    /**
-    * @returns True if the Iterator points to the same node as the other Iterator,
+    * @returns True if the Iterator points to a different node than the other Iterator,
     * and false otherwise.
     */
-   bool operator!=(const Iterator& other) const noexcept
+   inline bool operator!=(const Iterator& other) const noexcept
    {
-      return m_currentNode != other.m_currentNode;
+      return m_node.m_index != other.m_node.m_index;
    }
 
  protected:
@@ -936,29 +3749,34 @@ class Tree<DataType>::Iterator
    Iterator() noexcept = default;
 
    /**
-    * Copy constructor.
+    * Constructs an Iterator started at the specified node.
     */
-   explicit Iterator(const Iterator& other) = default;
+   explicit Iterator(Node node) noexcept : m_node{ node }
+   {
+   }
 
    /**
-    * Constructs a Iterator started at the specified node.
+    * @brief Moves the Iterator to the specified index, or past the end if the index is
+    * INVALID_INDEX.
     */
-   explicit Iterator(const Node* node) noexcept
-       : m_currentNode{ const_cast<Node*>(node) }, m_startingNode{ const_cast<Node*>(node) }
+   inline void MoveTo(IndexType index) noexcept
    {
+      m_node = m_node.MakeNode(index);
    }
 
-   Node* m_currentNode{ nullptr };
+   inline const FrozenTree& GetTree() const noexcept
+   {
+      return *m_node.m_tree;
+   }
 
-   const Node* m_startingNode{ nullptr };
-   const Node* m_endingNode{ nullptr };
+   Node m_node;
 };
 
 /**
  * @brief The PreOrderIterator class
  */
 template <typename DataType>
-class Tree<DataType>::PreOrderIterator final : public Tree<DataType>::Iterator
+class FrozenTree<DataType>::PreOrderIterator final : public FrozenTree<DataType>::Iterator
 {
  public:
    /**
@@ -969,91 +3787,47 @@ class Tree<DataType>::PreOrderIterator final : public Tree<DataType>::Iterator
    /**
     * Constructs an iterator that starts and ends at the specified node.
     */
-   explicit PreOrderIterator(const Node* node) noexcept : Iterator{ node }
+   explicit PreOrderIterator(Node node) noexcept : Iterator{ node }
    {
-      if (!node)
-      {
-         return;
-      }
-
-      if (node->GetNextSibling())
-      {
-         this->m_endingNode = node->GetNextSibling();
-      }
-      else
+      if (node)
       {
-         this->m_endingNode = node;
-         while (this->m_endingNode->GetParent() &&
-                !this->m_endingNode->GetParent()->GetNextSibling())
-         {
-            this->m_endingNode = this->m_endingNode->GetParent();
-         }
-
-         if (this->m_endingNode->GetParent())
-         {
-            this->m_endingNode = this->m_endingNode->GetParent()->GetNextSibling();
-         }
-         else
-         {
-            this->m_endingNode = nullptr;
-         }
+         m_endingIndex = this->GetTree().EndOfSubtree(node.GetIndex());
       }
    }
 
    /**
     * Prefix increment operator.
     */
-   typename Tree::PreOrderIterator& operator++() noexcept
+   PreOrderIterator& operator++() noexcept
    {
-      assert(this->m_currentNode);
-      auto* traversingNode = this->m_currentNode;
-
-      if (traversingNode->HasChildren())
-      {
-         traversingNode = traversingNode->GetFirstChild();
-      }
-      else if (traversingNode->GetNextSibling())
-      {
-         traversingNode = traversingNode->GetNextSibling();
-      }
-      else
-      {
-         while (traversingNode->GetParent() && !traversingNode->GetParent()->GetNextSibling())
-         {
-            traversingNode = traversingNode->GetParent();
-         }
+      assert(this->m_node);
 
-         if (traversingNode->GetParent())
-         {
-            traversingNode = traversingNode->GetParent()->GetNextSibling();
-         }
-         else
-         {
-            traversingNode = nullptr;
-         }
-      }
+      const auto next = this->m_node.GetIndex() + 1;
+      this->MoveTo(next != m_endingIndex ? next : INVALID_INDEX);
 
-      this->m_currentNode = (traversingNode != this->m_endingNode) ? traversingNode : nullptr;
       return *this;
    }
 
    /**
     * Postfix increment operator.
     */
-   typename Tree::PreOrderIterator operator++(int) noexcept
+   PreOrderIterator operator++(int) noexcept
    {
       const auto result = *this;
       ++(*this);
 
       return result;
    }
+
+ private:
+   IndexType m_endingIndex{ INVALID_INDEX };
 };
 
 /**
  * @brief The PostOrderIterator class
  */
 template <typename DataType>
-class Tree<DataType>::PostOrderIterator final : public Tree<DataType>::Iterator
+class FrozenTree<DataType>::PostOrderIterator final : public FrozenTree<DataType>::Iterator
 {
  public:
    /**
@@ -1064,82 +3838,42 @@ class Tree<DataType>::PostOrderIterator final : public Tree<DataType>::Iterator
    /**
     * Constructs an iterator that starts and ends at the specified node.
     */
-   explicit PostOrderIterator(const Node* node) noexcept : Iterator{ node }
+   explicit PostOrderIterator(Node node) noexcept : Iterator{ node }
    {
-      if (!node)
-      {
-         return;
-      }
-
-      // Compute and set the starting node:
-
-      auto* traversingNode = node;
-      while (traversingNode->GetFirstChild())
-      {
-         traversingNode = traversingNode->GetFirstChild();
-      }
-
-      assert(traversingNode);
-      this->m_currentNode = const_cast<Node*>(traversingNode);
-
-      // Commpute and set the ending node:
-
-      if (node->GetNextSibling())
-      {
-         traversingNode = node->GetNextSibling();
-         while (traversingNode->HasChildren())
-         {
-            traversingNode = traversingNode->GetFirstChild();
-         }
-
-         this->m_endingNode = traversingNode;
-      }
-      else
+      if (node)
       {
-         this->m_endingNode = node->GetParent();
+         m_startingIndex = node.GetIndex();
+         this->MoveTo(this->GetTree().LeftmostLeafOf(m_startingIndex));
       }
    }
 
    /**
     * Prefix increment operator.
     */
-   typename Tree::PostOrderIterator& operator++() noexcept
+   PostOrderIterator& operator++() noexcept
    {
-      assert(this->m_currentNode);
-      auto* traversingNode = this->m_currentNode;
+      assert(this->m_node);
 
-      if (traversingNode->HasChildren() && !m_traversingUpTheTree)
+      const auto current = this->m_node.GetIndex();
+      if (current == m_startingIndex)
       {
-         while (traversingNode->GetFirstChild())
-         {
-            traversingNode = traversingNode->GetFirstChild();
-         }
+         this->MoveTo(INVALID_INDEX);
+         return *this;
       }
-      else if (traversingNode->GetNextSibling())
-      {
-         m_traversingUpTheTree = false;
 
-         traversingNode = traversingNode->GetNextSibling();
-         while (traversingNode->HasChildren())
-         {
-            traversingNode = traversingNode->GetFirstChild();
-         }
-      }
-      else
-      {
-         m_traversingUpTheTree = true;
+      const auto& tree = this->GetTree();
 
-         traversingNode = traversingNode->GetParent();
-      }
+      const auto sibling = tree.NextSiblingOf(current);
+      this->MoveTo(
+          sibling != INVALID_INDEX ? tree.LeftmostLeafOf(sibling) : tree.m_parents[current]);
 
-      this->m_currentNode = (traversingNode != this->m_endingNode) ? traversingNode : nullptr;
       return *this;
    }
 
    /**
     * Postfix increment operator.
     */
-   typename Tree::PostOrderIterator operator++(int) noexcept
+   PostOrderIterator operator++(int) noexcept
    {
       const auto result = *this;
       ++(*this);
@@ -1148,14 +3882,14 @@ class Tree<DataType>::PostOrderIterator final : public Tree<DataType>::Iterator
    }
 
  private:
-   bool m_traversingUpTheTree{ false };
+   IndexType m_startingIndex{ INVALID_INDEX };
 };
 
 /**
  * @brief The LeafIterator class
  */
 template <typename DataType>
-class Tree<DataType>::LeafIterator final : public Tree<DataType>::Iterator
+class FrozenTree<DataType>::LeafIterator final : public FrozenTree<DataType>::Iterator
 {
  public:
    /**
@@ -1166,129 +3900,55 @@ class Tree<DataType>::LeafIterator final : public Tree<DataType>::Iterator
    /**
     * Constructs an iterator that starts at the specified node and iterates to the end.
     */
-   explicit LeafIterator(const Node* node) noexcept : Iterator{ node }
+   explicit LeafIterator(Node node) noexcept : Iterator{ node }
    {
-      if (!node)
-      {
-         return;
-      }
-
-      // Compute and set the starting node:
-
-      if (node->HasChildren())
-      {
-         auto* firstNode = node;
-         while (firstNode->GetFirstChild())
-         {
-            firstNode = firstNode->GetFirstChild();
-         }
-
-         this->m_currentNode = const_cast<Node*>(firstNode);
-      }
-
-      // Compute and set the ending node:
-
-      if (node->GetNextSibling())
-      {
-         auto* lastNode = node->GetNextSibling();
-         while (lastNode->HasChildren())
-         {
-            lastNode = lastNode->GetFirstChild();
-         }
-
-         this->m_endingNode = lastNode;
-      }
-      else
+      if (node)
       {
-         this->m_endingNode = node;
-         while (this->m_endingNode->GetParent() &&
-                !this->m_endingNode->GetParent()->GetNextSibling())
-         {
-            this->m_endingNode = this->m_endingNode->GetParent();
-         }
-
-         if (this->m_endingNode->GetParent())
-         {
-            this->m_endingNode = this->m_endingNode->GetParent()->GetNextSibling();
-            while (this->m_endingNode->HasChildren())
-            {
-               this->m_endingNode = this->m_endingNode->GetFirstChild();
-            }
-         }
-         else
-         {
-            this->m_endingNode = nullptr;
-         }
+         m_endingIndex = this->GetTree().EndOfSubtree(node.GetIndex());
+         this->MoveTo(this->GetTree().LeftmostLeafOf(node.GetIndex()));
       }
    }
 
    /**
     * Prefix increment operator.
     */
-   typename Tree::LeafIterator& operator++() noexcept
+   LeafIterator& operator++() noexcept
    {
-      assert(this->m_currentNode);
-      auto* traversingNode = this->m_currentNode;
+      assert(this->m_node);
 
-      if (traversingNode->HasChildren())
-      {
-         while (traversingNode->GetFirstChild())
-         {
-            traversingNode = traversingNode->GetFirstChild();
-         }
-      }
-      else if (traversingNode->GetNextSibling())
-      {
-         traversingNode = traversingNode->GetNextSibling();
+      const auto& tree = this->GetTree();
 
-         while (traversingNode->GetFirstChild())
-         {
-            traversingNode = traversingNode->GetFirstChild();
-         }
-      }
-      else if (traversingNode->GetParent())
+      // Leaves are visited in the same order in which they appear in a pre-order layout:
+      auto next = this->m_node.GetIndex() + 1;
+      while (next < m_endingIndex && tree.m_subtreeSizes[next] > 1)
       {
-         while (traversingNode->GetParent() && !traversingNode->GetParent()->GetNextSibling())
-         {
-            traversingNode = traversingNode->GetParent();
-         }
-
-         if (traversingNode->GetParent())
-         {
-            traversingNode = traversingNode->GetParent()->GetNextSibling();
-
-            while (traversingNode && traversingNode->HasChildren())
-            {
-               traversingNode = traversingNode->GetFirstChild();
-            }
-         }
-         else
-         {
-            traversingNode = nullptr;
-         }
+         ++next;
       }
 
-      this->m_currentNode = (traversingNode != this->m_endingNode) ? traversingNode : nullptr;
+      this->MoveTo(next < m_endingIndex ? next : INVALID_INDEX);
       return *this;
    }
 
    /**
     * Postfix increment operator.
     */
-   typename Tree::LeafIterator operator++(int) noexcept
+   LeafIterator operator++(int) noexcept
    {
       const auto result = *this;
       ++(*this);
 
       return result;
    }
+
+ private:
+   IndexType m_endingIndex{ INVALID_INDEX };
 };
 
 /**
  * @brief The SiblingIterator class
  */
 template <typename DataType>
-class Tree<DataType>::SiblingIterator final : public Tree<DataType>::Iterator
+class FrozenTree<DataType>::SiblingIterator final : public FrozenTree<DataType>::Iterator
 {
  public:
    /**
@@ -1299,18 +3959,18 @@ class Tree<DataType>::SiblingIterator final : public Tree<DataType>::Iterator
    /**
     * Constructs an iterator that starts at the specified node and iterates to the end.
     */
-   explicit SiblingIterator(const Node* node) noexcept : Iterator{ node }
+   explicit SiblingIterator(Node node) noexcept : Iterator{ node }
    {
    }
 
    /**
     * Prefix increment operator.
     */
-   typename Tree::SiblingIterator& operator++() noexcept
+   SiblingIterator& operator++() noexcept
    {
-      if (this->m_currentNode)
+      if (this->m_node)
       {
-         this->m_currentNode = this->m_currentNode->GetNextSibling();
+         this->m_node = this->m_node.GetNextSibling();
       }
 
       return *this;
@@ -1319,7 +3979,7 @@ class Tree<DataType>::SiblingIterator final : public Tree<DataType>::Iterator
    /**
     * Postfix increment operator.
     */
-   typename Tree::SiblingIterator operator++(int) noexcept
+   SiblingIterator operator++(int) noexcept
    {
       const auto result = *this;
       ++(*this);
@@ -0,0 +1,1499 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Tim Severeijns
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "Tree.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace TreeAlgorithms
+{
+   /**
+    * @brief The default result function of ParallelReduce(...); it discards the aggregates of
+    * all nodes except the root.
+    */
+   struct DiscardResult
+   {
+      template <typename NodeType, typename ResultType>
+      void operator()(NodeType&, const ResultType&) const noexcept
+      {
+      }
+   };
+
+   /**
+    * @brief The default bound function of TopK(...), for when nothing is known about the keys
+    * of the descendants of a Node, and so every Node has to be visited.
+    */
+   struct Unbounded
+   {
+   };
+
+   /**
+    * @brief A share of the nodes of a Tree, as produced by PartitionTree(...).
+    *
+    * A partition consists of a number of whole subtrees, each of which can be iterated over using
+    * any of the iterators of the Tree, started at the root of that subtree, along with a number of
+    * individual nodes. The latter are the ancestors of subtrees that were too large to be kept in
+    * one piece; they belong to the partition by themselves, without any of their descendants.
+    *
+    * @tparam TreeType               The type of the Tree, which may be const-qualified.
+    */
+   template <typename TreeType>
+   class TreePartition
+   {
+    public:
+      using Node = std::conditional_t<
+          std::is_const<TreeType>::value,
+          const typename TreeType::Node,
+          typename TreeType::Node>;
+
+      /**
+       * @brief Adds a whole subtree, of the specified size, to the partition.
+       */
+      void AddSubtree(Node& root, std::size_t size)
+      {
+         m_subtrees.emplace_back(&root);
+         m_size += size;
+      }
+
+      /**
+       * @brief Adds a single Node, without its descendants, to the partition.
+       */
+      void AddNode(Node& node)
+      {
+         m_nodes.emplace_back(&node);
+         m_size += 1;
+      }
+
+      /**
+       * @returns The roots of the whole subtrees that belong to the partition.
+       */
+      const std::vector<Node*>& GetSubtrees() const noexcept
+      {
+         return m_subtrees;
+      }
+
+      /**
+       * @returns The nodes that belong to the partition by themselves.
+       */
+      const std::vector<Node*>& GetNodes() const noexcept
+      {
+         return m_nodes;
+      }
+
+      /**
+       * @returns The total number of nodes in the partition.
+       */
+      std::size_t Size() const noexcept
+      {
+         return m_size;
+      }
+
+      /**
+       * @brief Invokes the function on every Node in the partition: first on the individual
+       * nodes, and then on every subtree, in pre-order.
+       */
+      template <typename FunctionType>
+      void ForEach(const FunctionType& function) const
+      {
+         using IteratorType = typename std::remove_const_t<TreeType>::PreOrderIterator;
+
+         for (Node* const node : m_nodes)
+         {
+            function(*node);
+         }
+
+         for (Node* const root : m_subtrees)
+         {
+            std::for_each(
+                IteratorType{ root }, IteratorType{}, [&](Node& node) { function(node); });
+         }
+      }
+
+    private:
+      std::vector<Node*> m_subtrees;
+      std::vector<Node*> m_nodes;
+
+      std::size_t m_size{ 0 };
+   };
+
+   namespace Internals
+   {
+      /**
+       * @brief Reduces each subtree of a Tree to a single value, using a pool of threads.
+       *
+       * Work is handed out as whole subtrees. Whenever the pool runs low on work, a task
+       * splits its subtree into one task per child instead of reducing it serially, and the
+       * last child to finish folds the results of its siblings into the parent, and so on up
+       * the Tree. Every Node is therefore only ever touched by a single thread at a time.
+       *
+       * Each thread owns a queue of tasks, onto the back of which it pushes the children of the
+       * subtrees that it splits, and from the back of which it takes its next task, so that it
+       * keeps descending into the subtree it was working on. Only a thread that runs dry takes
+       * a task from the front of the queue of another thread, where the subtrees closest to the
+       * root, and so typically the largest ones, are waiting.
+       *
+       * @note The threads only live as long as a single reduction, since the library doesn't
+       * keep a pool of threads of its own.
+       */
+      template <
+          typename TreeType,
+          typename ResultType,
+          typename LeafFunction,
+          typename CombineFunction,
+          typename ResultFunction>
+      class ParallelReducer
+      {
+         using Node = typename TreeType::Node;
+
+       public:
+         ParallelReducer(
+             const LeafFunction& leafFunction,
+             const CombineFunction& combineFunction,
+             const ResultFunction& resultFunction,
+             unsigned int threadCount)
+             : m_leafFunction{ leafFunction },
+               m_combineFunction{ combineFunction },
+               m_resultFunction{ resultFunction },
+               m_threadCount{ std::max(threadCount, 1u) }
+         {
+         }
+
+         /**
+          * @brief Reduces the subtree rooted at the specified Node.
+          *
+          * @returns The aggregate of the entire subtree.
+          */
+         ResultType Reduce(Node& root)
+         {
+            if (m_threadCount == 1 || !root.HasChildren())
+            {
+               return ReduceSerially(root);
+            }
+
+            for (unsigned int index = 0; index < m_threadCount; ++index)
+            {
+               m_queues.emplace_back(std::make_unique<WorkerQueue>());
+            }
+
+            m_queues.front()->tasks.push_back(Task{ &root, nullptr, 0 });
+            m_queuedTaskCount.store(1);
+
+            std::vector<std::thread> helpers;
+            helpers.reserve(m_threadCount - 1);
+
+            try
+            {
+               for (unsigned int index = 1; index < m_threadCount; ++index)
+               {
+                  helpers.emplace_back([this, index] { ProcessTasks(index); });
+               }
+            }
+            catch (...)
+            {
+               // Should not all threads spawn, the ones that did, and this one, will suffice,
+               // since the tasks of the missing threads' queues can still be stolen.
+            }
+
+            ProcessTasks(0);
+
+            for (auto& thread : helpers)
+            {
+               thread.join();
+            }
+
+            if (m_exception)
+            {
+               std::rethrow_exception(m_exception);
+            }
+
+            return std::move(m_rootResult);
+         }
+
+       private:
+         /**
+          * @brief Collects the results of the children of a Node that was split into separate
+          * tasks.
+          */
+         struct Join
+         {
+            Join(Node& node, Join* parent, std::size_t slot)
+                : node{ node },
+                  parent{ parent },
+                  slot{ slot },
+                  pendingChildren{ node.GetChildCount() },
+                  childResults(node.GetChildCount())
+            {
+            }
+
+            Node& node;
+            Join* parent;
+            std::size_t slot;
+
+            std::atomic<std::size_t> pendingChildren;
+            std::vector<ResultType> childResults;
+         };
+
+         /**
+          * @brief A subtree that still needs to be reduced, along with the slot its result
+          * should be delivered to.
+          */
+         struct Task
+         {
+            Node* node;
+            Join* parent;
+            std::size_t slot;
+         };
+
+         /**
+          * @brief The tasks owned by a single thread.
+          */
+         struct WorkerQueue
+         {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+         };
+
+         /**
+          * @brief Runs tasks until either the entire Tree has been reduced, or a task has
+          * thrown.
+          *
+          * @param[in] workerIndex      The index of the queue owned by the calling thread.
+          */
+         void ProcessTasks(std::size_t workerIndex) noexcept
+         {
+            Task task{};
+
+            while (!m_isDone.load())
+            {
+               if (!TryAcquireTask(workerIndex, task))
+               {
+                  // Whoever queues up tasks, or finishes the reduction, does so while holding the
+                  // lock, so the wake-up can't slip in between the check and the wait:
+                  std::unique_lock<std::mutex> lock{ m_mutex };
+                  m_condition.wait(
+                      lock, [this] { return m_isDone.load() || m_queuedTaskCount.load() > 0; });
+
+                  continue;
+               }
+
+               try
+               {
+                  Run(task, workerIndex);
+               }
+               catch (...)
+               {
+                  std::lock_guard<std::mutex> lock{ m_mutex };
+                  if (!m_exception)
+                  {
+                     m_exception = std::current_exception();
+                  }
+
+                  m_isDone.store(true);
+                  m_condition.notify_all();
+               }
+            }
+         }
+
+         /**
+          * @brief Takes the most recently queued task from the thread's own queue, or, failing
+          * that, the oldest task from the queue of any of the other threads.
+          *
+          * @returns True if a task was found, and false otherwise.
+          */
+         bool TryAcquireTask(std::size_t workerIndex, Task& task)
+         {
+            for (std::size_t offset = 0; offset < m_queues.size(); ++offset)
+            {
+               auto& queue = *m_queues[(workerIndex + offset) % m_queues.size()];
+
+               std::lock_guard<std::mutex> lock{ queue.mutex };
+               if (queue.tasks.empty())
+               {
+                  continue;
+               }
+
+               if (offset == 0)
+               {
+                  task = queue.tasks.back();
+                  queue.tasks.pop_back();
+               }
+               else
+               {
+                  task = queue.tasks.front();
+                  queue.tasks.pop_front();
+               }
+
+               m_queuedTaskCount.fetch_sub(1);
+
+               return true;
+            }
+
+            return false;
+         }
+
+         /**
+          * @brief Either reduces the subtree of the task serially, or, if other threads are
+          * running out of work, splits it into one task per child.
+          */
+         void Run(const Task& task, std::size_t workerIndex)
+         {
+            Node& node = *task.node;
+
+            if (node.HasChildren() && m_queuedTaskCount.load() < m_threadCount)
+            {
+               std::lock_guard<std::mutex> lock{ m_mutex };
+
+               m_joins.emplace_back(std::make_unique<Join>(node, task.parent, task.slot));
+               Join* const join = m_joins.back().get();
+
+               auto& queue = *m_queues[workerIndex];
+               {
+                  std::lock_guard<std::mutex> queueLock{ queue.mutex };
+
+                  // Queue up the children in reverse, so that the first child is taken first:
+                  std::size_t slot = node.GetChildCount();
+                  for (Node* child = node.GetLastChild(); child;
+                       child = child->GetPreviousSibling())
+                  {
+                     queue.tasks.push_back(Task{ child, join, --slot });
+                  }
+
+                  m_queuedTaskCount.fetch_add(node.GetChildCount());
+               }
+
+               m_condition.notify_all();
+
+               return;
+            }
+
+            Deliver(ReduceSerially(node), task.parent, task.slot);
+         }
+
+         /**
+          * @brief Hands the result of a finished subtree to its parent. Whoever delivers the
+          * last outstanding result of a Join completes that Join as well, and so on, until
+          * either a Join with outstanding results or the root is reached.
+          */
+         void Deliver(ResultType result, Join* join, std::size_t slot)
+         {
+            while (join)
+            {
+               join->childResults[slot] = std::move(result);
+               if (join->pendingChildren.fetch_sub(1, std::memory_order_acq_rel) != 1)
+               {
+                  return;
+               }
+
+               result = Combine(join->node, join->childResults.begin(), join->childResults.end());
+
+               slot = join->slot;
+               join = join->parent;
+            }
+
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_rootResult = std::move(result);
+            m_isDone.store(true);
+            m_condition.notify_all();
+         }
+
+         /**
+          * @brief Reduces the subtree rooted at the specified Node on the calling thread.
+          *
+          * The traversal only follows the links between the nodes, and so never modifies the
+          * Tree. The results of finished subtrees wait on a stack until their parent is
+          * finished as well; since the children of a Node are finished right before the Node
+          * itself, their results are always found at the top of that stack.
+          */
+         ResultType ReduceSerially(Node& root)
+         {
+            std::vector<ResultType> pendingResults;
+
+            Node* node = &root;
+            while (true)
+            {
+               while (node->HasChildren())
+               {
+                  node = node->GetFirstChild();
+               }
+
+               while (true)
+               {
+                  const auto childResults =
+                      pendingResults.end() - static_cast<std::ptrdiff_t>(node->GetChildCount());
+                  ResultType result = Combine(*node, childResults, pendingResults.end());
+
+                  pendingResults.erase(childResults, pendingResults.end());
+
+                  if (node == &root)
+                  {
+                     return result;
+                  }
+
+                  pendingResults.emplace_back(std::move(result));
+
+                  if (node->GetNextSibling())
+                  {
+                     node = node->GetNextSibling();
+                     break;
+                  }
+
+                  node = node->GetParent();
+               }
+            }
+         }
+
+         /**
+          * @brief Folds the results of the children of the specified Node into the value of the
+          * Node itself, and reports the outcome.
+          */
+         template <typename IteratorType>
+         ResultType Combine(Node& node, IteratorType begin, IteratorType end)
+         {
+            ResultType result = m_leafFunction(static_cast<const Node&>(node));
+            for (auto itr = begin; itr != end; ++itr)
+            {
+               result = m_combineFunction(std::move(result), std::move(*itr));
+            }
+
+            m_resultFunction(node, static_cast<const ResultType&>(result));
+
+            return result;
+         }
+
+         const LeafFunction& m_leafFunction;
+         const CombineFunction& m_combineFunction;
+         const ResultFunction& m_resultFunction;
+
+         const unsigned int m_threadCount;
+
+         std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+         std::atomic<std::size_t> m_queuedTaskCount{ 0 };
+
+         /**
+          * Guards the joins, the outcome, and the sleep of threads that have run out of work.
+          */
+         std::mutex m_mutex;
+         std::condition_variable m_condition;
+
+         std::vector<std::unique_ptr<Join>> m_joins;
+
+         ResultType m_rootResult{};
+         std::exception_ptr m_exception{ nullptr };
+         std::atomic<bool> m_isDone{ false };
+      };
+
+      /**
+       * @brief A piece of a Tree: either a whole subtree, or a single Node by itself.
+       */
+      template <typename NodeType>
+      struct TreePiece
+      {
+         NodeType* node;
+         std::size_t size;
+         bool isWholeSubtree;
+      };
+
+      /**
+       * @returns The number of nodes in the subtree rooted at the specified Node.
+       */
+      template <typename NodeType>
+      std::size_t CountSubtree(const NodeType& node) noexcept
+      {
+         return static_cast<std::size_t>(node.CountAllDescendants()) + 1;
+      }
+
+      /**
+       * @returns The size of every subtree within the subtree rooted at the specified Node,
+       * indexed by the position of its root in a pre-order traversal that starts at that Node.
+       *
+       * A subtree occupies a contiguous run of positions in pre-order, so its size is simply the
+       * position at which the traversal leaves it, less the position of its root.
+       */
+      template <typename NodeType>
+      std::vector<std::size_t> CountSubtrees(NodeType& root)
+      {
+         std::vector<std::size_t> sizes;
+
+         // The positions of the ancestors of the current Node, whose subtrees are still open:
+         std::vector<std::size_t> openSubtrees;
+
+         NodeType* node = &root;
+         while (true)
+         {
+            openSubtrees.emplace_back(sizes.size());
+            sizes.emplace_back(0);
+
+            if (node->HasChildren())
+            {
+               node = node->GetFirstChild();
+               continue;
+            }
+
+            // Close every subtree that ends with this leaf, up to the first one with a sibling:
+            while (true)
+            {
+               const auto position = openSubtrees.back();
+               openSubtrees.pop_back();
+
+               sizes[position] = sizes.size() - position;
+
+               if (node == &root)
+               {
+                  return sizes;
+               }
+
+               if (node->GetNextSibling())
+               {
+                  node = node->GetNextSibling();
+                  break;
+               }
+
+               node = node->GetParent();
+            }
+         }
+      }
+
+      /**
+       * @brief Breaks the subtree rooted at the specified Node up into whole subtrees of at most
+       * the specified size, and the individual ancestors of those subtrees, in pre-order.
+       *
+       * @param[in] countSubtree        A function that returns the number of nodes in the
+       *                                subtree rooted at the Node it is passed, along with the
+       *                                position of that Node in a pre-order traversal of the
+       *                                subtree being split.
+       */
+      template <typename NodeType, typename CountFunctionType>
+      std::vector<TreePiece<NodeType>>
+      SplitBySize(NodeType& root, std::size_t maximumSize, const CountFunctionType& countSubtree)
+      {
+         struct PendingPiece
+         {
+            NodeType* node;
+            std::size_t position;
+            std::size_t size;
+         };
+
+         std::vector<TreePiece<NodeType>> pieces;
+         std::vector<PendingPiece> pending{ { &root, 0, countSubtree(root, 0) } };
+
+         while (!pending.empty())
+         {
+            const auto piece = pending.back();
+            pending.pop_back();
+
+            if (piece.size <= maximumSize)
+            {
+               pieces.push_back({ piece.node, piece.size, true });
+               continue;
+            }
+
+            pieces.push_back({ piece.node, 1, false });
+
+            // Each child follows the subtree of its previous sibling in pre-order:
+            const auto firstChild = pending.size();
+            auto position = piece.position + 1;
+
+            for (auto* child = piece.node->GetFirstChild(); child; child = child->GetNextSibling())
+            {
+               const auto size = countSubtree(*child, position);
+               pending.push_back({ child, position, size });
+
+               position += size;
+            }
+
+            // Reverse the children, so that they're popped off in order:
+            std::reverse(std::begin(pending) + firstChild, std::end(pending));
+         }
+
+         return pieces;
+      }
+
+      /**
+       * @brief Breaks the subtree rooted at the specified Node up into whole subtrees of at most
+       * the specified size, using the subtree sizes tracked by the Tree.
+       */
+      template <typename NodeType>
+      std::vector<TreePiece<NodeType>>
+      SplitBySize(NodeType& root, std::size_t maximumSize, std::true_type)
+      {
+         return SplitBySize(root, maximumSize, [](const NodeType& node, std::size_t) noexcept {
+            return CountSubtree(node);
+         });
+      }
+
+      /**
+       * @overload
+       *
+       * Since the Tree doesn't track subtree sizes, every subtree is counted up front, in a single
+       * pass, rather than each time that one of its ancestors is split.
+       */
+      template <typename NodeType>
+      std::vector<TreePiece<NodeType>>
+      SplitBySize(NodeType& root, std::size_t maximumSize, std::false_type)
+      {
+         const auto sizes = CountSubtrees(root);
+
+         return SplitBySize(root, maximumSize, [&](const NodeType&, std::size_t position) noexcept {
+            return sizes[position];
+         });
+      }
+
+      /**
+       * @brief Breaks the subtree rooted at the specified Node up into roughly the specified
+       * number of pieces, without counting any nodes, by splitting off the shallowest nodes
+       * first. Since the sizes of the resulting subtrees aren't known, they're reported as zero.
+       */
+      template <typename NodeType>
+      std::vector<TreePiece<NodeType>> SplitByBreadth(NodeType& root, std::size_t pieceCount)
+      {
+         std::vector<TreePiece<NodeType>> pieces;
+         std::deque<NodeType*> frontier{ &root };
+
+         while (!frontier.empty() && pieces.size() + frontier.size() < pieceCount)
+         {
+            NodeType* const node = frontier.front();
+            frontier.pop_front();
+
+            if (!node->HasChildren())
+            {
+               pieces.push_back({ node, 1, true });
+               continue;
+            }
+
+            pieces.push_back({ node, 1, false });
+
+            for (auto* child = node->GetFirstChild(); child; child = child->GetNextSibling())
+            {
+               frontier.emplace_back(child);
+            }
+         }
+
+         for (NodeType* const node : frontier)
+         {
+            pieces.push_back({ node, 0, true });
+         }
+
+         return pieces;
+      }
+
+      /**
+       * @brief Splits the Tree into pieces for ParallelForEach(...). Trees that track their
+       * subtree sizes are split into pieces of similar size, while all other trees are split
+       * breadth-first, so as not to have to count their nodes.
+       */
+      template <typename NodeType>
+      std::vector<TreePiece<NodeType>>
+      SplitForTraversal(NodeType& root, std::size_t pieceCount, std::true_type)
+      {
+         return SplitBySize(
+             root, std::max<std::size_t>(CountSubtree(root) / pieceCount, 1), std::true_type{});
+      }
+
+      /**
+       * @overload
+       */
+      template <typename NodeType>
+      std::vector<TreePiece<NodeType>>
+      SplitForTraversal(NodeType& root, std::size_t pieceCount, std::false_type)
+      {
+         return SplitByBreadth(root, pieceCount);
+      }
+
+      /**
+       * @brief Splits the Tree rooted at the specified Node into at most the specified number of
+       * partitions of roughly equal size.
+       */
+      template <typename TreeType, typename NodeType, typename TagType>
+      std::vector<TreePartition<TreeType>>
+      Partition(NodeType& root, std::size_t partitionCount, TagType tag)
+      {
+         // Breaking the Tree up into a few pieces more than there are partitions gives the
+         // assignment below some leeway to even out the sizes of the partitions:
+         constexpr std::size_t PIECES_PER_PARTITION{ 4 };
+
+         partitionCount = std::max<std::size_t>(partitionCount, 1);
+
+         const auto maximumPieceSize =
+             std::max<std::size_t>(CountSubtree(root) / (partitionCount * PIECES_PER_PARTITION), 1);
+
+         auto pieces = SplitBySize(root, maximumPieceSize, tag);
+
+         // Hand out the largest pieces first, each to the partition that's smallest at the time:
+         std::stable_sort(
+             std::begin(pieces), std::end(pieces), [](const auto& lhs, const auto& rhs) noexcept {
+                return lhs.size > rhs.size;
+             });
+
+         using LoadType = std::pair<std::size_t, std::size_t>;
+         std::priority_queue<LoadType, std::vector<LoadType>, std::greater<LoadType>> loads;
+
+         for (std::size_t index = 0; index < partitionCount; ++index)
+         {
+            loads.emplace(0, index);
+         }
+
+         std::vector<TreePartition<TreeType>> partitions(partitionCount);
+
+         for (const auto& piece : pieces)
+         {
+            const auto smallest = loads.top();
+            loads.pop();
+
+            auto& partition = partitions[smallest.second];
+            if (piece.isWholeSubtree)
+            {
+               partition.AddSubtree(*piece.node, piece.size);
+            }
+            else
+            {
+               partition.AddNode(*piece.node);
+            }
+
+            loads.emplace(partition.Size(), smallest.second);
+         }
+
+         partitions.erase(
+             std::remove_if(
+                 std::begin(partitions),
+                 std::end(partitions),
+                 [](const auto& partition) noexcept { return partition.Size() == 0; }),
+             std::end(partitions));
+
+         return partitions;
+      }
+
+      /**
+       * @brief Runs the specified number of tasks on a pool of threads, each of which keeps
+       * claiming the next task until none are left. Tasks are identified by their index.
+       *
+       * Should a task throw, the remaining tasks are abandoned, and the first exception is
+       * rethrown once all threads have stopped.
+       */
+      template <typename TaskType>
+      void RunTasks(std::size_t taskCount, unsigned int threadCount, const TaskType& task)
+      {
+         threadCount = static_cast<unsigned int>(
+             std::min<std::size_t>(std::max(threadCount, 1u), std::max<std::size_t>(taskCount, 1)));
+
+         std::atomic<std::size_t> nextTask{ 0 };
+         std::atomic<bool> hasFailed{ false };
+
+         std::mutex exceptionMutex;
+         std::exception_ptr exception{ nullptr };
+
+         const auto runTasks = [&]() noexcept {
+            while (!hasFailed.load(std::memory_order_relaxed))
+            {
+               const auto index = nextTask.fetch_add(1, std::memory_order_relaxed);
+               if (index >= taskCount)
+               {
+                  return;
+               }
+
+               try
+               {
+                  task(index);
+               }
+               catch (...)
+               {
+                  std::lock_guard<std::mutex> lock{ exceptionMutex };
+                  if (!exception)
+                  {
+                     exception = std::current_exception();
+                  }
+
+                  hasFailed.store(true, std::memory_order_relaxed);
+               }
+            }
+         };
+
+         std::vector<std::thread> helpers;
+         helpers.reserve(threadCount - 1);
+
+         try
+         {
+            for (unsigned int index = 1; index < threadCount; ++index)
+            {
+               helpers.emplace_back(runTasks);
+            }
+         }
+         catch (...)
+         {
+            // Should not all threads spawn, the ones that did, and this one, will suffice.
+         }
+
+         runTasks();
+
+         for (auto& thread : helpers)
+         {
+            thread.join();
+         }
+
+         if (exception)
+         {
+            std::rethrow_exception(exception);
+         }
+      }
+
+      /**
+       * @brief Invokes the function on every Node in the Tree rooted at the specified Node, using
+       * a pool of threads that take pieces of the Tree off of a shared list until none are left.
+       */
+      template <typename IteratorType, typename NodeType, typename FunctionType, typename TagType>
+      void ForEachInParallel(
+          NodeType& root, const FunctionType& function, unsigned int threadCount, TagType tag)
+      {
+         // Many more pieces than threads ensure that no thread is left idle for long, no matter
+         // how unevenly the pieces turn out:
+         constexpr std::size_t PIECES_PER_THREAD{ 16 };
+
+         threadCount = std::max(threadCount, 1u);
+         if (threadCount == 1 || !root.HasChildren())
+         {
+            std::for_each(IteratorType{ &root }, IteratorType{}, [&](NodeType& node) {
+               function(node);
+            });
+
+            return;
+         }
+
+         const auto pieces = SplitForTraversal(root, threadCount * PIECES_PER_THREAD, tag);
+
+         RunTasks(pieces.size(), threadCount, [&](std::size_t index) {
+            const auto& piece = pieces[index];
+
+            if (piece.isWholeSubtree)
+            {
+               std::for_each(IteratorType{ piece.node }, IteratorType{}, [&](NodeType& node) {
+                  function(node);
+               });
+            }
+            else
+            {
+               function(*piece.node);
+            }
+         });
+      }
+
+      /**
+       * @brief Keeps the nodes with the largest keys offered so far, up to a fixed number of
+       * them, in a heap whose top is the worst of those kept. Of nodes with equal keys, the ones
+       * offered first are preferred, which keeps the outcome independent of the heap's internals.
+       */
+      template <typename NodeType, typename KeyType>
+      class BoundedHeap
+      {
+       public:
+         struct Entry
+         {
+            KeyType key;
+            std::size_t sequence;
+            NodeType* node;
+         };
+
+         /**
+          * @param[in] capacity      The number of nodes to keep, which must not be zero.
+          */
+         explicit BoundedHeap(std::size_t capacity) : m_capacity{ capacity }
+         {
+            m_entries.reserve(capacity);
+         }
+
+         /**
+          * @returns True if a Node with the specified key would currently be kept.
+          */
+         bool WouldAccept(const KeyType& key) const
+         {
+            return m_entries.size() < m_capacity || m_entries.front().key < key;
+         }
+
+         /**
+          * @brief Keeps the Node if its key is among the largest offered so far, evicting the
+          * worst of the nodes that were kept before if necessary.
+          */
+         void Offer(NodeType& node, KeyType key)
+         {
+            const auto sequence = m_nextSequence++;
+
+            if (!WouldAccept(key))
+            {
+               return;
+            }
+
+            if (m_entries.size() == m_capacity)
+            {
+               std::pop_heap(std::begin(m_entries), std::end(m_entries), IsBetter);
+               m_entries.pop_back();
+            }
+
+            m_entries.push_back({ std::move(key), sequence, &node });
+            std::push_heap(std::begin(m_entries), std::end(m_entries), IsBetter);
+         }
+
+         /**
+          * @returns The entries that were kept, from best to worst, leaving the heap empty.
+          */
+         std::vector<Entry> TakeSorted()
+         {
+            std::sort_heap(std::begin(m_entries), std::end(m_entries), IsBetter);
+            return std::move(m_entries);
+         }
+
+       private:
+         static bool IsBetter(const Entry& lhs, const Entry& rhs)
+         {
+            if (rhs.key < lhs.key)
+            {
+               return true;
+            }
+
+            if (lhs.key < rhs.key)
+            {
+               return false;
+            }
+
+            return lhs.sequence < rhs.sequence;
+         }
+
+         std::vector<Entry> m_entries;
+         std::size_t m_capacity;
+         std::size_t m_nextSequence{ 0 };
+      };
+
+      /**
+       * @returns True if the descendants of the Node might have keys large enough to be kept.
+       */
+      template <typename HeapType, typename NodeType, typename BoundFunctionType>
+      bool MayHoldLargerKeys(
+          const HeapType& heap, const NodeType& node, const BoundFunctionType& bound)
+      {
+         return heap.WouldAccept(bound(node));
+      }
+
+      /**
+       * @overload
+       */
+      template <typename HeapType, typename NodeType>
+      bool MayHoldLargerKeys(const HeapType&, const NodeType&, Unbounded) noexcept
+      {
+         return true;
+      }
+
+      /**
+       * @returns A visitor for Traverse(...) that offers every Node it visits to the heap, and
+       * only descends into subtrees that might still hold a key large enough to be kept.
+       */
+      template <
+          typename NodeType,
+          typename HeapType,
+          typename KeyFunctionType,
+          typename BoundFunctionType>
+      auto MakeTopKVisitor(
+          HeapType& heap, const KeyFunctionType& key, const BoundFunctionType& bound)
+      {
+         return [&](NodeType& node) {
+            heap.Offer(node, key(node));
+            return MayHoldLargerKeys(heap, node, bound);
+         };
+      }
+
+      /**
+       * @returns The nodes of the entries, in the same order.
+       */
+      template <typename NodeType, typename EntryType>
+      std::vector<NodeType*> ToNodes(const std::vector<EntryType>& entries)
+      {
+         std::vector<NodeType*> nodes;
+         nodes.reserve(entries.size());
+
+         for (const auto& entry : entries)
+         {
+            nodes.emplace_back(entry.node);
+         }
+
+         return nodes;
+      }
+   } // namespace Internals
+
+   /**
+    * @brief A stable sort that splits large ranges into one run per thread, sorts the runs
+    * concurrently, and then merges them pairwise, with the merges of each round also running
+    * concurrently. Ranges too small to be worth the threads are sorted on the calling thread.
+    *
+    * Besides sorting any range of random access iterators, this can be handed to
+    * Node::SortChildren(...) to sort the children of very wide nodes:
+    *
+    *    node.SortChildren(comparator, TreeAlgorithms::ParallelStableSort{ threadCount });
+    */
+   struct ParallelStableSort
+   {
+      /**
+       * Runs shorter than this aren't worth the cost of handing them to a thread.
+       */
+      static constexpr std::size_t MINIMUM_RUN_LENGTH{ 4096 };
+
+      unsigned int threadCount{ std::thread::hardware_concurrency() };
+
+      template <typename IteratorType, typename ComparatorType>
+      void operator()(IteratorType first, IteratorType last, const ComparatorType& comparator) const
+      {
+         const auto length = static_cast<std::size_t>(std::distance(first, last));
+         const auto runCount = std::min<std::size_t>(
+             std::max(threadCount, 1u), length / MINIMUM_RUN_LENGTH);
+
+         if (runCount < 2)
+         {
+            std::stable_sort(first, last, comparator);
+            return;
+         }
+
+         const auto boundary = [&](std::size_t run) {
+            return std::next(first, static_cast<std::ptrdiff_t>(length * run / runCount));
+         };
+
+         Internals::RunTasks(runCount, threadCount, [&](std::size_t run) {
+            std::stable_sort(boundary(run), boundary(run + 1), comparator);
+         });
+
+         // Only ever merging adjacent runs, with the left run first, keeps the sort stable:
+         for (std::size_t width = 1; width < runCount; width *= 2)
+         {
+            const auto mergeCount = (runCount + 2 * width - 1) / (2 * width);
+
+            Internals::RunTasks(mergeCount, threadCount, [&](std::size_t merge) {
+               const auto left = merge * 2 * width;
+               const auto right = left + width;
+
+               if (right < runCount)
+               {
+                  std::inplace_merge(
+                      boundary(left),
+                      boundary(right),
+                      boundary(std::min(right + width, runCount)),
+                      comparator);
+               }
+            });
+         }
+      }
+   };
+
+   /**
+    * @brief Computes an aggregate for every subtree of the Tree, bottom-up, in parallel.
+    *
+    * The aggregate of a Node is obtained by folding the aggregates of its children, from first
+    * to last, into the value that the Node contributes by itself:
+    *
+    *    combineFunction(...combineFunction(leafFunction(node), aggregate(first))..., last)
+    *
+    * Large subtrees are split into separate tasks whenever threads run out of work, which keeps
+    * all threads busy even when the Tree is badly unbalanced.
+    *
+    * @note The aggregate type must be default constructible.
+    *
+    * @note Since the functions will be invoked concurrently, they must be safe to call from
+    * multiple threads at once. The result function may modify the Node it is passed, but no
+    * other Node; the leaf function will not be invoked on that Node again afterwards.
+    *
+    * @param[in] tree                The Tree to reduce.
+    * @param[in] leafFunction        Maps a const Node& onto the value that the Node contributes.
+    * @param[in] combineFunction     Combines an accumulated aggregate with that of a child.
+    * @param[in] resultFunction      Receives every Node along with its aggregate, as soon as
+    *                                it's known.
+    * @param[in] threadCount         The number of threads to use, including the calling thread.
+    *
+    * @returns The aggregate of the entire Tree.
+    */
+   template <
+       typename DataType,
+       typename PolicyType,
+       typename LeafFunction,
+       typename CombineFunction,
+       typename ResultFunction = DiscardResult>
+   auto ParallelReduce(
+       Tree<DataType, PolicyType>& tree,
+       const LeafFunction& leafFunction,
+       const CombineFunction& combineFunction,
+       const ResultFunction& resultFunction = {},
+       unsigned int threadCount = std::thread::hardware_concurrency())
+   {
+      using TreeType = Tree<DataType, PolicyType>;
+      using ResultType = std::decay_t<decltype(
+          leafFunction(std::declval<const typename TreeType::Node&>()))>;
+
+      Internals::
+          ParallelReducer<TreeType, ResultType, LeafFunction, CombineFunction, ResultFunction>
+              reducer{ leafFunction, combineFunction, resultFunction, threadCount };
+
+      return reducer.Reduce(*tree.GetRoot());
+   }
+
+   /**
+    * @brief Splits the Tree into at most the specified number of partitions, each holding roughly
+    * the same number of nodes, such that every Node ends up in exactly one partition.
+    *
+    * The Tree is first broken up into whole subtrees that are small enough to be moved around
+    * freely, and the ancestors of those subtrees, which are handed out individually. The pieces
+    * are then distributed over the partitions, largest piece first, each going to the partition
+    * that is smallest at the time.
+    *
+    * @note The partitions refer to the nodes of the Tree, and so are only valid for as long as
+    * the Tree isn't modified.
+    *
+    * @complexity Linear in the number of pieces if the policy of the Tree tracks subtree sizes.
+    * Otherwise, linear in the size of the Tree, since every subtree is counted up front, in a
+    * single pass, which also takes one word of memory per Node.
+    *
+    * @param[in] tree                The Tree to partition.
+    * @param[in] partitionCount      The desired number of partitions.
+    *
+    * @returns The partitions. Fewer partitions than requested are returned only if the Tree
+    * doesn't contain enough nodes to fill all of them.
+    */
+   template <typename DataType, typename PolicyType>
+   std::vector<TreePartition<Tree<DataType, PolicyType>>>
+   PartitionTree(Tree<DataType, PolicyType>& tree, std::size_t partitionCount)
+   {
+      return Internals::Partition<Tree<DataType, PolicyType>>(
+          *tree.GetRoot(),
+          partitionCount,
+          std::integral_constant<bool, PolicyType::TrackSubtreeSize>{});
+   }
+
+   /**
+    * @overload
+    */
+   template <typename DataType, typename PolicyType>
+   std::vector<TreePartition<const Tree<DataType, PolicyType>>>
+   PartitionTree(const Tree<DataType, PolicyType>& tree, std::size_t partitionCount)
+   {
+      using NodeType = const typename Tree<DataType, PolicyType>::Node;
+
+      return Internals::Partition<const Tree<DataType, PolicyType>>(
+          static_cast<NodeType&>(*tree.GetRoot()),
+          partitionCount,
+          std::integral_constant<bool, PolicyType::TrackSubtreeSize>{});
+   }
+
+   /**
+    * @brief Invokes the function on every Node in the Tree, spreading the work across multiple
+    * threads. The order in which the nodes are visited is unspecified.
+    *
+    * The Tree is broken up into many more pieces than there are threads, and each thread keeps
+    * taking the next piece off of a shared list until none are left, which balances the load even
+    * when the pieces vary wildly in size. Trees that track their subtree sizes are broken up into
+    * pieces of similar size; other trees are broken up breadth-first, without counting any nodes.
+    *
+    * @note Since the function will be invoked concurrently, it must be safe to call from multiple
+    * threads at once. It may modify the Node it is passed, but not the structure of the Tree.
+    *
+    * @note Should the function throw, the remaining pieces are abandoned, and the first exception
+    * is rethrown once all threads have stopped.
+    *
+    * @param[in] tree                The Tree to traverse.
+    * @param[in] function            The function to invoke on every Node.
+    * @param[in] threadCount         The number of threads to use, including the calling thread.
+    */
+   template <typename DataType, typename PolicyType, typename FunctionType>
+   void ParallelForEach(
+       Tree<DataType, PolicyType>& tree,
+       const FunctionType& function,
+       unsigned int threadCount = std::thread::hardware_concurrency())
+   {
+      using TreeType = Tree<DataType, PolicyType>;
+
+      Internals::ForEachInParallel<typename TreeType::PreOrderIterator>(
+          *tree.GetRoot(),
+          function,
+          threadCount,
+          std::integral_constant<bool, PolicyType::TrackSubtreeSize>{});
+   }
+
+   /**
+    * @overload
+    */
+   template <typename DataType, typename PolicyType, typename FunctionType>
+   void ParallelForEach(
+       const Tree<DataType, PolicyType>& tree,
+       const FunctionType& function,
+       unsigned int threadCount = std::thread::hardware_concurrency())
+   {
+      using TreeType = Tree<DataType, PolicyType>;
+      using NodeType = const typename TreeType::Node;
+
+      Internals::ForEachInParallel<typename TreeType::PreOrderIterator>(
+          static_cast<NodeType&>(*tree.GetRoot()),
+          function,
+          threadCount,
+          std::integral_constant<bool, PolicyType::TrackSubtreeSize>{});
+   }
+
+   /**
+    * @brief Visits the subtree rooted at the specified Node in pre-order, descending into the
+    * children of a Node only if the visitor asks for it. Subtrees that the visitor isn't
+    * interested in are therefore skipped over entirely, rather than being visited and filtered.
+    *
+    * @param[in] root                The Node to start the traversal at. Only its descendants will
+    *                                be visited, and not its siblings.
+    * @param[in] visitor             A callable type that should be equivalent to:
+    *                                   bool visitor(Node& node);
+    *                                and which returns whether to visit the children of the Node.
+    *
+    * @returns The number of nodes visited.
+    */
+   template <typename NodeType, typename VisitorType>
+   std::size_t Traverse(NodeType& root, const VisitorType& visitor)
+   {
+      std::size_t visitedCount{ 0 };
+
+      NodeType* node = &root;
+      while (true)
+      {
+         ++visitedCount;
+
+         if (visitor(*node) && node->HasChildren())
+         {
+            node = node->GetFirstChild();
+            continue;
+         }
+
+         // Climb back up until there's a sibling left to visit, or we're back where we started:
+         while (node != &root && !node->GetNextSibling())
+         {
+            node = node->GetParent();
+         }
+
+         if (node == &root)
+         {
+            return visitedCount;
+         }
+
+         node = node->GetNextSibling();
+      }
+   }
+
+   /**
+    * @brief Stably sorts the children of every Node in the Tree, spreading the work across
+    * multiple threads.
+    *
+    * Since sorting the children of one Node touches no other Node than those children, the nodes
+    * with children to sort are first gathered in a single pass, after which threads keep taking
+    * batches of those nodes until none are left. Nodes with so many children that they would hold
+    * up the thread that sorts them instead have their children sorted by all threads at once,
+    * using ParallelStableSort.
+    *
+    * @note Since the comparator will be invoked concurrently, it must be safe to call from multiple
+    * threads at once.
+    *
+    * @note Should the comparator throw, the sort is abandoned, and the first exception is rethrown
+    * once all threads have stopped. Each Node will then either have had its children sorted, or
+    * have them left in their original order.
+    *
+    * @param[in] tree                The Tree to sort.
+    * @param[in] comparator          A callable type that should be equivalent to:
+    *                                   bool comparator(const Node& lhs, const Node& rhs);
+    * @param[in] threadCount         The number of threads to use, including the calling thread.
+    */
+   template <typename DataType, typename PolicyType, typename ComparatorType>
+   void SortTree(
+       Tree<DataType, PolicyType>& tree,
+       const ComparatorType& comparator,
+       unsigned int threadCount = std::thread::hardware_concurrency())
+   {
+      using NodeType = typename Tree<DataType, PolicyType>::Node;
+
+      // Claiming nodes one at a time would have the threads contend over the shared cursor:
+      constexpr std::size_t NODES_PER_BATCH{ 64 };
+
+      const ParallelStableSort parallelSort{ threadCount };
+      const auto wideNodeThreshold = ParallelStableSort::MINIMUM_RUN_LENGTH * 2;
+
+      std::vector<NodeType*> narrowNodes;
+      std::vector<NodeType*> wideNodes;
+
+      std::for_each(tree.beginPreOrder(), tree.endPreOrder(), [&](NodeType& node) {
+         if (node.GetChildCount() >= wideNodeThreshold && threadCount > 1)
+         {
+            wideNodes.emplace_back(&node);
+         }
+         else if (node.GetChildCount() > 1)
+         {
+            narrowNodes.emplace_back(&node);
+         }
+      });
+
+      for (NodeType* const node : wideNodes)
+      {
+         node->SortChildren(comparator, parallelSort);
+      }
+
+      const auto batchCount = (narrowNodes.size() + NODES_PER_BATCH - 1) / NODES_PER_BATCH;
+
+      Internals::RunTasks(batchCount, threadCount, [&](std::size_t batch) {
+         const auto begin = batch * NODES_PER_BATCH;
+         const auto end = std::min(begin + NODES_PER_BATCH, narrowNodes.size());
+
+         for (auto index = begin; index < end; ++index)
+         {
+            narrowNodes[index]->SortChildren(comparator);
+         }
+      });
+   }
+
+   /**
+    * @brief Finds the nodes with the largest keys in the subtree rooted at the specified Node,
+    * without sorting the whole subtree: only the best nodes found so far are kept, in a heap that
+    * never grows beyond the number of nodes asked for.
+    *
+    * When the Tree maintains an aggregate that bounds the keys of all of the descendants of a Node,
+    * such as a directory size that includes the sizes of everything it contains, the bound function
+    * allows whole subtrees to be skipped once they can no longer hold any key large enough to make
+    * the cut.
+    *
+    * @param[in] root                The Node whose subtree to search, including the Node itself.
+    * @param[in] k                   The maximum number of nodes to find.
+    * @param[in] key                 A callable type that should be equivalent to:
+    *                                   KeyType key(const Node& node);
+    *                                where KeyType is copyable and comparable through operator<.
+    * @param[in] bound               Optionally, a callable type that should be equivalent to:
+    *                                   KeyType bound(const Node& node);
+    *                                which returns a value no smaller than the key of any of the
+    *                                descendants of the Node.
+    *
+    * @returns The nodes found, ordered from the largest key to the smallest. Of nodes with equal
+    * keys, those that come first in pre-order are preferred, and listed first.
+    */
+   template <
+       typename NodeType,
+       typename KeyFunctionType,
+       typename BoundFunctionType = Unbounded>
+   std::vector<NodeType*> TopK(
+       NodeType& root,
+       std::size_t k,
+       const KeyFunctionType& key,
+       const BoundFunctionType& bound = {})
+   {
+      using KeyType = std::decay_t<decltype(key(std::declval<NodeType&>()))>;
+      using HeapType = Internals::BoundedHeap<NodeType, KeyType>;
+
+      if (k == 0)
+      {
+         return {};
+      }
+
+      HeapType heap{ k };
+      Traverse(root, Internals::MakeTopKVisitor<NodeType>(heap, key, bound));
+
+      return Internals::ToNodes<NodeType>(heap.TakeSorted());
+   }
+
+   /**
+    * @brief Finds the nodes with the largest keys in the subtree rooted at the specified Node,
+    * spreading the search across multiple threads.
+    *
+    * The subtree is broken up breadth-first into many more pieces than there are threads, without
+    * counting any nodes, since the bound function makes the amount of work that each piece takes
+    * unrelated to its size anyway. Each piece is searched into a heap of its own, and the heaps
+    * are then merged.
+    *
+    * @note Since the pieces prune their subtrees independently of each other, a parallel search
+    * may visit more nodes than a serial one would.
+    *
+    * @note Should any of the functions throw, the remaining pieces are abandoned, and the first
+    * exception is rethrown once all threads have stopped.
+    *
+    * @param[in] threadCount         The number of threads to use, including the calling thread.
+    *
+    * @see TopK(...)
+    *
+    * @returns The nodes found, ordered from the largest key to the smallest. Which of a number of
+    * nodes with equal keys are kept is deterministic, but need not match TopK(...).
+    */
+   template <
+       typename NodeType,
+       typename KeyFunctionType,
+       typename BoundFunctionType = Unbounded>
+   std::vector<NodeType*> ParallelTopK(
+       NodeType& root,
+       std::size_t k,
+       const KeyFunctionType& key,
+       const BoundFunctionType& bound = {},
+       unsigned int threadCount = std::thread::hardware_concurrency())
+   {
+      using KeyType = std::decay_t<decltype(key(std::declval<NodeType&>()))>;
+      using HeapType = Internals::BoundedHeap<NodeType, KeyType>;
+
+      constexpr std::size_t PIECES_PER_THREAD{ 16 };
+
+      threadCount = std::max(threadCount, 1u);
+      if (k == 0 || threadCount == 1 || !root.HasChildren())
+      {
+         return TopK(root, k, key, bound);
+      }
+
+      const auto pieces = Internals::SplitByBreadth(root, threadCount * PIECES_PER_THREAD);
+      std::vector<std::vector<typename HeapType::Entry>> results(pieces.size());
+
+      Internals::RunTasks(pieces.size(), threadCount, [&](std::size_t index) {
+         const auto& piece = pieces[index];
+         HeapType heap{ k };
+
+         if (piece.isWholeSubtree)
+         {
+            Traverse(*piece.node, Internals::MakeTopKVisitor<NodeType>(heap, key, bound));
+         }
+         else
+         {
+            heap.Offer(*piece.node, key(*piece.node));
+         }
+
+         results[index] = heap.TakeSorted();
+      });
+
+      HeapType heap{ k };
+      for (auto& result : results)
+      {
+         for (auto& entry : result)
+         {
+            heap.Offer(*entry.node, std::move(entry.key));
+         }
+      }
+
+      return Internals::ToNodes<NodeType>(heap.TakeSorted());
+   }
+} // namespace TreeAlgorithms
@@ -0,0 +1,395 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Tim Severeijns
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "Tree.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * The binary format written and read by the functions in this namespace is laid out as follows:
+ *
+ *    FileHeader
+ *    IndexType parents[nodeCount]        The parent of each node, in pre-order.
+ *    IndexType subtreeSizes[nodeCount]   The size of the subtree rooted at each node.
+ *    DataType data[nodeCount]            The data of each node, copied byte for byte.
+ *
+ * Every section starts at a multiple of SECTION_ALIGNMENT, so that a memory-mapped file can be
+ * used as is, which means that loading a file only has to verify it, rather than deserialize it.
+ * Since the data is copied byte for byte, only trivially copyable types without pointers can be
+ * stored, and files are only portable between machines of the same endianness.
+ */
+namespace TreeSerialization
+{
+   constexpr std::uint32_t FORMAT_VERSION{ 1 };
+
+   constexpr std::size_t SECTION_ALIGNMENT{ 64 };
+
+   /**
+    * @brief The header at the start of every file.
+    */
+   struct FileHeader
+   {
+      char magic[8];
+
+      std::uint32_t version;
+      std::uint32_t byteOrderMark;
+
+      std::uint32_t indexSize;
+      std::uint32_t dataSize;
+      std::uint32_t dataAlignment;
+      std::uint32_t reserved;
+
+      std::uint64_t nodeCount;
+
+      std::uint64_t parentsOffset;
+      std::uint64_t subtreeSizesOffset;
+      std::uint64_t dataOffset;
+
+      std::uint64_t fileSize;
+   };
+
+   namespace Internals
+   {
+      constexpr char MAGIC[8] = { 'N', 'A', 'R', 'Y', 'T', 'R', 'E', 'E' };
+
+      constexpr std::uint32_t BYTE_ORDER_MARK{ 0x01020304 };
+
+      /**
+       * @returns The specified offset, rounded up to the next section boundary.
+       */
+      constexpr std::uint64_t AlignSection(std::uint64_t offset) noexcept
+      {
+         return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+      }
+
+      /**
+       * @returns The header that describes a file holding the specified number of nodes.
+       */
+      template <typename DataType>
+      FileHeader MakeHeader(std::uint64_t nodeCount) noexcept
+      {
+         using IndexType = typename FrozenTree<DataType>::IndexType;
+
+         FileHeader header{};
+         std::memcpy(header.magic, MAGIC, sizeof MAGIC);
+
+         header.version = FORMAT_VERSION;
+         header.byteOrderMark = BYTE_ORDER_MARK;
+
+         header.indexSize = sizeof(IndexType);
+         header.dataSize = sizeof(DataType);
+         header.dataAlignment = alignof(DataType);
+
+         header.nodeCount = nodeCount;
+
+         header.parentsOffset = AlignSection(sizeof(FileHeader));
+         header.subtreeSizesOffset =
+             AlignSection(header.parentsOffset + nodeCount * sizeof(IndexType));
+         header.dataOffset =
+             AlignSection(header.subtreeSizesOffset + nodeCount * sizeof(IndexType));
+
+         header.fileSize = header.dataOffset + nodeCount * sizeof(DataType);
+
+         return header;
+      }
+
+      /**
+       * @brief Maps an entire file into memory, read-only, for as long as the object lives.
+       */
+      class MappedFile
+      {
+       public:
+         /**
+          * @throws std::runtime_error if the file can't be opened or mapped.
+          */
+         explicit MappedFile(const std::string& fileName)
+         {
+#ifdef _WIN32
+            const HANDLE file = CreateFileA(
+                fileName.c_str(),
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                nullptr,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                nullptr);
+
+            if (file == INVALID_HANDLE_VALUE)
+            {
+               throw std::runtime_error{ "Could not open: " + fileName };
+            }
+
+            LARGE_INTEGER fileSize;
+            const auto mapping =
+                GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0
+                    ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)
+                    : nullptr;
+
+            // The mapping keeps the file open by itself:
+            CloseHandle(file);
+
+            if (!mapping)
+            {
+               throw std::runtime_error{ "Could not map: " + fileName };
+            }
+
+            m_address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+
+            if (!m_address)
+            {
+               throw std::runtime_error{ "Could not map: " + fileName };
+            }
+
+            m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+            const int file = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+            if (file < 0)
+            {
+               throw std::runtime_error{ "Could not open: " + fileName };
+            }
+
+            struct stat status;
+            const auto address = fstat(file, &status) == 0 && status.st_size > 0
+                                     ? mmap(
+                                           nullptr,
+                                           static_cast<std::size_t>(status.st_size),
+                                           PROT_READ,
+                                           MAP_SHARED,
+                                           file,
+                                           0)
+                                     : MAP_FAILED;
+
+            // The mapping keeps the file open by itself:
+            close(file);
+
+            if (address == MAP_FAILED)
+            {
+               throw std::runtime_error{ "Could not map: " + fileName };
+            }
+
+            m_address = address;
+            m_size = static_cast<std::size_t>(status.st_size);
+#endif
+         }
+
+         ~MappedFile()
+         {
+#ifdef _WIN32
+            UnmapViewOfFile(m_address);
+#else
+            munmap(m_address, m_size);
+#endif
+         }
+
+         MappedFile(const MappedFile&) = delete;
+         MappedFile& operator=(const MappedFile&) = delete;
+
+         /**
+          * @returns The first byte of the mapped file.
+          */
+         inline const char* GetData() const noexcept
+         {
+            return static_cast<const char*>(m_address);
+         }
+
+         /**
+          * @returns The size of the mapped file, in bytes.
+          */
+         inline std::size_t GetSize() const noexcept
+         {
+            return m_size;
+         }
+
+       private:
+         void* m_address{ nullptr };
+         std::size_t m_size{ 0 };
+      };
+
+      /**
+       * @brief Writes the specified number of zero bytes to the stream.
+       */
+      inline void WritePadding(std::ofstream& stream, std::uint64_t byteCount)
+      {
+         static const char zeros[SECTION_ALIGNMENT] = {};
+         stream.write(zeros, static_cast<std::streamsize>(byteCount));
+      }
+   } // namespace Internals
+
+   /**
+    * @brief Writes the FrozenTree to a binary file.
+    *
+    * @throws std::runtime_error if the file can't be written.
+    */
+   template <typename DataType>
+   void WriteToFile(const FrozenTree<DataType>& tree, const std::string& fileName)
+   {
+      static_assert(
+          std::is_trivially_copyable<DataType>::value,
+          "Only trivially copyable data can be written byte for byte.");
+
+      static_assert(alignof(DataType) <= SECTION_ALIGNMENT, "The data is over-aligned.");
+
+      using IndexType = typename FrozenTree<DataType>::IndexType;
+
+      const auto nodeCount = static_cast<std::uint64_t>(tree.Size());
+      const auto header = Internals::MakeHeader<DataType>(nodeCount);
+
+      std::ofstream stream{ fileName, std::ios::binary | std::ios::trunc };
+
+      stream.write(reinterpret_cast<const char*>(&header), sizeof header);
+      Internals::WritePadding(stream, header.parentsOffset - sizeof header);
+
+      const auto indexBytes = nodeCount * sizeof(IndexType);
+
+      stream.write(
+          reinterpret_cast<const char*>(tree.GetParentIndices()),
+          static_cast<std::streamsize>(indexBytes));
+      Internals::WritePadding(
+          stream, header.subtreeSizesOffset - header.parentsOffset - indexBytes);
+
+      stream.write(
+          reinterpret_cast<const char*>(tree.GetSubtreeSizes()),
+          static_cast<std::streamsize>(indexBytes));
+      Internals::WritePadding(stream, header.dataOffset - header.subtreeSizesOffset - indexBytes);
+
+      stream.write(
+          reinterpret_cast<const char*>(tree.GetDataArray()),
+          static_cast<std::streamsize>(nodeCount * sizeof(DataType)));
+
+      stream.flush();
+
+      if (!stream)
+      {
+         throw std::runtime_error{ "Could not write: " + fileName };
+      }
+   }
+
+   /**
+    * @overload
+    */
+   template <typename DataType, typename PolicyType>
+   void WriteToFile(const Tree<DataType, PolicyType>& tree, const std::string& fileName)
+   {
+      WriteToFile(tree.Freeze(), fileName);
+   }
+
+   /**
+    * @brief Maps a file that was written by WriteToFile(...) into memory, and hands back a
+    * FrozenTree that reads straight from the mapped file.
+    *
+    * Only the header and the topology are verified; the data isn't touched until it's read,
+    * which means that the operating system only pages in those parts of the file that are
+    * actually used.
+    *
+    * @throws std::runtime_error if the file can't be mapped, was written by an incompatible
+    * version, holds a different type of data, or is corrupt.
+    */
+   template <typename DataType>
+   FrozenTree<DataType> MapFromFile(const std::string& fileName)
+   {
+      static_assert(
+          std::is_trivially_copyable<DataType>::value,
+          "Only trivially copyable data can be read byte for byte.");
+
+      using IndexType = typename FrozenTree<DataType>::IndexType;
+
+      auto file = std::make_shared<const Internals::MappedFile>(fileName);
+
+      FileHeader header;
+      if (file->GetSize() < sizeof header)
+      {
+         throw std::runtime_error{ "Not a tree file: " + fileName };
+      }
+
+      std::memcpy(&header, file->GetData(), sizeof header);
+
+      if (std::memcmp(header.magic, Internals::MAGIC, sizeof Internals::MAGIC) != 0)
+      {
+         throw std::runtime_error{ "Not a tree file: " + fileName };
+      }
+
+      if (header.version != FORMAT_VERSION || header.byteOrderMark != Internals::BYTE_ORDER_MARK)
+      {
+         throw std::runtime_error{ "Incompatible tree file: " + fileName };
+      }
+
+      if (header.indexSize != sizeof(IndexType) || header.dataSize != sizeof(DataType) ||
+          header.dataAlignment != alignof(DataType))
+      {
+         throw std::runtime_error{ "The tree file holds a different type of data: " + fileName };
+      }
+
+      // Recomputing the layout from the node count, rather than trusting the offsets, guarantees
+      // that every section is properly aligned and within bounds:
+      const auto expectedHeader = Internals::MakeHeader<DataType>(header.nodeCount);
+      if (header.nodeCount >= FrozenTree<DataType>::INVALID_INDEX ||
+          header.parentsOffset != expectedHeader.parentsOffset ||
+          header.subtreeSizesOffset != expectedHeader.subtreeSizesOffset ||
+          header.dataOffset != expectedHeader.dataOffset ||
+          header.fileSize != expectedHeader.fileSize || header.fileSize != file->GetSize())
+      {
+         throw std::runtime_error{ "Corrupt tree file: " + fileName };
+      }
+
+      const auto* const base = file->GetData();
+      const auto nodeCount = static_cast<std::size_t>(header.nodeCount);
+
+      const auto* const parents = reinterpret_cast<const IndexType*>(base + header.parentsOffset);
+      const auto* const subtreeSizes =
+          reinterpret_cast<const IndexType*>(base + header.subtreeSizesOffset);
+      const auto* const data = reinterpret_cast<const DataType*>(base + header.dataOffset);
+
+      if (!FrozenTree<DataType>::IsValidLayout(parents, subtreeSizes, nodeCount))
+      {
+         throw std::runtime_error{ "Corrupt tree file: " + fileName };
+      }
+
+      return FrozenTree<DataType>{ std::move(file), parents, subtreeSizes, data, nodeCount };
+   }
+} // namespace TreeSerialization
@@ -1,81 +1,439 @@
 #pragma once
 
 #include <algorithm>
-#include <codecvt>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
-#include <iostream>
-#include <locale>
+#include <limits>
+#include <memory>
+#include <ostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "Tree.hpp"
 
-namespace
+namespace TreeUtilities
 {
    /**
-    * @brief Allows std::wstring data to be output to a narrow stream.
-    *
-    * @note Depending on what code page is active, this may not do what you expect.
+    * @brief The formats that a Tree can be exported to.
     */
-   std::ostream& operator<<(std::ostream& stream, std::wstring wideString)
+   enum class ExportFormat
    {
-      using WideToNarrowConverterType = std::codecvt_utf8<wchar_t>;
-      thread_local static std::wstring_convert<WideToNarrowConverterType, wchar_t> converter;
+      /**
+       * A Graphviz digraph, with one node declaration and one edge declaration per line.
+       */
+      DOT,
 
-      stream << converter.to_bytes(wideString);
-      return stream;
-   }
-}
+      /**
+       * One JSON object per line and per node, of the form:
+       * {"id":1,"parent":0,"depth":1,"label":"B"}. The root has a null parent.
+       */
+      JSON_LINES
+   };
 
-namespace TreeUtilities
-{
-   template <typename NodeType>
-   void OutputToDotFile(const Tree<NodeType>& tree, const std::string& fileName)
+   /**
+    * @brief Controls what part of a Tree gets exported, and how.
+    */
+   struct ExportOptions
+   {
+      ExportFormat format{ ExportFormat::DOT };
+
+      /**
+       * Nodes deeper than this are left out, along with their subtrees. The root is at depth zero.
+       */
+      std::size_t maximumDepth{ std::numeric_limits<std::size_t>::max() };
+
+      /**
+       * The export stops, leaving behind a well-formed file, once this many nodes are written.
+       */
+      std::size_t maximumNodeCount{ std::numeric_limits<std::size_t>::max() };
+
+      /**
+       * The size, in bytes, of the write buffer used by ExportToFile(...).
+       */
+      std::size_t bufferSize{ std::size_t{ 1 } << 20 };
+   };
+
+   namespace Internals
    {
-      std::stringstream graphStream;
+      constexpr auto NO_PARENT = std::numeric_limits<std::size_t>::max();
 
-      graphStream << "digraph {\n"
-                  << "   rankdir = TB;\n"
-                  << "   edge [arrowsize=0.4, fontsize=10]\n";
+      /**
+       * @brief The default label function, which labels each node with its data.
+       */
+      struct DataLabel
+      {
+         template <typename NodeType>
+         const auto& operator()(const NodeType& node) const noexcept
+         {
+            return node.GetData();
+         }
+      };
 
-      const Node<NodeType>* head = tree.GetRoot();
+      /**
+       * @brief Writes a single character to the stream, escaped such that it can appear within a
+       * quoted string in either of the supported formats.
+       */
+      inline void WriteEscaped(std::ostream& stream, char character)
+      {
+         switch (character)
+         {
+            case '"':
+               stream.write("\\\"", 2);
+               return;
+            case '\\':
+               stream.write("\\\\", 2);
+               return;
+            case '\n':
+               stream.write("\\n", 2);
+               return;
+            case '\t':
+               stream.write("\\t", 2);
+               return;
+            case '\r':
+               stream.write("\\r", 2);
+               return;
+            default:
+               break;
+         }
 
-      graphStream << "\n"
-                  << "   // Node Declarations:\n";
+         // Neither format allows for raw control characters within a quoted string:
+         stream.put(static_cast<unsigned char>(character) < 0x20 ? ' ' : character);
+      }
 
-      std::for_each(
-          Tree<NodeType>::PreOrderIterator{ head },
-          Tree<NodeType>::PreOrderIterator{},
-          [&](Tree<NodeType>::const_reference node) {
-             const auto nodeLabel = std::to_string(reinterpret_cast<size_t>(&node));
-             const auto& data = node.GetData();
+      /**
+       * @brief Writes the code point to the stream, encoded as UTF-8.
+       */
+      inline void WriteUtf8(std::ostream& stream, std::uint32_t codePoint)
+      {
+         if (codePoint < 0x80)
+         {
+            WriteEscaped(stream, static_cast<char>(codePoint));
+         }
+         else if (codePoint < 0x800)
+         {
+            stream.put(static_cast<char>(0xC0 | (codePoint >> 6)));
+            stream.put(static_cast<char>(0x80 | (codePoint & 0x3F)));
+         }
+         else if (codePoint < 0x10000)
+         {
+            stream.put(static_cast<char>(0xE0 | (codePoint >> 12)));
+            stream.put(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            stream.put(static_cast<char>(0x80 | (codePoint & 0x3F)));
+         }
+         else
+         {
+            stream.put(static_cast<char>(0xF0 | (codePoint >> 18)));
+            stream.put(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            stream.put(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            stream.put(static_cast<char>(0x80 | (codePoint & 0x3F)));
+         }
+      }
 
-             graphStream << "   " << nodeLabel << " [label = \"" << data << "\"]\n";
-          });
+      /**
+       * @brief Writes a narrow string label, escaping it one character at a time.
+       */
+      inline void WriteLabel(std::ostream& stream, const char* label)
+      {
+         for (; *label; ++label)
+         {
+            WriteEscaped(stream, *label);
+         }
+      }
+
+      /**
+       * @overload
+       */
+      inline void WriteLabel(std::ostream& stream, const std::string& label)
+      {
+         for (const auto character : label)
+         {
+            WriteEscaped(stream, character);
+         }
+      }
+
+      /**
+       * @brief Writes a wide string label, converting it to UTF-8 on the fly. Wide strings are
+       * taken to be UTF-16 when wchar_t is 16 bits wide, and UTF-32 otherwise. Unpaired
+       * surrogates are replaced by U+FFFD.
+       */
+      inline void WriteLabel(std::ostream& stream, const std::wstring& label)
+      {
+         constexpr std::uint32_t REPLACEMENT_CHARACTER{ 0xFFFD };
+
+         for (std::size_t index = 0; index < label.size(); ++index)
+         {
+            auto codePoint = static_cast<std::uint32_t>(label[index]);
+
+            if (sizeof(wchar_t) == 2 && codePoint >= 0xD800 && codePoint <= 0xDFFF)
+            {
+               const auto next = index + 1 < label.size()
+                                     ? static_cast<std::uint32_t>(label[index + 1])
+                                     : std::uint32_t{ 0 };
+
+               if (codePoint <= 0xDBFF && next >= 0xDC00 && next <= 0xDFFF)
+               {
+                  codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (next - 0xDC00);
+                  ++index;
+               }
+               else
+               {
+                  codePoint = REPLACEMENT_CHARACTER;
+               }
+            }
+            else if (codePoint > 0x10FFFF)
+            {
+               codePoint = REPLACEMENT_CHARACTER;
+            }
+
+            WriteUtf8(stream, codePoint);
+         }
+      }
+
+      /**
+       * @brief Whether the type holds characters, which are arithmetic, but have to be written as
+       * text rather than as numbers.
+       */
+      template <typename Type>
+      struct IsCharacter
+          : std::integral_constant<
+                bool,
+                std::is_same<Type, char>::value || std::is_same<Type, signed char>::value ||
+                    std::is_same<Type, unsigned char>::value ||
+                    std::is_same<Type, wchar_t>::value || std::is_same<Type, char16_t>::value ||
+                    std::is_same<Type, char32_t>::value>
+      {
+      };
+
+      /**
+       * @brief Writes a single character label, escaping it like any other text. Wide characters
+       * are taken to be code points, which means that a lone surrogate is replaced by U+FFFD.
+       */
+      template <typename LabelType>
+      auto WriteLabel(std::ostream& stream, const LabelType& label) ->
+          typename std::enable_if<IsCharacter<LabelType>::value>::type
+      {
+         if (sizeof(LabelType) == 1)
+         {
+            WriteEscaped(stream, static_cast<char>(label));
+            return;
+         }
+
+         const auto codePoint = static_cast<std::uint32_t>(label);
+         const auto isValid = codePoint < 0xD800 || (codePoint > 0xDFFF && codePoint <= 0x10FFFF);
+
+         WriteUtf8(stream, isValid ? codePoint : std::uint32_t{ 0xFFFD });
+      }
+
+      /**
+       * @brief Writes a numeric label straight to the stream, since it can't contain anything
+       * that would need escaping.
+       */
+      template <typename LabelType>
+      auto WriteLabel(std::ostream& stream, const LabelType& label) ->
+          typename std::enable_if<
+              std::is_arithmetic<LabelType>::value && !IsCharacter<LabelType>::value>::type
+      {
+         stream << label;
+      }
+
+      /**
+       * @brief Writes any other label that can be streamed, by first formatting it into a
+       * reusable string, and then escaping that string.
+       */
+      template <typename LabelType>
+      auto WriteLabel(std::ostream& stream, const LabelType& label) ->
+          typename std::enable_if<
+              !std::is_arithmetic<LabelType>::value &&
+              !std::is_convertible<const LabelType&, const char*>::value>::type
+      {
+         thread_local std::ostringstream formatter;
+
+         formatter.str({});
+         formatter << label;
+
+         WriteLabel(stream, formatter.str());
+      }
+
+      /**
+       * @brief Visits the nodes of a Tree in pre-order, in a single pass, handing each one to the
+       * visitor along with its sequential ID, the ID of its parent, and its depth. Only the IDs
+       * of the ancestors of the current node are kept around, so the memory used is proportional
+       * to the height of the Tree, rather than to its size.
+       *
+       * @returns The number of nodes visited.
+       */
+      template <typename DataType, typename PolicyType, typename VisitorType>
+      std::size_t VisitInPreOrder(
+          const Tree<DataType, PolicyType>& tree,
+          const ExportOptions& options,
+          const VisitorType& visitor)
+      {
+         using NodeType = typename Tree<DataType, PolicyType>::Node;
+
+         std::vector<std::size_t> ancestorIds;
+         std::size_t nextId{ 0 };
+
+         const NodeType* node = tree.GetRoot();
+         while (node && nextId < options.maximumNodeCount)
+         {
+            const auto id = nextId++;
+            const auto parentId = ancestorIds.empty() ? NO_PARENT : ancestorIds.back();
+
+            visitor(*node, id, parentId, ancestorIds.size());
+
+            if (node->HasChildren() && ancestorIds.size() < options.maximumDepth)
+            {
+               ancestorIds.emplace_back(id);
+               node = node->GetFirstChild();
+               continue;
+            }
 
-      graphStream << "\n"
-                  << "   // Edge Declarations:\n";
+            // Climb back up until there's a sibling left to visit, or we're back at the root:
+            while (!ancestorIds.empty() && !node->GetNextSibling())
+            {
+               ancestorIds.pop_back();
+               node = node->GetParent();
+            }
 
-      std::for_each(
-          Tree<NodeType>::PreOrderIterator{ head },
-          Tree<NodeType>::PreOrderIterator{},
-          [&](Tree<NodeType>::const_reference node) {
-             const auto* parent = node.GetParent();
-             if (!parent)
+            if (ancestorIds.empty())
+            {
+               break;
+            }
+
+            node = node->GetNextSibling();
+         }
+
+         return nextId;
+      }
+   } // namespace Internals
+
+   /**
+    * @brief Exports the Tree to the stream in a single pass, without buffering anything beyond
+    * what the stream itself buffers. Nodes are identified by their pre-order position, rather than
+    * by their address, which keeps the output compact and reproducible.
+    *
+    * @param[in] tree                The Tree to export.
+    * @param[in] stream              The stream to write to.
+    * @param[in] options             What to export, and in which format.
+    * @param[in] label               A function that takes a Node and returns its label, which can
+    *                                be a narrow or a wide string, a number, or anything that can
+    *                                otherwise be streamed. Labels are escaped as needed.
+    *
+    * @returns The number of nodes that were exported.
+    */
+   template <
+       typename DataType,
+       typename PolicyType,
+       typename LabelFunctionType = Internals::DataLabel>
+   std::size_t ExportToStream(
+       const Tree<DataType, PolicyType>& tree,
+       std::ostream& stream,
+       const ExportOptions& options = {},
+       const LabelFunctionType& label = {})
+   {
+      using NodeType = typename Tree<DataType, PolicyType>::Node;
+
+      if (options.format == ExportFormat::JSON_LINES)
+      {
+         return Internals::VisitInPreOrder(
+             tree,
+             options,
+             [&](const NodeType& node, std::size_t id, std::size_t parentId, std::size_t depth) {
+                stream << "{\"id\":" << id << ",\"parent\":";
+
+                if (parentId == Internals::NO_PARENT)
+                {
+                   stream << "null";
+                }
+                else
+                {
+                   stream << parentId;
+                }
+
+                stream << ",\"depth\":" << depth << ",\"label\":\"";
+                Internals::WriteLabel(stream, label(node));
+                stream << "\"}\n";
+             });
+      }
+
+      stream << "digraph {\n"
+             << "   rankdir = TB;\n"
+             << "   edge [arrowsize=0.4, fontsize=10]\n"
+             << "\n";
+
+      // Since DOT doesn't require nodes to be declared before they're used, each node is declared
+      // right alongside the edge that leads to it:
+      const auto nodeCount = Internals::VisitInPreOrder(
+          tree,
+          options,
+          [&](const NodeType& node, std::size_t id, std::size_t parentId, std::size_t /*depth*/) {
+             stream << "   " << id << " [label = \"";
+             Internals::WriteLabel(stream, label(node));
+             stream << "\"]\n";
+
+             if (parentId != Internals::NO_PARENT)
              {
-                return;
+                stream << "   " << parentId << " -> " << id << "\n";
              }
+          });
 
-             const auto parentLabel = std::to_string(reinterpret_cast<std::size_t>(parent));
-             const auto childLabel = std::to_string(reinterpret_cast<std::size_t>(&node));
+      stream << "}\n";
 
-             graphStream << "   " << parentLabel << " -> " << childLabel << "\n";
-          });
+      return nodeCount;
+   }
+
+   /**
+    * @brief Exports the Tree to a file, through a single write buffer of the size given in the
+    * options.
+    *
+    * @see ExportToStream(...)
+    *
+    * @throws std::runtime_error if the file can't be written.
+    *
+    * @returns The number of nodes that were exported.
+    */
+   template <
+       typename DataType,
+       typename PolicyType,
+       typename LabelFunctionType = Internals::DataLabel>
+   std::size_t ExportToFile(
+       const Tree<DataType, PolicyType>& tree,
+       const std::string& fileName,
+       const ExportOptions& options = {},
+       const LabelFunctionType& label = {})
+   {
+      const auto bufferSize = std::max<std::size_t>(options.bufferSize, 1);
+      const auto buffer = std::make_unique<char[]>(bufferSize);
 
-      graphStream << "}" << std::flush;
+      // The buffer has to be installed before the file is opened for it to take effect:
+      std::ofstream stream;
+      stream.rdbuf()->pubsetbuf(buffer.get(), static_cast<std::streamsize>(bufferSize));
+      stream.open(fileName, std::ios::binary | std::ios::trunc);
 
-      std::ofstream outputFile{ fileName, std::ofstream::out };
+      const auto nodeCount = ExportToStream(tree, stream, options, label);
 
-      outputFile << graphStream.rdbuf();
+      stream.close();
+
+      if (!stream)
+      {
+         throw std::runtime_error{ "Could not write: " + fileName };
+      }
+
+      return nodeCount;
+   }
+
+   /**
+    * @brief Exports the whole Tree to a DOT file, labelling each node with its data.
+    *
+    * @see ExportToFile(...)
+    */
+   template <typename DataType, typename PolicyType>
+   void OutputToDotFile(const Tree<DataType, PolicyType>& tree, const std::string& fileName)
+   {
+      ExportToFile(tree, fileName);
    }
-}
+} // namespace TreeUtilities
@@ -4,8 +4,33 @@
 #include "Catch.hpp"
 
 #include "../Tree/Tree.hpp"
+#include "../Tree/TreeAlgorithms.hpp"
+#include "../Tree/TreeSerialization.hpp"
+#include "../Tree/TreeUtilities.hpp"
+
+#include "../Benchmarks/DriveScanner.h"
+#include "../Benchmarks/FileColumns.h"
+#include "../Benchmarks/PathIndex.h"
+#include "../Benchmarks/ScanFile.h"
+#include "../Benchmarks/StringPool.h"
+#include "../Benchmarks/ThreadSafeQueue.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 namespace
@@ -52,6 +77,24 @@ namespace
       std::string m_data;
    };
 
+   /**
+    * @brief Data that refuses to be constructed from negative numbers.
+    */
+   struct PositiveNumber
+   {
+      PositiveNumber() noexcept = default;
+
+      PositiveNumber(int value) : m_value{ value }
+      {
+         if (value < 0)
+         {
+            throw std::invalid_argument{ "Negative number." };
+         }
+      }
+
+      int m_value{ 0 };
+   };
+
    /**
     * @brief Allows for the comparison of vectors of unequal length.
     *
@@ -126,6 +169,96 @@ namespace
 
       REQUIRE(allNodesHaveIdenticalParent == true);
    }
+
+   /**
+    * @brief A directory for the scanner tests to fill with files, which is deleted again, along
+    * with everything in it, once the test is done with it.
+    */
+   class ScratchDirectory
+   {
+    public:
+      explicit ScratchDirectory(const std::string& name)
+          : m_path{ std::experimental::filesystem::temp_directory_path() / name }
+      {
+         std::experimental::filesystem::remove_all(m_path);
+         std::experimental::filesystem::create_directories(m_path);
+      }
+
+      ~ScratchDirectory()
+      {
+         std::error_code error;
+         std::experimental::filesystem::remove_all(m_path, error);
+      }
+
+      ScratchDirectory(const ScratchDirectory&) = delete;
+      ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+      /**
+       * @brief Creates or overwrites a file of the specified size, along with any directories
+       * that lead up to it.
+       */
+      void WriteFile(const std::string& relativePath, std::size_t size) const
+      {
+         const auto path = GetPath(relativePath);
+         std::experimental::filesystem::create_directories(path.parent_path());
+
+         std::ofstream{ path.string(), std::ios::binary | std::ios::trunc }
+             << std::string(size, 'x');
+      }
+
+      /**
+       * @brief Creates a directory, along with any directories that lead up to it.
+       */
+      void MakeDirectory(const std::string& relativePath) const
+      {
+         std::experimental::filesystem::create_directories(GetPath(relativePath));
+      }
+
+      /**
+       * @brief Removes a file, or a directory along with everything in it.
+       */
+      void Remove(const std::string& relativePath) const
+      {
+         std::experimental::filesystem::remove_all(GetPath(relativePath));
+      }
+
+      /**
+       * @returns The path of an entry within the directory, or of the directory itself.
+       */
+      std::experimental::filesystem::path GetPath(const std::string& relativePath = {}) const
+      {
+         return relativePath.empty() ? m_path : m_path / relativePath;
+      }
+
+    private:
+      std::experimental::filesystem::path m_path;
+   };
+
+   /**
+    * @brief Verifies that every directory in a scanned tree is exactly as large as its children
+    * combined, and that no Node, save for the root, is empty.
+    */
+   void VerifyDirectorySizes(const Tree<FileInfo>& tree)
+   {
+      std::for_each(
+          tree.beginPreOrder(), tree.endPreOrder(), [](const Tree<FileInfo>::Node& node) {
+             std::uintmax_t childSizes{ 0 };
+             for (auto* child = node.GetFirstChild(); child; child = child->GetNextSibling())
+             {
+                childSizes += child->GetData().size;
+             }
+
+             if (node.GetData().type == FileType::DIRECTORY)
+             {
+                REQUIRE(node.GetData().size == childSizes);
+             }
+
+             if (node.GetParent())
+             {
+                REQUIRE(node.GetData().size > 0);
+             }
+          });
+   }
 } // namespace
 
 TEST_CASE("Node Construction and Assignment")
@@ -481,6 +614,102 @@ TEST_CASE("Partial Tree Iteration Corner Cases")
    }
 }
 
+TEST_CASE("Skipping Subtrees")
+{
+   Tree<std::string> tree{ "F" };
+
+   tree.GetRoot()->AppendChild("B")->AppendChild("A");
+   tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+   tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+   const auto collectSkipping = [](auto begin, auto end, const std::string& skipped) {
+      std::vector<std::string> visited;
+      for (auto itr = begin; itr != end; ++itr)
+      {
+         visited.emplace_back(itr->GetData());
+         if (itr->GetData() == skipped)
+         {
+            itr.SkipChildren();
+         }
+      }
+
+      return visited;
+   };
+
+   SECTION("Skipping a Subtree with a Next Sibling")
+   {
+      const std::vector<std::string> expected = { "F", "B", "G", "I", "H" };
+      const auto actual = collectSkipping(tree.beginPreOrder(), tree.endPreOrder(), "B");
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Skipping the Last Subtree of a Parent")
+   {
+      const std::vector<std::string> expected = { "F", "B", "A", "D", "G", "I", "H" };
+      const auto actual = collectSkipping(tree.beginPreOrder(), tree.endPreOrder(), "D");
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Skipping the Children of a Leaf")
+   {
+      const std::vector<std::string> expected = { "F", "B", "A", "D", "C", "E", "G", "I", "H" };
+      const auto actual = collectSkipping(tree.beginPreOrder(), tree.endPreOrder(), "A");
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Skipping Stays Within a Partial Iteration")
+   {
+      const std::vector<std::string> expected = { "B", "A", "D" };
+      const auto actual = collectSkipping(
+         decltype(tree)::PreOrderIterator{ tree.GetRoot()->GetFirstChild() },
+         decltype(tree)::PreOrderIterator{},
+         "D");
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Skipping the Root")
+   {
+      const std::vector<std::string> expected = { "F" };
+      const auto actual = collectSkipping(tree.beginPreOrder(), tree.endPreOrder(), "F");
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Traversing with a Visitor")
+   {
+      const std::vector<std::string> expected = { "F", "B", "G", "I", "H" };
+
+      std::vector<std::string> actual;
+      const auto visitedCount = TreeAlgorithms::Traverse(*tree.GetRoot(), [&](const auto& node) {
+         actual.emplace_back(node.GetData());
+         return node.GetData() != "B";
+      });
+
+      REQUIRE(visitedCount == expected.size());
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Traversing a Subtree with a Visitor")
+   {
+      const std::vector<std::string> expected = { "D", "C", "E" };
+
+      std::vector<std::string> actual;
+      const auto visitedCount = TreeAlgorithms::Traverse(
+         *tree.GetRoot()->GetFirstChild()->GetLastChild(), [&](const auto& node) {
+            actual.emplace_back(node.GetData());
+            return true;
+         });
+
+      REQUIRE(visitedCount == expected.size());
+      VerifyTraversal(expected, actual);
+   }
+}
+
 TEST_CASE("STL Typedef Compliance")
 {
    Tree<std::string> tree{ "F" };
@@ -604,6 +833,202 @@ TEST_CASE("Sibling Iterator")
    }
 }
 
+TEST_CASE("Level-Order Iterator")
+{
+   Tree<std::string> tree{ "F" };
+
+   tree.GetRoot()->AppendChild("B")->AppendChild("A");
+   tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+   tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+   SECTION("Tree<T>::beginLevelOrder and Tree<T>::endLevelOrder")
+   {
+      const std::vector<std::string> expected = { "F", "B", "G", "A", "D", "I", "C", "E", "H" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          tree.beginLevelOrder(),
+          tree.endLevelOrder(),
+          std::back_inserter(actual),
+          [](Tree<std::string>::const_reference node) { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Partial Tree Iteration")
+   {
+      const std::vector<std::string> expected = { "B", "A", "D", "C", "E" };
+
+      const auto begin = decltype(tree)::LevelOrderIterator{ tree.GetRoot()->GetFirstChild() };
+      const auto end = decltype(tree)::LevelOrderIterator{};
+
+      std::vector<std::string> actual;
+      std::transform(begin, end, std::back_inserter(actual), [](const auto& node) noexcept {
+         return node.GetData();
+      });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Depth Tracking")
+   {
+      const std::vector<unsigned int> expected = { 0, 1, 1, 2, 2, 2, 3, 3, 3 };
+
+      std::vector<unsigned int> actual;
+      for (auto itr = tree.beginLevelOrder(); itr != tree.endLevelOrder(); ++itr)
+      {
+         REQUIRE(itr.GetDepth() == Tree<std::string>::Depth(*itr));
+         actual.emplace_back(itr.GetDepth());
+      }
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Skipping a Subtree")
+   {
+      const std::vector<std::string> expected = { "F", "B", "G", "A", "D", "I", "H" };
+
+      std::vector<std::string> actual;
+      for (auto itr = tree.beginLevelOrder(); itr != tree.endLevelOrder(); ++itr)
+      {
+         actual.emplace_back(itr->GetData());
+         if (itr->GetData() == "D")
+         {
+            itr.SkipChildren();
+         }
+      }
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Single Node Tree")
+   {
+      Tree<std::string> singleNodeTree{ "X" };
+
+      auto itr = singleNodeTree.beginLevelOrder();
+      REQUIRE(itr->GetData() == "X");
+      REQUIRE(++itr == singleNodeTree.endLevelOrder());
+   }
+}
+
+TEST_CASE("Internal Iteration")
+{
+   Tree<std::string> tree{ "F" };
+
+   tree.GetRoot()->AppendChild("B")->AppendChild("A");
+   tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+   tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+   const auto collect = [](std::vector<std::string>& names) {
+      return [&](const Tree<std::string>::Node& node) { names.emplace_back(node.GetData()); };
+   };
+
+   SECTION("Pre-Order Traversal")
+   {
+      const std::vector<std::string> expected = { "F", "B", "A", "D", "C", "E", "G", "I", "H" };
+
+      std::vector<std::string> actual;
+      tree.ForEach<PreOrderTraversal>(collect(actual));
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Post-Order Traversal")
+   {
+      const std::vector<std::string> expected = { "A", "C", "E", "D", "B", "H", "I", "G", "F" };
+
+      std::vector<std::string> actual;
+      tree.ForEach<PostOrderTraversal>(collect(actual));
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Level-Order Traversal")
+   {
+      const std::vector<std::string> expected = { "F", "B", "G", "A", "D", "I", "C", "E", "H" };
+
+      std::vector<std::string> actual;
+      tree.ForEach<LevelOrderTraversal>(collect(actual));
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Leaf Traversal")
+   {
+      const std::vector<std::string> expected = { "A", "C", "E", "H" };
+
+      std::vector<std::string> actual;
+      tree.ForEach<LeafTraversal>(collect(actual));
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Subtree Traversal Matches the Iterators")
+   {
+      const auto& subtree = *tree.GetRoot()->GetFirstChild()->GetLastChild();
+
+      std::vector<std::string> expected;
+      std::vector<std::string> actual;
+
+      std::for_each(
+          Tree<std::string>::PreOrderIterator{ &subtree },
+          Tree<std::string>::PreOrderIterator{},
+          collect(expected));
+      Tree<std::string>::ForEach<PreOrderTraversal>(subtree, collect(actual));
+      VerifyTraversal(expected, actual);
+
+      expected.clear();
+      actual.clear();
+
+      std::for_each(
+          Tree<std::string>::PostOrderIterator{ &subtree },
+          Tree<std::string>::PostOrderIterator{},
+          collect(expected));
+      Tree<std::string>::ForEach<PostOrderTraversal>(subtree, collect(actual));
+      VerifyTraversal(expected, actual);
+
+      expected.clear();
+      actual.clear();
+
+      std::for_each(
+          Tree<std::string>::LeafIterator{ &subtree },
+          Tree<std::string>::LeafIterator{},
+          collect(expected));
+      Tree<std::string>::ForEach<LeafTraversal>(subtree, collect(actual));
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Single Node Subtree")
+   {
+      auto& leaf = *tree.GetRoot()->GetLastChild()->GetFirstChild()->GetFirstChild();
+
+      std::vector<std::string> actual;
+      Tree<std::string>::ForEach<PreOrderTraversal>(leaf, collect(actual));
+      Tree<std::string>::ForEach<PostOrderTraversal>(leaf, collect(actual));
+      Tree<std::string>::ForEach<LevelOrderTraversal>(leaf, collect(actual));
+      Tree<std::string>::ForEach<LeafTraversal>(leaf, collect(actual));
+
+      VerifyTraversal({ "H", "H", "H", "H" }, actual);
+   }
+
+   SECTION("Deleting Nodes During a Post-Order Traversal")
+   {
+      Tree<std::string>::ForEach<PostOrderTraversal>(
+          *tree.GetRoot()->GetFirstChild(),
+          [](Tree<std::string>::Node& node) { node.DeleteFromTree(); });
+
+      const std::vector<std::string> expected = { "F", "G", "I", "H" };
+
+      std::vector<std::string> actual;
+      tree.ForEach<PreOrderTraversal>(collect(actual));
+
+      VerifyTraversal(expected, actual);
+      REQUIRE(tree.Size() == 4);
+   }
+}
+
 TEST_CASE("Sorting")
 {
    SECTION("Preserve Next and Previous Pointers")
@@ -717,36 +1142,145 @@ TEST_CASE("Sorting")
 
       VerifyTraversal(expected, actual);
    }
-}
-
-TEST_CASE("Node Copying")
-{
-   Tree<std::string>::Node node{ "Node" };
 
-   const auto copy = node;
+   // Pairs of a sort key and the original position, so that stability can be verified:
+   using KeyedTree = Tree<std::pair<int, int>>;
 
-   REQUIRE(node.GetData() == copy.GetData());
-}
+   const auto byKey = [](const KeyedTree::Node& lhs, const KeyedTree::Node& rhs) {
+      return lhs.GetData().first < rhs.GetData().first;
+   };
 
-TEST_CASE("Tree Copying")
-{
-   Tree<std::string> tree{ "F" };
+   const auto isSortedStably = [](const KeyedTree::Node& node) {
+      const KeyedTree::Node* previous = nullptr;
+      for (auto* child = node.GetFirstChild(); child; child = child->GetNextSibling())
+      {
+         if (child->GetPreviousSibling() != previous)
+         {
+            return false;
+         }
 
-   tree.GetRoot()->AppendChild("B")->AppendChild("A");
-   tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
-   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
-   tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+         if (previous && previous->GetData() > child->GetData())
+         {
+            return false;
+         }
 
-   const auto copy = tree;
+         previous = child;
+      }
 
-   REQUIRE(tree.Size() == copy.Size());
+      return previous == node.GetLastChild();
+   };
 
-   SECTION("Pre-order Verification")
+   SECTION("Stability of Equal Keys")
    {
-      const std::vector<std::string> expected = { "F", "B", "A", "D", "C", "E", "G", "I", "H" };
+      KeyedTree tree{ { 0, 0 } };
+      for (int index = 0; index < 100; ++index)
+      {
+         tree.GetRoot()->AppendChild({ (index * 37 + 11) % 7, index });
+      }
 
-      std::vector<std::string> actual;
-      std::transform(
+      tree.GetRoot()->SortChildren(byKey);
+
+      REQUIRE(tree.GetRoot()->GetChildCount() == 100);
+      REQUIRE(isSortedStably(*tree.GetRoot()));
+   }
+
+   SECTION("A Throwing Comparator Leaves the Order Untouched")
+   {
+      KeyedTree tree{ { 0, 0 } };
+      for (int index = 0; index < 10; ++index)
+      {
+         tree.GetRoot()->AppendChild({ 10 - index, index });
+      }
+
+      int comparisons = 0;
+      const auto throwingComparator = [&](const auto& lhs, const auto& rhs) {
+         if (++comparisons == 5)
+         {
+            throw std::runtime_error{ "Comparison failed." };
+         }
+
+         return byKey(lhs, rhs);
+      };
+
+      REQUIRE_THROWS_AS(tree.GetRoot()->SortChildren(throwingComparator), std::runtime_error);
+
+      int expectedPosition = 0;
+      for (auto* child = tree.GetRoot()->GetFirstChild(); child; child = child->GetNextSibling())
+      {
+         REQUIRE(child->GetData().second == expectedPosition++);
+      }
+   }
+
+   SECTION("Parallel Sorting of a Wide Node")
+   {
+      constexpr int CHILD_COUNT{ 50'000 };
+
+      KeyedTree tree{ { 0, 0 } };
+      for (int index = 0; index < CHILD_COUNT; ++index)
+      {
+         tree.GetRoot()->AppendChild({ (index * 7919) % 1000, index });
+      }
+
+      tree.GetRoot()->SortChildren(byKey, TreeAlgorithms::ParallelStableSort{ 4 });
+
+      REQUIRE(tree.GetRoot()->GetChildCount() == CHILD_COUNT);
+      REQUIRE(isSortedStably(*tree.GetRoot()));
+   }
+
+   SECTION("Sorting an Entire Tree in Parallel")
+   {
+      KeyedTree tree{ { 0, 0 } };
+
+      // A handful of wide directories, alongside many narrow ones:
+      int position = 0;
+      for (int directory = 0; directory < 200; ++directory)
+      {
+         auto* const node = tree.GetRoot()->AppendChild({ directory % 13, position++ });
+
+         const auto childCount = directory % 50 == 0 ? 10'000 : directory % 9;
+         for (int child = 0; child < childCount; ++child)
+         {
+            node->AppendChild({ (child * 31 + directory) % 17, position++ });
+         }
+      }
+
+      const auto sizeBeforeSort = tree.Size();
+
+      TreeAlgorithms::SortTree(tree, byKey, 4);
+
+      REQUIRE(tree.Size() == sizeBeforeSort);
+      REQUIRE(std::all_of(tree.beginPreOrder(), tree.endPreOrder(), isSortedStably));
+   }
+}
+
+TEST_CASE("Node Copying")
+{
+   Tree<std::string>::Node node{ "Node" };
+
+   const auto copy = node;
+
+   REQUIRE(node.GetData() == copy.GetData());
+}
+
+TEST_CASE("Tree Copying")
+{
+   Tree<std::string> tree{ "F" };
+
+   tree.GetRoot()->AppendChild("B")->AppendChild("A");
+   tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+   tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+   const auto copy = tree;
+
+   REQUIRE(tree.Size() == copy.Size());
+
+   SECTION("Pre-order Verification")
+   {
+      const std::vector<std::string> expected = { "F", "B", "A", "D", "C", "E", "G", "I", "H" };
+
+      std::vector<std::string> actual;
+      std::transform(
           tree.beginPreOrder(),
           tree.endPreOrder(),
           std::back_inserter(actual),
@@ -770,6 +1304,255 @@ TEST_CASE("Tree Copying")
    }
 }
 
+TEST_CASE("Deep Trees")
+{
+   // Deep enough that destroying or copying the chain recursively would exhaust the stack:
+   constexpr int depth = 1'000'000;
+
+   const auto buildChain = [&](auto& tree) {
+      auto* node = tree.GetRoot();
+      for (int index = 1; index < depth; ++index)
+      {
+         node = node->AppendChild(index);
+      }
+
+      return node;
+   };
+
+   SECTION("Destruction")
+   {
+      auto tree = std::make_unique<Tree<int>>(0);
+      buildChain(*tree);
+
+      REQUIRE(tree->Size() == depth);
+
+      tree.reset();
+   }
+
+   SECTION("Copying")
+   {
+      Tree<int> tree{ 0 };
+      const auto* const deepestNode = buildChain(tree);
+
+      const auto copy = tree;
+
+      REQUIRE(copy.Size() == depth);
+      REQUIRE(Tree<int>::Depth(*deepestNode) == Tree<int>::Depth(*copy.beginLeaf()));
+      REQUIRE(copy.beginLeaf()->GetData() == depth - 1);
+   }
+
+   SECTION("Deleting a Deep Subtree")
+   {
+      Tree<int> tree{ 0 };
+      buildChain(tree);
+
+      tree.GetRoot()->AppendChild(-1);
+
+      auto* const subtree = tree.GetRoot()->GetFirstChild()->GetFirstChild();
+      subtree->DeleteFromTree();
+
+      REQUIRE(tree.Size() == 3);
+      REQUIRE(tree.GetRoot()->GetLastChild()->GetData() == -1);
+   }
+
+   SECTION("Destroying an Arena-Backed Tree")
+   {
+      auto tree = std::make_unique<Tree<int>>(0, std::make_unique<Tree<int>::NodeArena>());
+      buildChain(*tree);
+
+      REQUIRE(tree->Size() == depth);
+
+      tree.reset();
+   }
+
+   SECTION("Partitioning Without Tracked Subtree Sizes")
+   {
+      Tree<int> tree{ 0 };
+      buildChain(tree);
+
+      const auto partitions = TreeAlgorithms::PartitionTree(tree, 8);
+      REQUIRE(partitions.size() == 8);
+
+      constexpr std::size_t evenShare = depth / 8;
+      constexpr std::size_t maximumPieceSize = depth / 32;
+
+      std::vector<int> visits(depth, 0);
+      for (const auto& partition : partitions)
+      {
+         std::size_t nodeCount{ 0 };
+         partition.ForEach([&](const Tree<int>::Node& node) {
+            ++visits[node.GetData()];
+            ++nodeCount;
+         });
+
+         // No piece holds more than a thirty-second of the chain, and each piece goes to whichever
+         // partition is smallest at the time, so no partition strays from an even share by more
+         // than one piece:
+         REQUIRE(nodeCount == partition.Size());
+         REQUIRE(nodeCount >= evenShare - maximumPieceSize);
+         REQUIRE(nodeCount <= evenShare + maximumPieceSize);
+      }
+
+      REQUIRE(std::all_of(
+         std::begin(visits), std::end(visits), [](int visitCount) { return visitCount == 1; }));
+   }
+}
+
+TEST_CASE("Move Semantics and Single-Block Copies")
+{
+   const auto buildTree = [](std::unique_ptr<Tree<std::string>::NodeArena> arena) {
+      Tree<std::string> tree{ "F", std::move(arena) };
+      tree.GetRoot()->AppendChild("B")->AppendChild("A");
+      tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+      tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+      tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+      return tree;
+   };
+
+   const auto preOrder = [](const Tree<std::string>& tree) {
+      std::vector<std::string> labels;
+      std::transform(
+          tree.beginPreOrder(),
+          tree.endPreOrder(),
+          std::back_inserter(labels),
+          [](const auto& node) { return node.GetData(); });
+
+      return labels;
+   };
+
+   const std::vector<std::string> expected = { "F", "B", "A", "D", "C", "E", "G", "I", "H" };
+
+   SECTION("Moving a Tree Steals its Nodes")
+   {
+      auto source = buildTree(std::make_unique<Tree<std::string>::NodeArena>(4));
+      const auto* const root = source.GetRoot();
+      const auto* const arena = source.GetArena();
+
+      Tree<std::string> destination{ std::move(source) };
+
+      REQUIRE(source.GetRoot() == nullptr);
+      REQUIRE(destination.GetRoot() == root);
+      REQUIRE(destination.GetArena() == arena);
+      VerifyTraversal(expected, preOrder(destination));
+
+      source = std::move(destination);
+
+      REQUIRE(source.GetRoot() == root);
+      VerifyTraversal(expected, preOrder(source));
+   }
+
+   SECTION("Moves Don't Construct or Destroy Any Data")
+   {
+      Tree<VerboseNode> source{ "Root" };
+      source.GetRoot()->AppendChild(VerboseNode{ "Child" })->AppendChild(VerboseNode{ "Leaf" });
+
+      Global::ResetConstructionCount();
+      Global::ResetDestructionCount();
+
+      {
+         Tree<VerboseNode> destination{ std::move(source) };
+
+         REQUIRE(Global::ConstructionCount == 0);
+         REQUIRE(Global::DestructionCount == 0);
+      }
+
+      // Only the destination owned any nodes, and each was destroyed exactly once:
+      REQUIRE(Global::DestructionCount == 3);
+   }
+
+   SECTION("Copy Assignment of a Node Keeps its Position")
+   {
+      auto tree = buildTree(nullptr);
+      auto& b = *tree.GetRoot()->GetFirstChild();
+      auto& g = *tree.GetRoot()->GetLastChild();
+
+      // Copying a Node over one of its own ancestors is allowed:
+      b = *b.GetLastChild();
+
+      REQUIRE(b.GetData() == "D");
+      REQUIRE(b.GetParent() == tree.GetRoot());
+      REQUIRE(b.GetNextSibling() == &g);
+      REQUIRE(g.GetPreviousSibling() == &b);
+
+      const std::vector<std::string> afterCopy = { "F", "D", "C", "E", "G", "I", "H" };
+      VerifyTraversal(afterCopy, preOrder(tree));
+      REQUIRE(tree.Size() == afterCopy.size());
+   }
+
+   SECTION("Move Assignment of a Node Takes Over the Descendants")
+   {
+      using CountingTree = Tree<std::string, SubtreeCountingPolicy>;
+
+      CountingTree tree{ "F", std::make_unique<CountingTree::NodeArena>() };
+      auto* const b = tree.GetRoot()->AppendChild("B");
+      b->AppendChild("A");
+      auto* const g = tree.GetRoot()->AppendChild("G");
+      g->AppendChild("I")->AppendChild("H");
+
+      *b = std::move(*g);
+
+      REQUIRE(b->GetData() == "G");
+      REQUIRE(b->GetParent() == tree.GetRoot());
+      REQUIRE(b->GetFirstChild()->GetData() == "I");
+      REQUIRE(b->GetFirstChild()->GetParent() == b);
+      REQUIRE(!g->HasChildren());
+      REQUIRE(g->GetParent() == tree.GetRoot());
+
+      REQUIRE(tree.GetRoot()->CountAllDescendants() == 4);
+      REQUIRE(tree.GetRoot()->GetLeafCount() == 2);
+      REQUIRE(b->CountAllDescendants() == 2);
+      REQUIRE(g->CountAllDescendants() == 0);
+   }
+
+   SECTION("Move Construction of a Node")
+   {
+      auto tree = buildTree(nullptr);
+      auto& b = *tree.GetRoot()->GetFirstChild();
+
+      Tree<std::string>::Node moved{ std::move(b) };
+
+      REQUIRE(moved.GetData() == "B");
+      REQUIRE(moved.GetParent() == nullptr);
+      REQUIRE(moved.GetChildCount() == 2);
+      REQUIRE(moved.GetFirstChild()->GetParent() == &moved);
+      REQUIRE(moved.CountAllDescendants() == 4);
+      REQUIRE(!b.HasChildren());
+      REQUIRE(tree.Size() == 5);
+   }
+
+   SECTION("Copying into an Arena Yields a Single Pre-Order Block")
+   {
+      for (auto useArena : { false, true })
+      {
+         const auto tree =
+             buildTree(useArena ? std::make_unique<Tree<std::string>::NodeArena>(2) : nullptr);
+
+         const auto copy = tree.CopyIntoArena();
+
+         REQUIRE(copy.GetArena() != nullptr);
+         REQUIRE(copy.GetArena()->GetSlabCount() == 1);
+         VerifyTraversal(expected, preOrder(copy));
+
+         std::size_t index = 0;
+         for (auto itr = copy.beginPreOrder(); itr != copy.endPreOrder(); ++itr)
+         {
+            REQUIRE(itr->GetIndex() == index++);
+         }
+      }
+   }
+
+   SECTION("Copy Construction of an Arena-Backed Tree Reserves a Single Block")
+   {
+      const auto tree = buildTree(std::make_unique<Tree<std::string>::NodeArena>(16));
+      const auto copy = tree;
+
+      REQUIRE(copy.GetArena() != tree.GetArena());
+      REQUIRE(copy.GetArena()->GetSlabCount() == 1);
+      VerifyTraversal(expected, preOrder(copy));
+   }
+}
+
 TEST_CASE("Selectively Delecting Nodes")
 {
    Global::ResetConstructionCount();
@@ -1213,3 +1996,2557 @@ TEST_CASE("Selectively Delecting Nodes")
       REQUIRE(Global::DestructionCount == treeSize);
    }
 }
+
+TEST_CASE("Arena Allocation")
+{
+   Global::ResetConstructionCount();
+   Global::ResetDestructionCount();
+
+   SECTION("Traversal of an Arena-Backed Tree")
+   {
+      Tree<std::string> tree{ "F", std::make_unique<Tree<std::string>::NodeArena>(4) };
+      tree.GetRoot()->AppendChild("B")->AppendChild("A");
+      tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+      tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+      tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+      REQUIRE(tree.GetArena() != nullptr);
+      REQUIRE(tree.GetArena()->GetSlabCount() == 3);
+      REQUIRE(tree.Size() == 9);
+
+      const std::vector<std::string> expected = { "A", "C", "E", "D", "B", "H", "I", "G", "F" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          std::begin(tree),
+          std::end(tree),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Deleted Nodes Are Recycled")
+   {
+      Tree<VerboseNode> tree{ "X", std::make_unique<Tree<VerboseNode>::NodeArena>(4) };
+      tree.GetRoot()->AppendChild("A");
+      tree.GetRoot()->AppendChild("B");
+      tree.GetRoot()->AppendChild("C");
+
+      REQUIRE(tree.GetArena()->GetSlabCount() == 1);
+
+      Global::ResetDestructionCount();
+
+      tree.GetRoot()->GetFirstChild()->DeleteFromTree();
+
+      REQUIRE(Global::DestructionCount == 1);
+      REQUIRE(tree.GetRoot()->GetChildCount() == 2);
+
+      tree.GetRoot()->AppendChild("D");
+
+      REQUIRE(tree.GetArena()->GetSlabCount() == 1);
+
+      const std::vector<std::string> expected = { "B", "C", "D", "X" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          std::begin(tree),
+          std::end(tree),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData().m_data; });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Destroying All Nodes When Destroying the Tree")
+   {
+      std::int64_t treeSize = 0;
+
+      {
+         Tree<VerboseNode> tree{ "F", std::make_unique<Tree<VerboseNode>::NodeArena>() };
+         tree.GetRoot()->AppendChild("B")->AppendChild("A");
+         tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+         tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+         tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+         Global::DestructionCount = 0;
+
+         treeSize = tree.Size();
+      }
+
+      REQUIRE(Global::DestructionCount == treeSize);
+   }
+
+   SECTION("Copying an Arena-Backed Tree")
+   {
+      Tree<std::string> tree{ "F", std::make_unique<Tree<std::string>::NodeArena>() };
+      tree.GetRoot()->AppendChild("B")->AppendChild("A");
+      tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+      const auto copy = tree;
+
+      REQUIRE(copy.GetArena() != nullptr);
+      REQUIRE(copy.GetArena() != tree.GetArena());
+      REQUIRE(copy.Size() == tree.Size());
+
+      const std::vector<std::string> expected = { "F", "B", "A", "G", "I", "H" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          copy.beginPreOrder(),
+          copy.endPreOrder(),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+}
+
+TEST_CASE("Memory Layout Optimization")
+{
+   Tree<std::string> tree{ "F" };
+   tree.GetRoot()->AppendChild("B")->AppendChild("A");
+   tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+   tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+   const auto CollectIndices = [](auto begin, auto end) {
+      std::vector<std::size_t> indices;
+      std::transform(begin, end, std::back_inserter(indices), [](const auto& node) noexcept {
+         return node.GetIndex();
+      });
+
+      return indices;
+   };
+
+   SECTION("Heap Allocated Nodes Have No Index")
+   {
+      REQUIRE(tree.GetRoot()->GetIndex() == Tree<std::string>::Node::INVALID_INDEX);
+   }
+
+   SECTION("Pre-Order Layout")
+   {
+      tree.OptimizeMemoryLayoutFor<PreOrderTraversal>();
+
+      REQUIRE(tree.GetArena() != nullptr);
+      REQUIRE(tree.GetArena()->GetSlabCount() == 1);
+
+      const std::vector<std::size_t> expectedIndices = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+      VerifyTraversal(expectedIndices, CollectIndices(tree.beginPreOrder(), tree.endPreOrder()));
+
+      const std::vector<std::string> expected = { "F", "B", "A", "D", "C", "E", "G", "I", "H" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          tree.beginPreOrder(),
+          tree.endPreOrder(),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Post-Order Layout")
+   {
+      tree.OptimizeMemoryLayoutFor<PostOrderTraversal>();
+
+      const std::vector<std::size_t> expectedIndices = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+      VerifyTraversal(expectedIndices, CollectIndices(std::begin(tree), std::end(tree)));
+
+      const std::vector<std::string> expected = { "A", "C", "E", "D", "B", "H", "I", "G", "F" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          std::begin(tree),
+          std::end(tree),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Leaf Layout")
+   {
+      tree.OptimizeMemoryLayoutFor<LeafTraversal>();
+
+      const std::vector<std::size_t> expectedIndices = { 0, 1, 2, 3 };
+      VerifyTraversal(expectedIndices, CollectIndices(tree.beginLeaf(), tree.endLeaf()));
+
+      REQUIRE(tree.GetRoot()->GetIndex() == 8);
+      REQUIRE(tree.Size() == 9);
+   }
+
+   SECTION("Level-Order Layout")
+   {
+      tree.OptimizeMemoryLayoutFor<LevelOrderTraversal>();
+
+      const std::vector<std::size_t> expectedIndices = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+      VerifyTraversal(
+          expectedIndices, CollectIndices(tree.beginLevelOrder(), tree.endLevelOrder()));
+
+      const std::vector<std::string> expected = { "F", "B", "G", "A", "D", "I", "C", "E", "H" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          tree.beginLevelOrder(),
+          tree.endLevelOrder(),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Relocating an Arena-Backed Tree Twice")
+   {
+      tree.OptimizeMemoryLayoutFor<PreOrderTraversal>();
+      tree.OptimizeMemoryLayoutFor<PostOrderTraversal>();
+
+      const std::vector<std::size_t> expectedIndices = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+      VerifyTraversal(expectedIndices, CollectIndices(std::begin(tree), std::end(tree)));
+
+      tree.GetRoot()->GetFirstChild()->DeleteFromTree();
+      tree.GetRoot()->AppendChild("J");
+
+      const std::vector<std::string> expected = { "H", "I", "G", "J", "F" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          std::begin(tree),
+          std::end(tree),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+}
+
+TEST_CASE("Frozen Tree")
+{
+   Tree<std::string> tree{ "F" };
+   tree.GetRoot()->AppendChild("B")->AppendChild("A");
+   tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+   tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+   const auto frozenTree = tree.Freeze();
+
+   SECTION("Node Counting")
+   {
+      REQUIRE(frozenTree.Size() == 9);
+      REQUIRE(frozenTree.GetRoot().CountAllDescendants() == 8);
+      REQUIRE(frozenTree.GetRoot().GetFirstChild().CountAllDescendants() == 4);
+      REQUIRE(frozenTree.GetRoot().GetChildCount() == 2);
+   }
+
+   SECTION("Navigating Between Nodes")
+   {
+      const auto root = frozenTree.GetRoot();
+
+      REQUIRE(root.GetData() == "F");
+      REQUIRE(!root.GetParent());
+      REQUIRE(!root.GetNextSibling());
+      REQUIRE(root.GetFirstChild().GetData() == "B");
+      REQUIRE(root.GetLastChild().GetData() == "G");
+      REQUIRE(root.GetFirstChild().GetNextSibling().GetData() == "G");
+      REQUIRE(root.GetFirstChild().GetLastChild().GetParent().GetData() == "B");
+      REQUIRE(!root.GetLastChild().GetNextSibling());
+      REQUIRE(!root.GetFirstChild().GetFirstChild().GetFirstChild());
+   }
+
+   SECTION("Pre-order Traversal")
+   {
+      const std::vector<std::string> expected = { "F", "B", "A", "D", "C", "E", "G", "I", "H" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          frozenTree.beginPreOrder(),
+          frozenTree.endPreOrder(),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Post-order Traversal")
+   {
+      const std::vector<std::string> expected = { "A", "C", "E", "D", "B", "H", "I", "G", "F" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          std::begin(frozenTree),
+          std::end(frozenTree),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Leaf Traversal")
+   {
+      const std::vector<std::string> expected = { "A", "C", "E", "H" };
+
+      std::vector<std::string> actual;
+      std::transform(
+          frozenTree.beginLeaf(),
+          frozenTree.endLeaf(),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      VerifyTraversal(expected, actual);
+   }
+
+   SECTION("Partial Tree Iteration")
+   {
+      const auto startingNode = frozenTree.GetRoot().GetFirstChild().GetLastChild();
+      REQUIRE(startingNode.GetData() == "D");
+
+      using FrozenTreeType = std::decay_t<decltype(frozenTree)>;
+
+      const auto Collect = [](auto begin, auto end) {
+         std::vector<std::string> actual;
+         std::transform(begin, end, std::back_inserter(actual), [](const auto& node) noexcept {
+            return node.GetData();
+         });
+
+         return actual;
+      };
+
+      VerifyTraversal(
+          { "D", "C", "E" },
+          Collect(
+              FrozenTreeType::PreOrderIterator{ startingNode },
+              FrozenTreeType::PreOrderIterator{}));
+
+      VerifyTraversal(
+          { "C", "E", "D" },
+          Collect(
+              FrozenTreeType::PostOrderIterator{ startingNode },
+              FrozenTreeType::PostOrderIterator{}));
+
+      VerifyTraversal(
+          { "C", "E" },
+          Collect(
+              FrozenTreeType::LeafIterator{ startingNode }, FrozenTreeType::LeafIterator{}));
+
+      VerifyTraversal(
+          { "B", "G" },
+          Collect(
+              FrozenTreeType::SiblingIterator{ frozenTree.GetRoot().GetFirstChild() },
+              FrozenTreeType::SiblingIterator{}));
+   }
+
+   SECTION("Freezing a Single Node")
+   {
+      const Tree<int> singleton{ 42 };
+      const auto frozenSingleton = singleton.Freeze();
+
+      REQUIRE(frozenSingleton.Size() == 1);
+      REQUIRE(std::distance(frozenSingleton.beginLeaf(), frozenSingleton.endLeaf()) == 1);
+      REQUIRE(std::distance(std::begin(frozenSingleton), std::end(frozenSingleton)) == 1);
+   }
+}
+
+TEST_CASE("Binary Serialization")
+{
+   Tree<int> tree{ 6 };
+   tree.GetRoot()->AppendChild(2)->AppendChild(1);
+   tree.GetRoot()->GetFirstChild()->AppendChild(4)->AppendChild(3);
+   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild(5);
+   tree.GetRoot()->AppendChild(7)->AppendChild(9)->AppendChild(8);
+
+   const std::string fileName{ "BinarySerializationTest.tree" };
+   TreeSerialization::WriteToFile(tree, fileName);
+
+   const auto Collect = [](const FrozenTree<int>& frozenTree) {
+      std::vector<int> actual;
+      std::transform(
+          frozenTree.beginPreOrder(),
+          frozenTree.endPreOrder(),
+          std::back_inserter(actual),
+          [](const auto& node) noexcept { return node.GetData(); });
+
+      return actual;
+   };
+
+   SECTION("Round Trip")
+   {
+      const auto mappedTree = TreeSerialization::MapFromFile<int>(fileName);
+
+      REQUIRE(mappedTree.Size() == 9);
+      REQUIRE(mappedTree.GetRoot().GetLastChild().GetFirstChild().GetData() == 9);
+      REQUIRE(std::distance(mappedTree.beginLeaf(), mappedTree.endLeaf()) == 4);
+      REQUIRE(Collect(mappedTree) == Collect(tree.Freeze()));
+   }
+
+   SECTION("Mapped Trees Outlive Their Copies")
+   {
+      FrozenTree<int> copy;
+
+      {
+         const auto mappedTree = TreeSerialization::MapFromFile<int>(fileName);
+         copy = mappedTree;
+      }
+
+      REQUIRE(Collect(copy) == std::vector<int>({ 6, 2, 1, 4, 3, 5, 7, 9, 8 }));
+   }
+
+   SECTION("Rejecting a Different Data Type")
+   {
+      REQUIRE_THROWS_AS(TreeSerialization::MapFromFile<double>(fileName), std::runtime_error);
+   }
+
+   SECTION("Rejecting a Corrupt Topology")
+   {
+      std::fstream stream{ fileName, std::ios::binary | std::ios::in | std::ios::out };
+
+      TreeSerialization::FileHeader header;
+      stream.read(reinterpret_cast<char*>(&header), sizeof header);
+
+      // Claim that the second node's subtree extends past the end of the tree:
+      const FrozenTree<int>::IndexType subtreeSize{ 42 };
+      stream.seekp(static_cast<std::streamoff>(header.subtreeSizesOffset + sizeof subtreeSize));
+      stream.write(reinterpret_cast<const char*>(&subtreeSize), sizeof subtreeSize);
+      stream.close();
+
+      REQUIRE_THROWS_AS(TreeSerialization::MapFromFile<int>(fileName), std::runtime_error);
+   }
+
+   SECTION("Rejecting a Truncated File")
+   {
+      std::ofstream{ fileName, std::ios::binary | std::ios::trunc } << "NARYTREE";
+
+      REQUIRE_THROWS_AS(TreeSerialization::MapFromFile<int>(fileName), std::runtime_error);
+   }
+
+   SECTION("Rejecting a Missing File")
+   {
+      REQUIRE_THROWS_AS(
+          TreeSerialization::MapFromFile<int>("MissingFile.tree"), std::runtime_error);
+   }
+
+   std::remove(fileName.c_str());
+}
+
+TEST_CASE("Graph Export")
+{
+   Tree<std::string> tree{ "F" };
+   tree.GetRoot()->AppendChild("B")->AppendChild("A");
+   tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+   tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+   using TreeUtilities::ExportFormat;
+   using TreeUtilities::ExportOptions;
+
+   SECTION("DOT")
+   {
+      ExportOptions options;
+      options.maximumDepth = 1;
+
+      std::ostringstream stream;
+      REQUIRE(TreeUtilities::ExportToStream(tree, stream, options) == 3);
+
+      REQUIRE(
+          stream.str() ==
+          "digraph {\n"
+          "   rankdir = TB;\n"
+          "   edge [arrowsize=0.4, fontsize=10]\n"
+          "\n"
+          "   0 [label = \"F\"]\n"
+          "   1 [label = \"B\"]\n"
+          "   0 -> 1\n"
+          "   2 [label = \"G\"]\n"
+          "   0 -> 2\n"
+          "}\n");
+   }
+
+   SECTION("JSON Lines")
+   {
+      ExportOptions options;
+      options.format = ExportFormat::JSON_LINES;
+
+      std::ostringstream stream;
+      REQUIRE(TreeUtilities::ExportToStream(tree, stream, options) == 9);
+
+      std::vector<std::string> lines;
+      std::istringstream input{ stream.str() };
+      for (std::string line; std::getline(input, line);)
+      {
+         lines.emplace_back(line);
+      }
+
+      REQUIRE(lines.size() == 9);
+      REQUIRE(lines[0] == R"({"id":0,"parent":null,"depth":0,"label":"F"})");
+      REQUIRE(lines[4] == R"({"id":4,"parent":3,"depth":3,"label":"C"})");
+      REQUIRE(lines[6] == R"({"id":6,"parent":0,"depth":1,"label":"G"})");
+      REQUIRE(lines[8] == R"({"id":8,"parent":7,"depth":3,"label":"H"})");
+   }
+
+   SECTION("Limiting the Node Count")
+   {
+      ExportOptions options;
+      options.format = ExportFormat::JSON_LINES;
+      options.maximumNodeCount = 4;
+
+      std::ostringstream stream;
+      REQUIRE(TreeUtilities::ExportToStream(tree, stream, options) == 4);
+      const auto output = stream.str();
+      REQUIRE(std::count(std::begin(output), std::end(output), '\n') == 4);
+   }
+
+   SECTION("Escaping Labels")
+   {
+      ExportOptions options;
+      options.format = ExportFormat::JSON_LINES;
+      options.maximumDepth = 0;
+
+      std::ostringstream stream;
+      TreeUtilities::ExportToStream(tree, stream, options, [](const auto&) noexcept {
+         return std::wstring{ L"\"C:\\\u00E9\"" };
+      });
+
+      REQUIRE(
+          stream.str() ==
+          R"({"id":0,"parent":null,"depth":0,"label":"\"C:\\)" "\xC3\xA9" R"(\""})" "\n");
+   }
+
+   SECTION("Exporting to a File")
+   {
+      const std::string fileName{ "GraphExportTest.dot" };
+
+      ExportOptions options;
+      options.bufferSize = 16;
+
+      REQUIRE(TreeUtilities::ExportToFile(tree, fileName, options) == 9);
+
+      std::ostringstream expected;
+      TreeUtilities::ExportToStream(tree, expected);
+
+      std::ostringstream actual;
+      actual << std::ifstream{ fileName }.rdbuf();
+
+      REQUIRE(actual.str() == expected.str());
+
+      std::remove(fileName.c_str());
+   }
+
+   SECTION("Numeric Labels")
+   {
+      const Tree<int> numbers{ 42 };
+
+      std::ostringstream stream;
+      TreeUtilities::ExportToStream(numbers, stream);
+
+      REQUIRE(stream.str().find("   0 [label = \"42\"]\n") != std::string::npos);
+   }
+
+   SECTION("Character Labels")
+   {
+      const auto exportLabel = [](auto character) {
+         const Tree<decltype(character)> characters{ character };
+
+         ExportOptions options;
+         options.format = ExportFormat::JSON_LINES;
+
+         std::ostringstream stream;
+         TreeUtilities::ExportToStream(characters, stream, options);
+
+         return stream.str();
+      };
+
+      const auto line = [](const std::string& label) {
+         return R"({"id":0,"parent":null,"depth":0,"label":")" + label + "\"}\n";
+      };
+
+      REQUIRE(exportLabel('"') == line(R"(\")"));
+      REQUIRE(exportLabel('\\') == line(R"(\\)"));
+      REQUIRE(exportLabel(static_cast<unsigned char>('x')) == line("x"));
+      REQUIRE(exportLabel(L'"') == line(R"(\")"));
+      REQUIRE(exportLabel(L'\u00E9') == line("\xC3\xA9"));
+      REQUIRE(exportLabel(u'\xD800') == line("\xEF\xBF\xBD"));
+      REQUIRE(exportLabel(U'\U0001F333') == line("\xF0\x9F\x8C\xB3"));
+   }
+}
+
+TEST_CASE("Maintained Subtree Counts")
+{
+   using CountingTree = Tree<std::string, SubtreeCountingPolicy>;
+
+   CountingTree tree{ "F" };
+   tree.GetRoot()->AppendChild("B")->AppendChild("A");
+   tree.GetRoot()->GetFirstChild()->AppendChild("D")->AppendChild("C");
+   tree.GetRoot()->GetFirstChild()->GetLastChild()->AppendChild("E");
+   tree.GetRoot()->AppendChild("G")->AppendChild("I")->AppendChild("H");
+
+   const auto verifyCounts = [](const CountingTree& tree) {
+      for (const auto& node : tree)
+      {
+         REQUIRE(node.GetSubtreeSize() == node.CountAllDescendants() + 1);
+
+         const auto leafCount = std::count_if(
+             CountingTree::LeafIterator{ &node },
+             CountingTree::LeafIterator{},
+             [](const auto&) noexcept { return true; });
+
+         REQUIRE(node.GetLeafCount() == static_cast<std::size_t>(leafCount));
+      }
+   };
+
+   SECTION("Counts After Construction")
+   {
+      REQUIRE(tree.Size() == 9);
+      REQUIRE(tree.GetRoot()->GetSubtreeSize() == 9);
+      REQUIRE(tree.GetRoot()->GetLeafCount() == 4);
+      REQUIRE(tree.GetRoot()->GetFirstChild()->GetSubtreeSize() == 5);
+      REQUIRE(tree.GetRoot()->GetFirstChild()->GetLeafCount() == 3);
+
+      verifyCounts(tree);
+   }
+
+   SECTION("Counts After Prepending to a Leaf")
+   {
+      tree.GetRoot()->GetFirstChild()->GetFirstChild()->PrependChild("Z");
+
+      REQUIRE(tree.Size() == 10);
+      REQUIRE(tree.GetRoot()->GetLeafCount() == 4);
+
+      verifyCounts(tree);
+   }
+
+   SECTION("Counts After Deleting a Subtree")
+   {
+      tree.GetRoot()->GetFirstChild()->GetLastChild()->DeleteFromTree();
+
+      REQUIRE(tree.Size() == 6);
+      REQUIRE(tree.GetRoot()->GetLeafCount() == 2);
+
+      verifyCounts(tree);
+   }
+
+   SECTION("Counts After Removing the Only Child")
+   {
+      tree.GetRoot()->GetLastChild()->GetFirstChild()->DeleteFromTree();
+
+      REQUIRE(tree.Size() == 7);
+      REQUIRE(tree.GetRoot()->GetLastChild()->GetLeafCount() == 1);
+      REQUIRE(tree.GetRoot()->GetLeafCount() == 4);
+
+      verifyCounts(tree);
+   }
+
+   SECTION("Counts After Copying and Relocating")
+   {
+      CountingTree copy{ tree };
+      verifyCounts(copy);
+
+      copy.OptimizeMemoryLayoutFor<PostOrderTraversal>();
+      REQUIRE(copy.Size() == 9);
+      verifyCounts(copy);
+   }
+
+   SECTION("Pre-Order Rank and Select")
+   {
+      std::size_t index{ 0 };
+      for (auto itr = tree.beginPreOrder(); itr != tree.endPreOrder(); ++itr, ++index)
+      {
+         REQUIRE(tree.GetNodeAtPreOrderIndex(index) == &*itr);
+         REQUIRE(CountingTree::GetPreOrderIndex(*itr) == index);
+      }
+
+      REQUIRE(index == 9);
+      REQUIRE(tree.GetNodeAtPreOrderIndex(index) == nullptr);
+   }
+}
+
+TEST_CASE("Parallel Reduce")
+{
+   // Build a lopsided tree, with one deep chain and a few wide levels, so that the reduction
+   // has to split subtrees of very different sizes:
+   Tree<int> tree{ 0 };
+
+   int value{ 1 };
+   auto* chain = tree.GetRoot();
+   for (int depth = 0; depth < 500; ++depth)
+   {
+      chain = chain->AppendChild(value++);
+   }
+
+   for (int i = 0; i < 20; ++i)
+   {
+      auto* child = tree.GetRoot()->AppendChild(value++);
+      for (int j = 0; j < 50; ++j)
+      {
+         auto* const grandchild = child->AppendChild(value++);
+         grandchild->AppendChild(value++);
+      }
+   }
+
+   const auto nodeValue = [](const Tree<int>::Node& node) noexcept -> long long {
+      return node.GetData();
+   };
+
+   const auto sum = [](long long lhs, long long rhs) noexcept { return lhs + rhs; };
+
+   const auto computeSerially = [](const Tree<int>::Node& root) {
+      return std::accumulate(
+          Tree<int>::PostOrderIterator{ &root },
+          Tree<int>::PostOrderIterator{},
+          0ll,
+          [](long long total, const Tree<int>::Node& node) { return total + node.GetData(); });
+   };
+
+   const long long expectedTotal = static_cast<long long>(value) * (value - 1) / 2;
+
+   SECTION("Aggregate of the Entire Tree")
+   {
+      for (unsigned int threadCount : { 1u, 2u, 8u })
+      {
+         const auto total = TreeAlgorithms::ParallelReduce(
+             tree, nodeValue, sum, TreeAlgorithms::DiscardResult{}, threadCount);
+
+         REQUIRE(total == expectedTotal);
+      }
+   }
+
+   SECTION("Repeated Reductions on More Threads than Cores")
+   {
+      // Plenty of idle threads keep stealing from one another, and going to sleep, while the
+      // subtrees are split up:
+      for (int run = 0; run < 50; ++run)
+      {
+         const auto total = TreeAlgorithms::ParallelReduce(
+             tree, nodeValue, sum, TreeAlgorithms::DiscardResult{}, 16u);
+
+         REQUIRE(total == expectedTotal);
+      }
+   }
+
+   SECTION("Aggregates of Every Subtree")
+   {
+      std::vector<long long> aggregates(static_cast<std::size_t>(value), -1);
+
+      TreeAlgorithms::ParallelReduce(
+          tree,
+          nodeValue,
+          sum,
+          [&](Tree<int>::Node& node, long long aggregate) noexcept {
+             aggregates[static_cast<std::size_t>(node.GetData())] = aggregate;
+          },
+          8u);
+
+      for (const auto& node : tree)
+      {
+         REQUIRE(aggregates[static_cast<std::size_t>(node.GetData())] == computeSerially(node));
+      }
+   }
+
+   SECTION("Children are Combined in Order")
+   {
+      Tree<std::string> letters{ "" };
+      letters.GetRoot()->AppendChild("A")->AppendChild("B");
+      letters.GetRoot()->GetFirstChild()->AppendChild("C");
+      letters.GetRoot()->AppendChild("D");
+
+      const auto concatenated = TreeAlgorithms::ParallelReduce(
+          letters,
+          [](const Tree<std::string>::Node& node) { return node.GetData(); },
+          [](std::string lhs, const std::string& rhs) { return lhs + rhs; },
+          TreeAlgorithms::DiscardResult{},
+          4u);
+
+      REQUIRE(concatenated == "ABCD");
+   }
+
+   SECTION("Exceptions are Propagated")
+   {
+      const auto throwing = [](const Tree<int>::Node& node) -> long long {
+         if (node.GetData() == 250)
+         {
+            throw std::runtime_error{ "Failure." };
+         }
+
+         return node.GetData();
+      };
+
+      REQUIRE_THROWS_AS(
+          TreeAlgorithms::ParallelReduce(
+              tree, throwing, sum, TreeAlgorithms::DiscardResult{}, 4u),
+          std::runtime_error);
+   }
+}
+
+TEST_CASE("Concurrent Construction")
+{
+   constexpr int threadCount = 8;
+   constexpr int parentCount = 16;
+   constexpr int childrenPerThread = 1000;
+
+   const auto buildConcurrently = [&](Tree<int>& tree) {
+      std::vector<Tree<int>::Node*> parents;
+      for (int index = 0; index < parentCount; ++index)
+      {
+         parents.emplace_back(tree.GetRoot()->AppendChild(-1));
+      }
+
+      std::vector<std::thread> threads;
+      for (int thread = 0; thread < threadCount; ++thread)
+      {
+         threads.emplace_back([&, thread] {
+            for (int index = 0; index < childrenPerThread; ++index)
+            {
+               const int value = thread * childrenPerThread + index;
+               parents[static_cast<std::size_t>(value % parentCount)]->AppendChildConcurrently(
+                   value);
+            }
+         });
+      }
+
+      for (auto& thread : threads)
+      {
+         thread.join();
+      }
+
+      REQUIRE(tree.Size() == 1 + parentCount + threadCount * childrenPerThread);
+
+      std::vector<int> values;
+      for (const auto* parent : parents)
+      {
+         REQUIRE(parent->GetChildCount() == threadCount * childrenPerThread / parentCount);
+
+         const int remainder = parent->GetFirstChild()->GetData() % parentCount;
+         for (auto* child = parent->GetFirstChild(); child; child = child->GetNextSibling())
+         {
+            REQUIRE(child->GetData() % parentCount == remainder);
+            values.emplace_back(child->GetData());
+         }
+      }
+
+      std::sort(std::begin(values), std::end(values));
+      for (std::size_t index = 0; index < values.size(); ++index)
+      {
+         REQUIRE(values[index] == static_cast<int>(index));
+      }
+   };
+
+   SECTION("Heap Allocated Nodes")
+   {
+      Tree<int> tree{ 0 };
+      buildConcurrently(tree);
+   }
+
+   SECTION("Arena Allocated Nodes")
+   {
+      Tree<int> tree{ 0, std::make_unique<Tree<int>::NodeArena>(64) };
+      buildConcurrently(tree);
+
+      REQUIRE(tree.GetArena()->GetSlabCount() > 1);
+   }
+
+   SECTION("Attaching Prebuilt Nodes")
+   {
+      Tree<int> tree{ 0, std::make_unique<Tree<int>::NodeArena>(64) };
+      auto& arena = *tree.GetArena();
+
+      // Every thread builds small subtrees on the side, and only attaches those with an even
+      // root; the others are discarded again:
+      std::vector<std::thread> threads;
+      for (int thread = 0; thread < threadCount; ++thread)
+      {
+         threads.emplace_back([&, thread] {
+            for (int index = 0; index < childrenPerThread; ++index)
+            {
+               const int value = thread * childrenPerThread + index;
+               auto* const node = arena.CreateConcurrently(value);
+
+               if (value % 2 != 0)
+               {
+                  arena.DestroyConcurrently(node);
+                  continue;
+               }
+
+               node->AppendChildConcurrently(-value);
+               tree.GetRoot()->AppendChildConcurrently(*node);
+            }
+         });
+      }
+
+      for (auto& thread : threads)
+      {
+         thread.join();
+      }
+
+      REQUIRE(tree.GetRoot()->GetChildCount() == threadCount * childrenPerThread / 2);
+      REQUIRE(tree.Size() == 1 + threadCount * childrenPerThread);
+
+      for (auto* child = tree.GetRoot()->GetFirstChild(); child; child = child->GetNextSibling())
+      {
+         REQUIRE(child->GetData() % 2 == 0);
+         REQUIRE(child->GetParent() == tree.GetRoot());
+         REQUIRE(child->GetFirstChild()->GetData() == -child->GetData());
+      }
+   }
+}
+
+TEST_CASE("Concurrent Iteration")
+{
+   Tree<int> tree{ 0 };
+
+   // Build a somewhat irregular tree, so that every kind of step gets exercised:
+   std::vector<Tree<int>::Node*> nodes{ tree.GetRoot() };
+   for (int value = 1; value < 2000; ++value)
+   {
+      auto* const parent = nodes[static_cast<std::size_t>((value * 37 + 11) % value)];
+      nodes.emplace_back(parent->AppendChild(value));
+   }
+
+   const auto sharedTree = std::make_shared<const Tree<int>>(tree);
+
+   const auto collect = [](auto begin, auto end) {
+      std::vector<int> values;
+      std::for_each(begin, end, [&](const Tree<int>::Node& node) {
+         values.emplace_back(node.GetData());
+      });
+
+      return values;
+   };
+
+   const auto traverse = [&] {
+      return std::make_tuple(
+          collect(sharedTree->beginPreOrder(), sharedTree->endPreOrder()),
+          collect(std::begin(*sharedTree), std::end(*sharedTree)),
+          collect(sharedTree->beginLeaf(), sharedTree->endLeaf()));
+   };
+
+   const auto expected = traverse();
+   REQUIRE(std::get<0>(expected).size() == 2000);
+   REQUIRE(std::get<1>(expected).size() == 2000);
+
+   constexpr int threadCount = 8;
+   std::vector<decltype(traverse())> results(threadCount);
+
+   std::vector<std::thread> threads;
+   for (int thread = 0; thread < threadCount; ++thread)
+   {
+      threads.emplace_back([&, thread] { results[static_cast<std::size_t>(thread)] = traverse(); });
+   }
+
+   for (auto& thread : threads)
+   {
+      thread.join();
+   }
+
+   for (const auto& result : results)
+   {
+      REQUIRE(result == expected);
+   }
+}
+
+TEST_CASE("Visitation Tracking")
+{
+   SECTION("Nodes Only Carry a Visitation Flag on Request")
+   {
+      REQUIRE(sizeof(Tree<int>::Node) < sizeof(Tree<int, VisitationTrackingPolicy>::Node));
+   }
+
+   SECTION("Marking Nodes")
+   {
+      Tree<int, VisitationTrackingPolicy> tree{ 0 };
+      auto* const child = tree.GetRoot()->AppendChild(1);
+
+      REQUIRE(!child->HasBeenVisited());
+
+      child->MarkVisited();
+      REQUIRE(child->HasBeenVisited());
+      REQUIRE(!tree.GetRoot()->HasBeenVisited());
+
+      child->MarkVisited(false);
+      REQUIRE(!child->HasBeenVisited());
+   }
+}
+
+TEST_CASE("Tree Partitioning")
+{
+   constexpr int nodeCount = 5000;
+
+   const auto buildTree = [](auto& tree) {
+      std::vector<std::remove_reference_t<decltype(*tree.GetRoot())>*> nodes{ tree.GetRoot() };
+      for (int value = 1; value < nodeCount; ++value)
+      {
+         auto* const parent = nodes[static_cast<std::size_t>((value * 37 + 11) % value)];
+         nodes.emplace_back(parent->AppendChild(value));
+      }
+   };
+
+   const auto verifyPartitions = [](const auto& partitions, std::size_t partitionCount) {
+      REQUIRE(partitions.size() == partitionCount);
+
+      std::vector<int> values;
+      std::size_t largestPartition{ 0 };
+
+      for (const auto& partition : partitions)
+      {
+         std::size_t size{ 0 };
+         partition.ForEach([&](const auto& node) {
+            values.emplace_back(node.GetData());
+            ++size;
+         });
+
+         REQUIRE(size == partition.Size());
+         largestPartition = std::max(largestPartition, size);
+      }
+
+      // Every node has to show up in exactly one partition:
+      std::sort(std::begin(values), std::end(values));
+
+      std::vector<int> expected(nodeCount);
+      std::iota(std::begin(expected), std::end(expected), 0);
+
+      REQUIRE(values == expected);
+      REQUIRE(largestPartition <= 2 * nodeCount / partitionCount);
+   };
+
+   SECTION("Without Tracked Subtree Sizes")
+   {
+      Tree<int> tree{ 0 };
+      buildTree(tree);
+
+      verifyPartitions(TreeAlgorithms::PartitionTree(tree, 4), 4);
+   }
+
+   SECTION("With Tracked Subtree Sizes")
+   {
+      Tree<int, SubtreeCountingPolicy> tree{ 0 };
+      buildTree(tree);
+
+      const auto& constTree = tree;
+      verifyPartitions(TreeAlgorithms::PartitionTree(constTree, 7), 7);
+   }
+
+   SECTION("More Partitions than Nodes")
+   {
+      Tree<int> tree{ 0 };
+      tree.GetRoot()->AppendChild(1);
+      tree.GetRoot()->AppendChild(2);
+
+      const auto partitions = TreeAlgorithms::PartitionTree(tree, 8);
+      REQUIRE(partitions.size() == 3);
+
+      for (const auto& partition : partitions)
+      {
+         REQUIRE(partition.Size() == 1);
+      }
+   }
+}
+
+TEST_CASE("Parallel For Each")
+{
+   constexpr int nodeCount = 5000;
+
+   const auto buildTree = [](auto& tree) {
+      std::vector<std::remove_reference_t<decltype(*tree.GetRoot())>*> nodes{ tree.GetRoot() };
+      for (int value = 1; value < nodeCount; ++value)
+      {
+         auto* const parent = nodes[static_cast<std::size_t>((value * 37 + 11) % value)];
+         nodes.emplace_back(parent->AppendChild(value));
+      }
+   };
+
+   const auto verifyVisits = [](const auto& tree, unsigned int threadCount) {
+      std::vector<std::atomic<int>> visits(nodeCount);
+      for (auto& count : visits)
+      {
+         count.store(0);
+      }
+
+      TreeAlgorithms::ParallelForEach(
+          tree,
+          [&](const auto& node) noexcept {
+             visits[static_cast<std::size_t>(node.GetData())].fetch_add(1);
+          },
+          threadCount);
+
+      REQUIRE(std::all_of(std::begin(visits), std::end(visits), [](const auto& count) noexcept {
+         return count.load() == 1;
+      }));
+   };
+
+   SECTION("Without Tracked Subtree Sizes")
+   {
+      Tree<int> tree{ 0 };
+      buildTree(tree);
+
+      verifyVisits(tree, 1);
+      verifyVisits(tree, 8);
+   }
+
+   SECTION("With Tracked Subtree Sizes")
+   {
+      Tree<int, SubtreeCountingPolicy> tree{ 0 };
+      buildTree(tree);
+
+      verifyVisits(tree, 8);
+   }
+
+   SECTION("Modifying Nodes")
+   {
+      Tree<int> tree{ 0 };
+      buildTree(tree);
+
+      TreeAlgorithms::ParallelForEach(tree, [](Tree<int>::Node& node) noexcept {
+         node.GetData() *= 2;
+      });
+
+      const auto sum = std::accumulate(
+          tree.beginPreOrder(), tree.endPreOrder(), 0, [](int total, const auto& node) noexcept {
+             return total + node.GetData();
+          });
+
+      REQUIRE(sum == nodeCount * (nodeCount - 1));
+   }
+
+   SECTION("Exceptions Are Propagated")
+   {
+      Tree<int> tree{ 0 };
+      buildTree(tree);
+
+      REQUIRE_THROWS_AS(
+          TreeAlgorithms::ParallelForEach(
+              tree,
+              [](const Tree<int>::Node& node) {
+                 if (node.GetData() == nodeCount / 2)
+                 {
+                    throw std::runtime_error{ "Failure" };
+                 }
+              },
+              4),
+          std::runtime_error);
+   }
+}
+
+TEST_CASE("Top-K Queries")
+{
+   constexpr int nodeCount = 5000;
+
+   // A complete quaternary tree, which gives the pruning plenty of subtrees to skip:
+   const auto buildTree = [](auto& tree) {
+      std::vector<std::remove_reference_t<decltype(*tree.GetRoot())>*> nodes{ tree.GetRoot() };
+      for (int value = 1; value < nodeCount; ++value)
+      {
+         auto* const parent = nodes[static_cast<std::size_t>((value - 1) / 4)];
+         nodes.emplace_back(parent->AppendChild(value));
+      }
+   };
+
+   const auto getKeys = [](const auto& nodes) {
+      std::vector<int> keys;
+      for (const auto* node : nodes)
+      {
+         keys.emplace_back(node->GetData());
+      }
+
+      return keys;
+   };
+
+   const auto byData = [](const Tree<int>::Node& node) noexcept { return node.GetData(); };
+
+   Tree<int> tree{ 0 };
+   buildTree(tree);
+
+   SECTION("Finding the Largest Keys")
+   {
+      const auto nodes = TreeAlgorithms::TopK(*tree.GetRoot(), 5, byData);
+      const std::vector<int> expected = { 4999, 4998, 4997, 4996, 4995 };
+      REQUIRE(getKeys(nodes) == expected);
+   }
+
+   SECTION("Asking for More Nodes Than There Are")
+   {
+      auto* const subtree = tree.GetRoot()->GetFirstChild()->GetFirstChild();
+      const auto nodes = TreeAlgorithms::TopK(*subtree, nodeCount, byData);
+
+      REQUIRE(nodes.size() == subtree->CountAllDescendants() + 1);
+      REQUIRE(std::is_sorted(
+          std::begin(nodes), std::end(nodes), [](const auto* lhs, const auto* rhs) noexcept {
+             return lhs->GetData() > rhs->GetData();
+          }));
+   }
+
+   SECTION("Asking for No Nodes")
+   {
+      REQUIRE(TreeAlgorithms::TopK(*tree.GetRoot(), 0, byData).empty());
+      REQUIRE(TreeAlgorithms::ParallelTopK(*tree.GetRoot(), 0, byData).empty());
+   }
+
+   SECTION("Equal Keys Are Preferred in Pre-Order")
+   {
+      Tree<int> ties{ 1 };
+      auto* const first = ties.GetRoot()->AppendChild(5);
+      ties.GetRoot()->AppendChild(3);
+      auto* const third = ties.GetRoot()->AppendChild(5);
+      ties.GetRoot()->AppendChild(5);
+
+      const auto nodes = TreeAlgorithms::TopK(*ties.GetRoot(), 2, byData);
+      const std::vector<Tree<int>::Node*> expected = { first, third };
+      REQUIRE(nodes == expected);
+   }
+
+   // Turning every value into the total of its subtree makes it a bound on all of its descendants:
+   std::for_each(std::begin(tree), std::end(tree), [](Tree<int>::Node& node) noexcept {
+      auto total = (node.GetData() * 7919) % 1000;
+      for (const auto* child = node.GetFirstChild(); child; child = child->GetNextSibling())
+      {
+         total += child->GetData();
+      }
+
+      node.GetData() = total;
+   });
+
+   SECTION("Pruning Subtrees")
+   {
+      std::size_t unboundedCount{ 0 };
+      const auto unbounded =
+          TreeAlgorithms::TopK(*tree.GetRoot(), 10, [&](const Tree<int>::Node& node) noexcept {
+             ++unboundedCount;
+             return node.GetData();
+          });
+
+      std::size_t boundedCount{ 0 };
+      const auto bounded = TreeAlgorithms::TopK(
+          *tree.GetRoot(),
+          10,
+          [&](const Tree<int>::Node& node) noexcept {
+             ++boundedCount;
+             return node.GetData();
+          },
+          byData);
+
+      REQUIRE(bounded == unbounded);
+      REQUIRE(unboundedCount == static_cast<std::size_t>(nodeCount));
+      REQUIRE(boundedCount < unboundedCount);
+   }
+
+   SECTION("Searching in Parallel")
+   {
+      const auto& constantTree = tree;
+
+      const auto& root = *constantTree.GetRoot();
+      const auto expected = getKeys(TreeAlgorithms::TopK(root, 25, byData));
+
+      REQUIRE(getKeys(TreeAlgorithms::ParallelTopK(root, 25, byData)) == expected);
+      REQUIRE(getKeys(TreeAlgorithms::ParallelTopK(root, 25, byData, byData, 4)) == expected);
+
+      REQUIRE(
+          getKeys(TreeAlgorithms::ParallelTopK(root, 25, byData, TreeAlgorithms::Unbounded{}, 1)) ==
+          expected);
+   }
+
+   SECTION("Exceptions Are Propagated")
+   {
+      const auto throwing = [](const Tree<int>::Node& node) {
+         if (node.GetData() == 0)
+         {
+            throw std::runtime_error{ "Failure" };
+         }
+
+         return node.GetData();
+      };
+
+      tree.GetRoot()->GetLastChild()->GetData() = 0;
+
+      REQUIRE_THROWS_AS(
+          TreeAlgorithms::ParallelTopK(
+              *tree.GetRoot(), 5, throwing, TreeAlgorithms::Unbounded{}, 4),
+          std::runtime_error);
+   }
+}
+
+TEST_CASE("Bulk Insertion and Grafting")
+{
+   const auto collectChildren = [](const auto& node) {
+      std::vector<std::string> children;
+      for (const auto* child = node.GetFirstChild(); child; child = child->GetNextSibling())
+      {
+         REQUIRE(child->GetParent() == &node);
+         children.emplace_back(child->GetData());
+      }
+
+      REQUIRE(children.size() == node.GetChildCount());
+      return children;
+   };
+
+   SECTION("Appending Children in Bulk")
+   {
+      Tree<std::string> tree{ "Root" };
+      tree.GetRoot()->AppendChild("A");
+
+      const std::vector<std::string> batch = { "B", "C", "D" };
+      auto* const first = tree.GetRoot()->AppendChildren(batch);
+
+      REQUIRE(first->GetData() == "B");
+      REQUIRE(first->GetPreviousSibling()->GetData() == "A");
+      REQUIRE(collectChildren(*tree.GetRoot()) == std::vector<std::string>({ "A", "B", "C", "D" }));
+      REQUIRE(tree.GetRoot()->GetLastChild()->GetData() == "D");
+
+      REQUIRE(tree.GetRoot()->AppendChildren(std::vector<std::string>{}) == nullptr);
+      REQUIRE(tree.GetRoot()->GetChildCount() == 4);
+
+      auto* const leaf = tree.GetRoot()->GetFirstChild();
+      leaf->AppendChildren(std::begin(batch), std::end(batch));
+      REQUIRE(collectChildren(*leaf) == batch);
+   }
+
+   SECTION("Bulk Appended Nodes Are Contiguous")
+   {
+      Tree<int> tree{ 0, std::make_unique<Tree<int>::NodeArena>(16) };
+
+      // Leave a few recycled slots lying around, which would otherwise be handed out first:
+      for (int value = 1; value <= 4; ++value)
+      {
+         tree.GetRoot()->AppendChild(value);
+      }
+
+      tree.GetRoot()->GetFirstChild()->DeleteFromTree();
+      tree.GetRoot()->GetLastChild()->DeleteFromTree();
+
+      std::vector<int> batch(10);
+      std::iota(std::begin(batch), std::end(batch), 100);
+
+      auto* node = tree.GetRoot()->AppendChildren(batch);
+      const auto firstIndex = node->GetIndex();
+
+      for (std::size_t offset = 0; node; node = node->GetNextSibling(), ++offset)
+      {
+         REQUIRE(node->GetIndex() == firstIndex + offset);
+      }
+   }
+
+   SECTION("Failed Bulk Appends Leave the Node Untouched")
+   {
+      Tree<PositiveNumber> tree{ PositiveNumber{ 1 } };
+      tree.GetRoot()->AppendChild(PositiveNumber{ 2 });
+
+      const std::vector<int> batch = { 3, 4, -5, 6 };
+      REQUIRE_THROWS_AS(tree.GetRoot()->AppendChildren(batch), std::invalid_argument);
+
+      REQUIRE(tree.GetRoot()->GetChildCount() == 1);
+      REQUIRE(tree.GetRoot()->GetLastChild()->GetData().m_value == 2);
+      REQUIRE(!tree.GetRoot()->GetLastChild()->GetNextSibling());
+   }
+
+   SECTION("Splicing Children Between Trees")
+   {
+      Tree<std::string> source{ "Source" };
+      source.GetRoot()->AppendChild("A")->AppendChild("A1");
+      source.GetRoot()->AppendChild("B");
+
+      Tree<std::string> sink{ "Sink" };
+      sink.GetRoot()->AppendChild("Z");
+
+      auto* const first = sink.GetRoot()->SpliceChildren(*source.GetRoot());
+      REQUIRE(first->GetData() == "A");
+
+      REQUIRE(collectChildren(*sink.GetRoot()) == std::vector<std::string>({ "Z", "A", "B" }));
+      REQUIRE(first->GetFirstChild()->GetData() == "A1");
+      REQUIRE(first->GetFirstChild()->GetParent() == first);
+      REQUIRE(sink.Size() == 5);
+
+      REQUIRE(!source.GetRoot()->HasChildren());
+      REQUIRE(!source.GetRoot()->GetFirstChild());
+      REQUIRE(source.Size() == 1);
+
+      REQUIRE(sink.GetRoot()->SpliceChildren(*source.GetRoot()) == nullptr);
+   }
+
+   SECTION("Grafting Subtrees")
+   {
+      Tree<std::string> tree{ "Root" };
+      auto* const a = tree.GetRoot()->AppendChild("A");
+      auto* const b = tree.GetRoot()->AppendChild("B");
+      a->AppendChild("A1")->AppendChild("A2");
+
+      b->GraftSubtree(*a->GetFirstChild());
+      REQUIRE(!a->HasChildren());
+      REQUIRE(collectChildren(*b) == std::vector<std::string>({ "A1" }));
+      REQUIRE(b->GetFirstChild()->GetFirstChild()->GetData() == "A2");
+
+      Tree<std::string> other{ "Other" };
+      other.GetRoot()->AppendChild("O1");
+
+      auto* const grafted = a->GraftSubtree(std::move(other));
+      REQUIRE(grafted->GetParent() == a);
+      REQUIRE(grafted->GetFirstChild()->GetData() == "O1");
+      REQUIRE(tree.Size() == 7);
+   }
+
+   SECTION("Subtree Counts Are Maintained")
+   {
+      using CountingTree = Tree<std::string, SubtreeCountingPolicy>;
+
+      CountingTree tree{ "Root" };
+      auto* const a = tree.GetRoot()->AppendChild("A");
+      auto* const b = tree.GetRoot()->AppendChild("B");
+
+      a->AppendChildren(std::vector<std::string>{ "A1", "A2", "A3" });
+      REQUIRE(tree.Size() == 6);
+      REQUIRE(tree.GetRoot()->GetLeafCount() == 4);
+
+      b->SpliceChildren(*a);
+      REQUIRE(a->GetSubtreeSize() == 1);
+      REQUIRE(b->GetSubtreeSize() == 4);
+      REQUIRE(b->GetLeafCount() == 3);
+      REQUIRE(tree.GetRoot()->GetLeafCount() == 4);
+
+      a->GraftSubtree(*b);
+      REQUIRE(tree.GetRoot()->GetSubtreeSize() == 6);
+      REQUIRE(tree.GetRoot()->GetLeafCount() == 3);
+      REQUIRE(a->GetSubtreeSize() == 5);
+      REQUIRE(tree.GetNodeAtPreOrderIndex(3)->GetData() == "A1");
+   }
+}
+
+TEST_CASE("Thread-Safe Queue")
+{
+   constexpr std::size_t threadCount = 4;
+   constexpr std::size_t elementsPerProducer = 20'000;
+   constexpr std::size_t totalCount = threadCount * elementsPerProducer;
+
+   // Every element carries its value twice, so that an element that was torn, or read before it
+   // was fully written, can be told apart from an intact one:
+   using ElementType = std::pair<std::size_t, std::size_t>;
+
+   const auto makeElement = [](std::size_t value) noexcept {
+      return ElementType{ value, ~value };
+   };
+
+   // A small queue forces the producers and consumers to lap the ring buffer many times over:
+   constexpr std::size_t capacity = 16;
+
+   const auto handOff = [&](const auto& produce, const auto& consume) {
+      ThreadSafeQueue<ElementType> queue{ capacity };
+      REQUIRE(queue.GetCapacity() == capacity);
+
+      std::atomic<std::size_t> consumedCount{ 0 };
+      std::vector<std::vector<ElementType>> consumed(threadCount);
+
+      std::vector<std::thread> threads;
+      for (std::size_t thread = 0; thread < threadCount; ++thread)
+      {
+         threads.emplace_back([&, thread] {
+            produce(queue, thread * elementsPerProducer, (thread + 1) * elementsPerProducer);
+         });
+
+         threads.emplace_back([&, thread] { consume(queue, consumedCount, consumed[thread]); });
+      }
+
+      for (auto& thread : threads)
+      {
+         thread.join();
+      }
+
+      REQUIRE(queue.IsEmpty());
+
+      std::vector<std::size_t> values;
+      values.reserve(totalCount);
+
+      for (const auto& elements : consumed)
+      {
+         // Each consumer claims ever later positions, so it has to see the elements of any one
+         // producer in the order in which they were pushed:
+         std::vector<std::size_t> lastValues(threadCount, 0);
+
+         for (const auto& element : elements)
+         {
+            REQUIRE(element.second == ~element.first);
+
+            const auto producer = element.first / elementsPerProducer;
+            REQUIRE(element.first + 1 > lastValues[producer]);
+            lastValues[producer] = element.first + 1;
+
+            values.emplace_back(element.first);
+         }
+      }
+
+      // Every element has to arrive exactly once:
+      std::sort(std::begin(values), std::end(values));
+
+      std::vector<std::size_t> expected(totalCount);
+      std::iota(std::begin(expected), std::end(expected), std::size_t{ 0 });
+
+      REQUIRE(values == expected);
+   };
+
+   const auto pushOneAtATime = [&](auto& queue, std::size_t first, std::size_t last) {
+      for (auto value = first; value < last; ++value)
+      {
+         queue.Push(makeElement(value));
+      }
+   };
+
+   // Batch sizes that don't divide the capacity make claims wrap around the end of the buffer:
+   const auto pushInBatches = [&](auto& queue, std::size_t first, std::size_t last) {
+      std::vector<ElementType> batch;
+      for (auto value = first; value < last; value += batch.size())
+      {
+         batch.clear();
+         for (auto offset = value; offset < std::min(value + 7, last); ++offset)
+         {
+            batch.emplace_back(makeElement(offset));
+         }
+
+         queue.PushBatch(std::begin(batch), std::end(batch));
+      }
+   };
+
+   const auto popOneAtATime = [&](auto& queue, auto& consumedCount, auto& elements) {
+      while (consumedCount.load() < totalCount)
+      {
+         ElementType element;
+         if (queue.TryPop(element))
+         {
+            elements.emplace_back(element);
+            consumedCount.fetch_add(1);
+         }
+         else
+         {
+            std::this_thread::yield();
+         }
+      }
+   };
+
+   const auto popInBatches = [&](auto& queue, auto& consumedCount, auto& elements) {
+      std::vector<ElementType> batch(5);
+      while (consumedCount.load() < totalCount)
+      {
+         const auto count = queue.TryPopBatch(std::begin(batch), batch.size());
+         if (count == 0)
+         {
+            std::this_thread::yield();
+            continue;
+         }
+
+         elements.insert(std::end(elements), std::begin(batch), std::begin(batch) + count);
+         consumedCount.fetch_add(count);
+      }
+   };
+
+   const auto waitAndPop = [&](auto& queue, auto& /*consumedCount*/, auto& elements) {
+      for (std::size_t index = 0; index < elementsPerProducer; ++index)
+      {
+         elements.emplace_back(queue.WaitAndPop());
+      }
+   };
+
+   SECTION("Pushing and Popping One at a Time")
+   {
+      handOff(pushOneAtATime, popOneAtATime);
+   }
+
+   SECTION("Pushing and Popping in Batches")
+   {
+      handOff(pushInBatches, popInBatches);
+   }
+
+   SECTION("Mixing Single and Batched Operations")
+   {
+      handOff(pushInBatches, popOneAtATime);
+      handOff(pushOneAtATime, popInBatches);
+   }
+
+   SECTION("Waiting for Elements")
+   {
+      handOff(pushInBatches, waitAndPop);
+   }
+
+   SECTION("First In, First Out")
+   {
+      ThreadSafeQueue<int> queue{ 4 };
+      REQUIRE(queue.TryPush(1));
+      REQUIRE(queue.TryPush(2));
+      REQUIRE(queue.TryPush(3));
+      REQUIRE(queue.TryPush(4));
+      REQUIRE_FALSE(queue.TryPush(5));
+
+      REQUIRE(queue.TryPop() == 1);
+      REQUIRE(queue.TryPush(5));
+
+      std::vector<int> values(8);
+      REQUIRE(queue.TryPopBatch(std::begin(values), values.size()) == 4);
+
+      values.resize(4);
+      REQUIRE(values == std::vector<int>({ 2, 3, 4, 5 }));
+
+      REQUIRE(queue.IsEmpty());
+      REQUIRE_FALSE(queue.TryPop());
+   }
+}
+
+TEST_CASE("String Pool")
+{
+   using NativeString = std::basic_string<NativeChar>;
+
+   const auto repeat = [](char character, std::size_t count) {
+      return NativeString(count, static_cast<NativeChar>(character));
+   };
+
+   constexpr auto chunkSize = StringPool::CHARACTERS_PER_CHUNK;
+
+   SECTION("Empty Strings")
+   {
+      StringPool pool;
+
+      const auto reference = pool.Append({});
+      REQUIRE(reference.offset == 0);
+      REQUIRE(reference.length == 0);
+
+      REQUIRE(pool.Get(reference).empty());
+      REQUIRE(pool.GetSize() == 0);
+   }
+
+   SECTION("Strings are Stored Back to Back")
+   {
+      StringPool pool;
+
+      const auto first = pool.Append(repeat('a', 3));
+      const auto second = pool.Append(repeat('b', 5));
+
+      REQUIRE(first.offset == 0);
+      REQUIRE(second.offset == 3);
+      REQUIRE(pool.GetSize() == 8);
+
+      REQUIRE(pool.Get(first) == repeat('a', 3));
+      REQUIRE(pool.Get(second) == repeat('b', 5));
+   }
+
+   SECTION("Strings Never Straddle Two Chunks")
+   {
+      StringPool pool;
+
+      // Fill all but the last ten characters of the first chunk:
+      const auto filler = repeat('a', StringPool::MAXIMUM_LENGTH);
+      while (pool.GetSize() + filler.size() <= chunkSize - 10)
+      {
+         pool.Append(filler);
+      }
+
+      const auto first = pool.Append(repeat('a', chunkSize - 10 - pool.GetSize()));
+      REQUIRE(pool.GetSize() == chunkSize - 10);
+
+      const auto second = pool.Append(repeat('b', 20));
+      const auto third = pool.Append(repeat('c', 10));
+
+      // The second string doesn't fit into the ten characters left in the first chunk:
+      REQUIRE(second.offset == chunkSize);
+      REQUIRE(third.offset == chunkSize + 20);
+      REQUIRE(pool.GetSize() == chunkSize + 30);
+
+      REQUIRE(pool.Get(first) == repeat('a', first.length));
+      REQUIRE(pool.Get(second) == repeat('b', 20));
+      REQUIRE(pool.Get(third) == repeat('c', 10));
+   }
+
+   SECTION("Long Strings are Truncated")
+   {
+      StringPool pool;
+
+      auto string = repeat('a', StringPool::MAXIMUM_LENGTH);
+      string.append(repeat('b', 5));
+
+      const auto reference = pool.Append(string);
+      REQUIRE(reference.length == StringPool::MAXIMUM_LENGTH);
+      REQUIRE(pool.Get(reference) == repeat('a', StringPool::MAXIMUM_LENGTH));
+   }
+
+   SECTION("Running Out of Chunks")
+   {
+      StringPool pool{ 2 };
+
+      // Each chunk holds sixteen strings of the maximum length, with a few characters to spare:
+      const auto string = repeat('a', StringPool::MAXIMUM_LENGTH);
+      const auto stringsPerChunk = chunkSize / StringPool::MAXIMUM_LENGTH;
+
+      std::vector<StringPool::Reference> references;
+      for (std::size_t index = 0; index < 2 * stringsPerChunk; ++index)
+      {
+         references.emplace_back(pool.Append(string));
+      }
+
+      REQUIRE(references[stringsPerChunk].offset == chunkSize);
+
+      const auto size = pool.GetSize();
+      REQUIRE_THROWS_AS(pool.Append(string), std::length_error);
+
+      // The pool is left as it was, and even shorter strings can still fill the gap at the end:
+      REQUIRE(pool.GetSize() == size);
+      REQUIRE(pool.Append(repeat('b', 2 * chunkSize - size)).offset == size);
+      REQUIRE_THROWS_AS(pool.Append(repeat('c', 1)), std::length_error);
+
+      for (const auto& reference : references)
+      {
+         REQUIRE(pool.Get(reference) == string);
+      }
+   }
+
+   SECTION("Writing and Reading")
+   {
+      StringPool pool;
+
+      // Strings of all sorts of lengths make some of them skip the rest of their chunk:
+      std::vector<std::pair<StringPool::Reference, NativeString>> strings;
+      for (std::size_t index = 0; index < 50; ++index)
+      {
+         const auto string = repeat(
+            static_cast<char>('a' + index % 26), index * 7919 % StringPool::MAXIMUM_LENGTH + 1);
+
+         strings.emplace_back(pool.Append(string), string);
+      }
+
+      REQUIRE(pool.GetSize() > chunkSize);
+
+      std::stringstream stream{ std::ios::in | std::ios::out | std::ios::binary };
+      pool.WriteTo(stream);
+
+      StringPool copy;
+      copy.ReadFrom(stream);
+
+      REQUIRE(copy.GetSize() == pool.GetSize());
+      for (const auto& string : strings)
+      {
+         REQUIRE(copy.Get(string.first) == string.second);
+      }
+
+      // Appending carries on where the original pool left off:
+      REQUIRE(copy.Append(repeat('a', 1)).offset == pool.Append(repeat('a', 1)).offset);
+
+      stream.seekg(0);
+      REQUIRE_THROWS_AS(copy.ReadFrom(stream), std::logic_error);
+   }
+
+   SECTION("Reading Truncated Data")
+   {
+      StringPool pool;
+      pool.Append(repeat('a', 100));
+
+      std::stringstream stream{ std::ios::in | std::ios::out | std::ios::binary };
+      pool.WriteTo(stream);
+
+      auto data = stream.str();
+      data.resize(data.size() - 1);
+
+      std::stringstream truncated{ data, std::ios::in | std::ios::binary };
+
+      StringPool copy;
+      REQUIRE_THROWS_AS(copy.ReadFrom(truncated), std::runtime_error);
+   }
+}
+
+TEST_CASE("Intern Table")
+{
+   using NativeString = std::basic_string<NativeChar>;
+
+   const auto toNative = [](const char* string) {
+      return std::experimental::filesystem::path{ string }.native();
+   };
+
+   InternTable table;
+
+   SECTION("The Empty String")
+   {
+      REQUIRE(table.GetSize() == 1);
+      REQUIRE(table.Intern({}) == InternTable::EMPTY_STRING_ID);
+      REQUIRE(table.Get(InternTable::EMPTY_STRING_ID).empty());
+      REQUIRE(table.GetSize() == 1);
+   }
+
+   SECTION("Identifiers are Stable")
+   {
+      const auto text = table.Intern(toNative(".txt"));
+      const auto image = table.Intern(toNative(".png"));
+
+      REQUIRE(text == 1);
+      REQUIRE(image == 2);
+
+      REQUIRE(table.Intern(toNative(".txt")) == text);
+      REQUIRE(table.Intern(toNative(".png")) == image);
+      REQUIRE(table.Intern(toNative(".TXT")) == 3);
+
+      REQUIRE(table.Get(text) == toNative(".txt"));
+      REQUIRE(table.GetSize() == 4);
+   }
+
+   SECTION("Interning from Multiple Threads")
+   {
+      constexpr std::size_t threadCount = 4;
+      constexpr std::size_t stringCount = 1000;
+
+      // Every thread interns the same strings, each starting at a different one:
+      std::vector<std::vector<InternTable::Id>> ids(
+         threadCount, std::vector<InternTable::Id>(stringCount));
+
+      std::vector<std::thread> threads;
+      for (std::size_t thread = 0; thread < threadCount; ++thread)
+      {
+         threads.emplace_back([&, thread] {
+            for (std::size_t offset = 0; offset < stringCount; ++offset)
+            {
+               const auto index = (thread * stringCount / threadCount + offset) % stringCount;
+               ids[thread][index] = table.Intern(toNative(std::to_string(index).c_str()));
+            }
+         });
+      }
+
+      for (auto& thread : threads)
+      {
+         thread.join();
+      }
+
+      REQUIRE(table.GetSize() == stringCount + 1);
+
+      for (std::size_t index = 0; index < stringCount; ++index)
+      {
+         const auto id = ids.front()[index];
+         REQUIRE(table.Get(id) == toNative(std::to_string(index).c_str()));
+
+         for (const auto& threadIds : ids)
+         {
+            REQUIRE(threadIds[index] == id);
+         }
+      }
+   }
+
+   SECTION("Writing and Reading")
+   {
+      std::vector<NativeString> strings{ toNative(".txt"), toNative(".png"), toNative(".tar") };
+      for (const auto& string : strings)
+      {
+         table.Intern(string);
+      }
+
+      std::stringstream stream{ std::ios::in | std::ios::out | std::ios::binary };
+      table.WriteTo(stream);
+
+      InternTable copy;
+      copy.ReadFrom(stream);
+
+      REQUIRE(copy.GetSize() == table.GetSize());
+      for (const auto& string : strings)
+      {
+         REQUIRE(copy.Intern(string) == table.Intern(string));
+      }
+
+      stream.seekg(0);
+      REQUIRE_THROWS_AS(copy.ReadFrom(stream), std::logic_error);
+   }
+}
+
+TEST_CASE("Scan Files")
+{
+   const auto toNative = [](const char* string) {
+      return std::experimental::filesystem::path{ string }.native();
+   };
+
+   FileNames fileNames;
+
+   const auto makeInfo = [&](const char* name, const char* extension, std::uintmax_t size) {
+      const auto type = std::string{ extension }.empty() ? FileType::DIRECTORY : FileType::REGULAR;
+
+      return FileInfo{ size,
+                       fileNames.names.Append(toNative(name)),
+                       fileNames.extensions.Intern(toNative(extension)),
+                       type,
+                       0 };
+   };
+
+   Tree<FileInfo> tree{ makeInfo("root", "", 60) };
+   tree.GetRoot()->AppendChild(makeInfo("notes", ".txt", 10));
+
+   auto* const pictures = tree.GetRoot()->AppendChild(makeInfo("pictures", "", 50));
+   pictures->AppendChild(makeInfo("cat", ".png", 20));
+   pictures->AppendChild(makeInfo("dog", ".png", 30));
+
+   const std::string fileName{ "ScanFileTest.tree" };
+
+   SECTION("Saving and Loading")
+   {
+      SaveScan(tree, fileNames, fileName);
+
+      const auto loadedScan = LoadScan(fileName);
+      REQUIRE(loadedScan.tree.Size() == tree.Size());
+
+      // The frozen tree stores its data in pre-order:
+      const auto* data = loadedScan.tree.GetDataArray();
+      for (auto itr = tree.beginPreOrder(); itr != tree.endPreOrder(); ++itr, ++data)
+      {
+         REQUIRE(data->size == itr->GetData().size);
+         REQUIRE(data->type == itr->GetData().type);
+         REQUIRE(
+            loadedScan.fileNames->GetFullName(*data) == fileNames.GetFullName(itr->GetData()));
+      }
+   }
+
+   SECTION("Names that Belong to Another Tree")
+   {
+      FileNames otherNames;
+      otherNames.names.Append(toNative("root"));
+
+      SaveScan(tree, otherNames, fileName);
+
+      REQUIRE_THROWS_AS(LoadScan(fileName), std::runtime_error);
+   }
+
+   SECTION("Names that Straddle Two Chunks")
+   {
+      // Fill the pool past its first chunk, and then point a name across the boundary:
+      const auto filler = std::basic_string<NativeChar>(StringPool::MAXIMUM_LENGTH, NativeChar{});
+      while (fileNames.names.GetSize() <= StringPool::CHARACTERS_PER_CHUNK)
+      {
+         fileNames.names.Append(filler);
+      }
+
+      auto straddlingInfo = makeInfo("straddling", "", 0);
+      straddlingInfo.name.offset = StringPool::CHARACTERS_PER_CHUNK - 2;
+      tree.GetRoot()->AppendChild(straddlingInfo);
+
+      SaveScan(tree, fileNames, fileName);
+
+      REQUIRE_THROWS_AS(LoadScan(fileName), std::runtime_error);
+   }
+
+   SECTION("Truncated Names")
+   {
+      SaveScan(tree, fileNames, fileName);
+
+      const auto namesFileName = GetNamesFileName(fileName);
+
+      std::string data;
+      {
+         std::stringstream stream;
+         stream << std::ifstream{ namesFileName, std::ios::binary }.rdbuf();
+         data = stream.str();
+      }
+
+      std::ofstream{ namesFileName, std::ios::binary | std::ios::trunc }
+         .write(data.data(), static_cast<std::streamsize>(data.size() - 1));
+
+      REQUIRE_THROWS_AS(LoadScan(fileName), std::runtime_error);
+   }
+
+   std::remove(GetNamesFileName(fileName).c_str());
+   std::remove(fileName.c_str());
+}
+
+TEST_CASE("Path Index")
+{
+   using Node = Tree<FileInfo>::Node;
+
+   const auto toNative = [](const std::string& string) {
+      return std::experimental::filesystem::path{ string }.native();
+   };
+
+   FileNames fileNames;
+
+   const auto makeInfo = [&](const std::string& name, const char* extension, FileType type) {
+      return FileInfo{ 1,
+                       fileNames.names.Append(toNative(name)),
+                       fileNames.extensions.Intern(toNative(extension)),
+                       type,
+                       0 };
+   };
+
+   Tree<FileInfo> tree{ makeInfo("root", "", FileType::DIRECTORY) };
+   PathIndex index{ fileNames };
+
+   const auto directoryName = [](std::size_t directory) {
+      return "d" + std::to_string(directory);
+   };
+
+   const auto fileName = [](std::size_t file) { return "f" + std::to_string(file) + ".txt"; };
+
+   // Every directory holds files of the same names, so equally named entries of different
+   // directories have to be told apart by their parent:
+   const auto build = [&](std::size_t directoryCount, std::size_t fileCount) {
+      for (std::size_t directory = 0; directory < directoryCount; ++directory)
+      {
+         auto* const directoryNode = tree.GetRoot()->AppendChild(
+            makeInfo(directoryName(directory), "", FileType::DIRECTORY));
+
+         index.Insert(*directoryNode);
+
+         for (std::size_t file = 0; file < fileCount; ++file)
+         {
+            index.Insert(*directoryNode->AppendChild(
+               makeInfo("f" + std::to_string(file), ".txt", FileType::REGULAR)));
+         }
+      }
+   };
+
+   // Every Node in the tree, save for the root, has to be found under its full name:
+   const auto verifyIndex = [&] {
+      const auto& root = *tree.GetRoot();
+      for (auto* directory = root.GetFirstChild(); directory;
+           directory = directory->GetNextSibling())
+      {
+         REQUIRE(index.Find(root, fileNames.GetFullName(directory->GetData())) == directory);
+
+         for (auto* file = directory->GetFirstChild(); file; file = file->GetNextSibling())
+         {
+            REQUIRE(index.Find(*directory, fileNames.GetFullName(file->GetData())) == file);
+         }
+      }
+
+      REQUIRE(index.GetSize() == tree.Size() - 1);
+   };
+
+   SECTION("Finding Entries")
+   {
+      build(3, 10);
+      verifyIndex();
+
+      const auto& root = *tree.GetRoot();
+      const auto& directory = *root.GetFirstChild();
+
+      REQUIRE(index.Find(directory, toNative(fileName(3)))->GetParent() == &directory);
+      REQUIRE(index.Find(*directory.GetNextSibling(), toNative(fileName(3))) !=
+              index.Find(directory, toNative(fileName(3))));
+
+      REQUIRE(index.Find(root, toNative(fileName(3))) == nullptr);
+      REQUIRE(index.Find(directory, toNative(fileName(10))) == nullptr);
+      REQUIRE(index.Find(directory, toNative("f3")) == nullptr);
+      REQUIRE(index.Find(directory, toNative("f3.txt2")) == nullptr);
+      REQUIRE(index.Find(directory, {}) == nullptr);
+      REQUIRE(index.Find(*directory.GetFirstChild(), toNative(fileName(3))) == nullptr);
+   }
+
+   SECTION("Growing Past the Initial Capacity")
+   {
+      // With a hundred thousand entries spread over 64 shards, every shard has to grow well past
+      // its initial capacity of 1024 slots:
+      build(10, 10'000);
+      verifyIndex();
+   }
+
+   SECTION("Erasing Colliding Entries")
+   {
+      // At about 700 entries per shard of 1024 slots, entries routinely collide, and their
+      // clusters often wrap around the end of the shard, so that erasing an entry has to shift
+      // the rest of its cluster back across the wrap point:
+      build(30, 1500);
+
+      std::vector<std::pair<const Node*, std::basic_string<NativeChar>>> erasedEntries;
+
+      std::size_t directoryIndex{ 0 };
+      for (auto* directory = tree.GetRoot()->GetFirstChild(); directory; ++directoryIndex)
+      {
+         auto* const nextDirectory = directory->GetNextSibling();
+
+         if (directoryIndex % 5 == 0)
+         {
+            erasedEntries.emplace_back(
+               tree.GetRoot(), fileNames.GetFullName(directory->GetData()));
+
+            index.EraseSubtree(*directory);
+            directory->DeleteFromTree();
+         }
+         else
+         {
+            std::size_t fileIndex{ 0 };
+            for (auto* file = directory->GetFirstChild(); file; ++fileIndex)
+            {
+               auto* const nextFile = file->GetNextSibling();
+
+               if (fileIndex % 3 == 0)
+               {
+                  erasedEntries.emplace_back(directory, fileNames.GetFullName(file->GetData()));
+
+                  index.EraseSubtree(*file);
+                  file->DeleteFromTree();
+               }
+
+               file = nextFile;
+            }
+         }
+
+         directory = nextDirectory;
+      }
+
+      verifyIndex();
+
+      for (const auto& entry : erasedEntries)
+      {
+         REQUIRE(index.Find(*entry.first, entry.second) == nullptr);
+      }
+
+      // Erasing an entry that's no longer there leaves the index as it was:
+      const auto& file = *tree.GetRoot()->GetFirstChild()->GetFirstChild();
+      const auto name = fileNames.GetFullName(file.GetData());
+
+      index.EraseSubtree(file);
+      index.EraseSubtree(file);
+      REQUIRE(index.Find(*file.GetParent(), name) == nullptr);
+
+      index.Insert(file);
+      verifyIndex();
+   }
+
+   SECTION("Rebuilding After the Nodes Have Moved")
+   {
+      build(5, 100);
+
+      tree.OptimizeMemoryLayoutFor<PreOrderTraversal>();
+      index.Rebuild(tree);
+
+      verifyIndex();
+   }
+}
+
+TEST_CASE("File Columns")
+{
+   // Long enough to hold a run of 255 blocks of 32 nodes, plus one, after a few leading nodes:
+   constexpr std::size_t nodeCount = 9000;
+
+   constexpr std::array<FileType, 3> types{ FileType::REGULAR,
+                                            FileType::DIRECTORY,
+                                            FileType::SYMLINK };
+
+   // A fixed linear congruential generator keeps the tree the same from one run to the next:
+   std::uint64_t state{ 42 };
+   const auto random = [&] {
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      return state >> 33;
+   };
+
+   // The first few nodes form a chain, so that the subtree of the fourth node spans all but the
+   // first three nodes, and so doesn't start on a multiple of eight:
+   const auto buildTree = [&](const auto& pickType) {
+      Tree<FileInfo> tree{ FileInfo{ 0, {}, 0, FileType::DIRECTORY, 0 } };
+
+      std::vector<Tree<FileInfo>::Node*> nodes{ tree.GetRoot() };
+      for (std::size_t index = 1; index < nodeCount; ++index)
+      {
+         auto* const parent = index < 4 ? nodes.back() : nodes[3 + random() % (nodes.size() - 3)];
+
+         const FileInfo info{ random() << 8, {}, static_cast<InternTable::Id>(random() % 5),
+                              pickType(), 0 };
+
+         nodes.emplace_back(parent->AppendChild(info));
+      }
+
+      return FrozenTree<FileInfo>{ tree };
+   };
+
+   // Compares every kernel against a plain loop over the frozen tree:
+   const auto verifyRange = [&](const FrozenTree<FileInfo>& tree,
+                                const FileColumns& columns,
+                                FileColumns::Range range) {
+      const auto* const data = tree.GetDataArray();
+
+      std::vector<FileColumns::ExtensionTotals> expectedTotals(5, { 0, 0 });
+      for (auto index = range.first; index < range.last; ++index)
+      {
+         if (data[index].type == FileType::REGULAR)
+         {
+            expectedTotals[data[index].extension].fileCount += 1;
+            expectedTotals[data[index].extension].byteCount += data[index].size;
+         }
+      }
+
+      for (const auto type : types)
+      {
+         std::uint64_t expectedSize{ 0 };
+         std::size_t expectedCount{ 0 };
+
+         for (auto index = range.first; index < range.last; ++index)
+         {
+            if (data[index].type == type)
+            {
+               expectedSize += data[index].size;
+               expectedCount += 1;
+            }
+         }
+
+         REQUIRE(columns.SumSizes(type, range) == expectedSize);
+         REQUIRE(columns.Count(type, range) == expectedCount);
+      }
+
+      const auto totals = columns.TotalByExtension(5, range);
+      for (std::size_t extension = 0; extension < totals.size(); ++extension)
+      {
+         REQUIRE(totals[extension].fileCount == expectedTotals[extension].fileCount);
+         REQUIRE(totals[extension].byteCount == expectedTotals[extension].byteCount);
+      }
+   };
+
+   // Lengths around the blocks of 8 and 32 nodes that the kernels work through, as well as
+   // around the 255 blocks after which the count kernel has to widen its tallies:
+   constexpr std::array<std::size_t, 9> lengths{ 0, 7, 8, 9, 31, 32, 33, 255 * 32, 255 * 32 + 1 };
+
+   const auto verifyLengths = [&](const FrozenTree<FileInfo>& tree, const FileColumns& columns) {
+      for (const std::size_t first : { 0, 3 })
+      {
+         for (const auto length : lengths)
+         {
+            verifyRange(tree, columns, FileColumns::Range{ first, first + length });
+         }
+      }
+   };
+
+   SECTION("Mixed Types")
+   {
+      const auto tree = buildTree([&] { return types[random() % types.size()]; });
+      const FileColumns columns{ tree };
+
+      REQUIRE(columns.Size() == nodeCount);
+      verifyLengths(tree, columns);
+
+      verifyRange(tree, columns, columns.GetAll());
+
+      const auto subtree = columns.GetSubtree(3);
+      REQUIRE(subtree.first == 3);
+      REQUIRE(subtree.last == nodeCount);
+      verifyRange(tree, columns, subtree);
+
+      for (std::size_t index = 0; index < nodeCount; index += 997)
+      {
+         verifyRange(tree, columns, columns.GetSubtree(index));
+      }
+   }
+
+   SECTION("Runs of a Single Type")
+   {
+      // Every node matching is what makes the 8-bit tallies of the count kernel overflow, should
+      // it fail to widen them in time:
+      const auto tree = buildTree([] { return FileType::REGULAR; });
+      const FileColumns columns{ tree };
+
+      verifyLengths(tree, columns);
+      REQUIRE(columns.Count(FileType::REGULAR, columns.GetAll()) == nodeCount - 1);
+   }
+}
+
+TEST_CASE("Drive Scanner")
+{
+   ScratchDirectory scratch{ "DriveScannerTest" };
+
+   // Besides a few files, there are empty files, and directories that only hold empty files or
+   // other empty directories, none of which should make it into the tree:
+   scratch.WriteFile("a.txt", 100);
+   scratch.WriteFile("empty.txt", 0);
+   scratch.WriteFile("docs/x.txt", 10);
+   scratch.WriteFile("docs/y.txt", 20);
+   scratch.WriteFile("docs/nested/z.txt", 5);
+   scratch.WriteFile("docs/nested/empty.txt", 0);
+   scratch.WriteFile("gone/g.txt", 8);
+   scratch.WriteFile("hollow/empty.txt", 0);
+   scratch.MakeDirectory("hollow/inner/deeper");
+
+   DriveScanner scanner{ scratch.GetPath(), 4, DriveScanner::PathIndexing::ENABLED };
+
+   const auto find = [&](const std::string& relativePath) {
+      return scanner.FindNode(scratch.GetPath(relativePath));
+   };
+
+   const auto sizeOf = [&](const std::string& relativePath) {
+      const auto* const node = find(relativePath);
+      REQUIRE(node);
+
+      return node->GetData().size;
+   };
+
+   // Every Node has to be found by its own path:
+   const auto verifyPathIndex = [&] {
+      const auto& fileNames = *scanner.GetFileNames();
+      const auto& tree = *scanner.GetTree();
+
+      std::for_each(
+          tree.beginPreOrder(), tree.endPreOrder(), [&](const Tree<FileInfo>::Node& node) {
+             std::vector<std::basic_string<NativeChar>> names;
+             for (auto* ancestor = &node; ancestor->GetParent(); ancestor = ancestor->GetParent())
+             {
+                names.emplace_back(fileNames.GetFullName(ancestor->GetData()));
+             }
+
+             auto path = scratch.GetPath();
+             for (auto name = names.rbegin(); name != names.rend(); ++name)
+             {
+                path /= *name;
+             }
+
+             REQUIRE(scanner.FindNode(path) == &node);
+          });
+   };
+
+   scanner.Start();
+
+   SECTION("Rolling Up Directory Sizes")
+   {
+      const auto& tree = *scanner.GetTree();
+      VerifyDirectorySizes(tree);
+      verifyPathIndex();
+
+      REQUIRE(tree.GetRoot()->GetData().size == 143);
+      REQUIRE(tree.Size() == 9);
+
+      REQUIRE(sizeOf("a.txt") == 100);
+      REQUIRE(sizeOf("docs") == 35);
+      REQUIRE(sizeOf("docs/nested") == 5);
+      REQUIRE(sizeOf("gone") == 8);
+
+      REQUIRE(find("empty.txt") == nullptr);
+      REQUIRE(find("docs/nested/empty.txt") == nullptr);
+      REQUIRE(find("hollow") == nullptr);
+      REQUIRE(find("hollow/inner") == nullptr);
+      REQUIRE(find("hollow/inner/deeper") == nullptr);
+   }
+
+   SECTION("Rolling Up Many Directories at Once")
+   {
+      // Plenty of sibling directories finish around the same time, on different threads, each
+      // alongside an empty directory and an empty file that have to be left out:
+      ScratchDirectory wideScratch{ "DriveScannerWideTest" };
+
+      std::uintmax_t expectedSize{ 0 };
+      for (int outer = 0; outer < 8; ++outer)
+      {
+         for (int inner = 0; inner < 8; ++inner)
+         {
+            const auto directory = "d" + std::to_string(outer) + "/d" + std::to_string(inner);
+            for (int file = 1; file <= 3; ++file)
+            {
+               wideScratch.WriteFile(directory + "/f" + std::to_string(file), file * (inner + 1));
+               expectedSize += static_cast<std::uintmax_t>(file * (inner + 1));
+            }
+
+            wideScratch.WriteFile(directory + "/empty", 0);
+            wideScratch.MakeDirectory(directory + "/hollow/hollow");
+         }
+      }
+
+      DriveScanner wideScanner{ wideScratch.GetPath(), 4 };
+      wideScanner.Start();
+
+      const auto& tree = *wideScanner.GetTree();
+      VerifyDirectorySizes(tree);
+
+      REQUIRE(tree.GetRoot()->GetData().size == expectedSize);
+      REQUIRE(tree.Size() == 1 + 8 + 8 * 8 * 4);
+   }
+
+   SECTION("Rescanning Every Directory")
+   {
+      scratch.WriteFile("a.txt", 0);
+      scratch.WriteFile("docs/x.txt", 15);
+      scratch.Remove("docs/y.txt");
+      scratch.WriteFile("docs/new.txt", 7);
+      scratch.WriteFile("docs/nested/z.txt", 0);
+      scratch.Remove("gone");
+      scratch.WriteFile("added/f.txt", 3);
+      scratch.MakeDirectory("added/hollow");
+
+      scanner.Rescan(DriveScanner::ChangeDetection::FULL_ENUMERATION);
+
+      const auto& tree = *scanner.GetTree();
+      VerifyDirectorySizes(tree);
+      verifyPathIndex();
+
+      REQUIRE(tree.GetRoot()->GetData().size == 25);
+      REQUIRE(tree.Size() == 6);
+
+      REQUIRE(sizeOf("docs") == 22);
+      REQUIRE(sizeOf("docs/x.txt") == 15);
+      REQUIRE(sizeOf("docs/new.txt") == 7);
+      REQUIRE(sizeOf("added") == 3);
+      REQUIRE(sizeOf("added/f.txt") == 3);
+
+      // Files that were emptied are pruned, as are the directories that they left empty:
+      REQUIRE(find("a.txt") == nullptr);
+      REQUIRE(find("docs/y.txt") == nullptr);
+      REQUIRE(find("docs/nested") == nullptr);
+      REQUIRE(find("docs/nested/z.txt") == nullptr);
+      REQUIRE(find("gone") == nullptr);
+      REQUIRE(find("added/hollow") == nullptr);
+   }
+}
+
+TEST_CASE("Asynchronous Drive Scans")
+{
+   ScratchDirectory scratch{ "AsynchronousDriveScanTest" };
+
+   constexpr int outerCount = 30;
+   constexpr int innerCount = 10;
+   constexpr int filesPerDirectory = 3;
+
+   scratch.WriteFile("root.txt", 1000);
+
+   // The sizes of the files at each depth, beneath the root, add up to a different power of ten:
+   for (int outer = 0; outer < outerCount; ++outer)
+   {
+      const auto outerDirectory = "d" + std::to_string(outer);
+      scratch.WriteFile(outerDirectory + "/file.txt", 100);
+
+      for (int inner = 0; inner < innerCount; ++inner)
+      {
+         const auto innerDirectory = outerDirectory + "/d" + std::to_string(inner);
+         for (int file = 0; file < filesPerDirectory; ++file)
+         {
+            scratch.WriteFile(innerDirectory + "/f" + std::to_string(file), 10);
+         }
+      }
+   }
+
+   constexpr std::size_t fullNodeCount =
+       1 + 1 + outerCount * (2 + innerCount * (1 + filesPerDirectory));
+
+   constexpr std::uintmax_t fullSize =
+       1000 + outerCount * (100 + innerCount * filesPerDirectory * 10);
+
+   SECTION("Delivering Scanned Subtrees")
+   {
+      DriveScanner scanner{ scratch.GetPath(), 4 };
+
+      std::mutex mutex;
+      std::vector<std::pair<const Tree<FileInfo>::Node*, std::uintmax_t>> deliveries;
+
+      DriveScanner::ScanOptions options;
+      options.onSubtreeScanned = [&](const Tree<FileInfo>::Node& directory) {
+         // The subtree has to be complete by the time it's delivered:
+         std::uintmax_t fileSizes{ 0 };
+         Tree<FileInfo>::ForEach<PreOrderTraversal>(
+             directory, [&](const Tree<FileInfo>::Node& node) {
+                if (node.GetData().type == FileType::REGULAR)
+                {
+                   fileSizes += node.GetData().size;
+                }
+             });
+
+         const std::lock_guard<std::mutex> lock{ mutex };
+         deliveries.emplace_back(&directory, fileSizes);
+      };
+
+      scanner.StartAsync(std::move(options)).get();
+
+      const auto& tree = *scanner.GetTree();
+      VerifyDirectorySizes(tree);
+
+      REQUIRE(tree.Size() == fullNodeCount);
+      REQUIRE(tree.GetRoot()->GetData().size == fullSize);
+      REQUIRE(deliveries.size() == 1 + outerCount + outerCount * innerCount);
+
+      // Every directory is delivered once, after all of its subdirectories, and only once its
+      // files add up to its final size:
+      std::vector<const Tree<FileInfo>::Node*> deliveredNodes;
+      for (const auto& delivery : deliveries)
+      {
+         const auto& directory = *delivery.first;
+         REQUIRE(delivery.second == directory.GetData().size);
+
+         for (auto* child = directory.GetFirstChild(); child; child = child->GetNextSibling())
+         {
+            if (child->GetData().type == FileType::DIRECTORY)
+            {
+               REQUIRE(
+                   std::find(std::begin(deliveredNodes), std::end(deliveredNodes), child) !=
+                   std::end(deliveredNodes));
+            }
+         }
+
+         REQUIRE(
+             std::find(std::begin(deliveredNodes), std::end(deliveredNodes), &directory) ==
+             std::end(deliveredNodes));
+
+         deliveredNodes.emplace_back(&directory);
+      }
+
+      REQUIRE(deliveredNodes.back() == tree.GetRoot());
+   }
+
+   SECTION("Limiting the Depth")
+   {
+      DriveScanner::ScanOptions options;
+
+      options.maximumDepth = 0;
+      {
+         DriveScanner scanner{ scratch.GetPath(), 4 };
+         scanner.StartAsync(options).get();
+
+         const auto& tree = *scanner.GetTree();
+         VerifyDirectorySizes(tree);
+
+         REQUIRE(tree.Size() == 2);
+         REQUIRE(tree.GetRoot()->GetData().size == 1000);
+      }
+
+      options.maximumDepth = 1;
+      {
+         DriveScanner scanner{ scratch.GetPath(), 4 };
+         scanner.StartAsync(options).get();
+
+         const auto& tree = *scanner.GetTree();
+         VerifyDirectorySizes(tree);
+
+         REQUIRE(tree.Size() == 2 + outerCount * 2);
+         REQUIRE(tree.GetRoot()->GetData().size == 1000 + outerCount * 100);
+      }
+   }
+
+   SECTION("Cancelling a Scan")
+   {
+      // With a single thread, the scan carries on depth-first, so cancelling it as soon as the
+      // first directory is done leaves almost all others unscanned:
+      DriveScanner scanner{ scratch.GetPath(), 1 };
+
+      DriveScanner::ScanOptions options;
+      options.onSubtreeScanned = [&](const Tree<FileInfo>::Node&) { scanner.Cancel(); };
+
+      scanner.StartAsync(std::move(options)).get();
+      REQUIRE(scanner.IsCancelled());
+      REQUIRE(scanner.GetProgress().isComplete);
+
+      // The directories that were skipped are left out, while the ancestors of those that had
+      // been scanned are still completed, with the sizes of what was found in them:
+      const auto& tree = *scanner.GetTree();
+      VerifyDirectorySizes(tree);
+
+      REQUIRE(tree.Size() < fullNodeCount / 2);
+      REQUIRE(tree.GetRoot()->GetData().size > 1000);
+   }
+
+   SECTION("Cancelling a Scan on Several Threads")
+   {
+      DriveScanner scanner{ scratch.GetPath(), 4 };
+
+      auto scan = scanner.StartAsync();
+      scanner.Cancel();
+      scan.get();
+
+      REQUIRE(scanner.IsCancelled());
+      VerifyDirectorySizes(*scanner.GetTree());
+      REQUIRE(scanner.GetTree()->Size() <= fullNodeCount);
+   }
+
+   SECTION("Destroying a Scanner While it Scans")
+   {
+      std::atomic<int> deliveryCount{ 0 };
+
+      DriveScanner::ScanOptions options;
+      options.onSubtreeScanned = [&](const Tree<FileInfo>::Node&) {
+         deliveryCount.fetch_add(1);
+         std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+      };
+
+      auto scanner = std::make_unique<DriveScanner>(scratch.GetPath(), 4);
+      const auto scan = scanner->StartAsync(std::move(options));
+
+      while (deliveryCount.load() == 0)
+      {
+         std::this_thread::yield();
+      }
+
+      // The destructor has to wait for the scan to wind down, after which nothing is delivered
+      // anymore:
+      scanner.reset();
+      REQUIRE(scan.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready);
+
+      const auto finalCount = deliveryCount.load();
+      std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+      REQUIRE(deliveryCount.load() == finalCount);
+   }
+}